@@ -0,0 +1,49 @@
+#include "bench.h"
+
+#include <vector>
+
+#include <lazarus/BatchRandom.h>
+#include <lazarus/Random.h>
+
+using namespace lz;
+
+BENCHMARK(batchRandom)
+{
+    const size_t count = 4000000;
+    std::vector<int> ints(count);
+    std::vector<float> floats(count);
+
+    Random::seed(12345);
+    double seconds = bench::measure([&]
+    {
+        for (size_t i = 0; i < count; ++i)
+            ints[i] = Random::range(0, 99);
+    });
+    bench::keep(ints);
+    bench::report("Random::range loop", seconds, count, "value");
+
+    const std::pair<BatchRandom::Kernel, const char*> kernels[] = {
+        {BatchRandom::Kernel::Scalar, "scalar"},
+        {BatchRandom::Kernel::SSE2, "sse2"},
+        {BatchRandom::Kernel::AVX2, "avx2"}};
+    for (auto& kernel : kernels)
+    {
+        BatchRandom generator(12345);
+        generator.setKernel(kernel.first);
+        if (generator.getKernel() != kernel.first)
+            continue;  // Not supported by this processor
+        std::string suffix = std::string(" (") + kernel.second + ")";
+
+        seconds = bench::measure([&] { generator.fillRange(ints, 0, 99); });
+        bench::keep(ints);
+        bench::report("fillRange" + suffix, seconds, count, "value");
+
+        seconds = bench::measure([&] { generator.fillUniform(floats); });
+        bench::keep(floats);
+        bench::report("fillUniform" + suffix, seconds, count, "value");
+
+        seconds = bench::measure([&] { generator.fillNormal(floats); });
+        bench::keep(floats);
+        bench::report("fillNormal" + suffix, seconds, count, "value");
+    }
+}
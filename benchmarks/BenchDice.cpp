@@ -0,0 +1,58 @@
+#include "bench.h"
+
+#include <lazarus/Dice.h>
+
+using namespace lz;
+
+BENCHMARK(dice)
+{
+    const int rollCount = 1000000;
+    RandomGenerator generator(12345);
+    long sum = 0;
+
+    double seconds = bench::measure([&]
+    {
+        for (int i = 0; i < rollCount; ++i)
+            sum += Dice("3d6+2").roll(generator);
+    });
+    bench::report("parse + roll 3d6+2", seconds, rollCount, "roll");
+
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < rollCount; ++i)
+            sum += Dice::get("3d6+2").roll(generator);
+    });
+    bench::report("registry + roll 3d6+2", seconds, rollCount, "roll");
+
+    const Dice& small = Dice::get("3d6+2");
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < rollCount; ++i)
+            sum += small.roll(generator);
+    });
+    bench::report("compiled roll 3d6+2", seconds, rollCount, "roll");
+
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < rollCount / 10; ++i)
+            sum += generator.roll(6, 100);
+    });
+    bench::report("RandomGenerator::roll(6, 100)", seconds, rollCount / 10, "roll");
+
+    const Dice& big = Dice::get("100d6");
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < rollCount; ++i)
+            sum += big.roll(generator);
+    });
+    bench::report("compiled roll 100d6", seconds, rollCount, "roll");
+
+    const Dice& huge = Dice::get("1000d100");
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < rollCount; ++i)
+            sum += huge.roll(generator);
+    });
+    bench::report("compiled roll 1000d100", seconds, rollCount, "roll");
+    bench::keep(sum);
+}
@@ -0,0 +1,46 @@
+#include "bench.h"
+
+#include <vector>
+
+#include <lazarus/ECS/ECSEngine.h>
+#include <lazarus/ECS/InterpolationSystem.h>
+#include <lazarus/RenderThread.h>
+
+using namespace lz;
+
+BENCHMARK(interpolation)
+{
+    const int entities = 10000;
+    const int steps = 100;
+
+    // Keeping the previous transforms, on each step of the simulation
+    ECSEngine engine;
+    engine.setWorkerCount(0);
+    InterpolationSystem interpolation;
+    engine.registerUpdateable(&interpolation);
+    for (int i = 0; i < entities; ++i)
+        engine.addEntity()->addComponent<Interpolated>(Transform{static_cast<float>(i), 0.f});
+    double seconds = bench::measure([&]
+    {
+        for (int step = 0; step < steps; ++step)
+            engine.update(1. / 30.);
+    });
+    bench::report("keep previous transforms 10k entities", seconds, entities * steps, "entity");
+
+    // Blending the transforms of the sprites, on each frame drawn
+    std::vector<Sprite> sprites(entities);
+    for (int i = 0; i < entities; ++i)
+        sprites[i].transform.current = Transform{static_cast<float>(i), 1.f, 90.f, 2.f};
+    float total = 0.f;
+    seconds = bench::measure([&]
+    {
+        for (int frame = 0; frame < steps; ++frame)
+        {
+            float alpha = frame / static_cast<float>(steps);
+            for (const Sprite& sprite : sprites)
+                total += sprite.transform.at(alpha).x;
+        }
+    });
+    bench::report("interpolate sprites 10k sprites", seconds, entities * steps, "sprite");
+    bench::keep(total);
+}
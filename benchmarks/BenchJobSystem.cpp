@@ -0,0 +1,56 @@
+#include "bench.h"
+
+#include <atomic>
+#include <thread>
+
+#include <lazarus/JobSystem.h>
+
+using namespace lz;
+
+BENCHMARK(jobSystemOverhead)
+{
+    const int jobCount = 200000;
+    unsigned hardwareThreads = std::max(std::thread::hardware_concurrency(), 2u);
+    for (unsigned workers : {0u, 1u, hardwareThreads - 1})
+    {
+        JobSystem jobs(workers);
+        std::string suffix = " (" + std::to_string(workers) + " workers)";
+
+        // Spawn and join empty jobs from outside the workers
+        JobCounter counter;
+        double seconds = bench::measure([&]
+        {
+            for (int i = 0; i < jobCount; ++i)
+                jobs.spawn([] {}, &counter);
+            jobs.wait(counter);
+        });
+        bench::report("spawn + join" + suffix, seconds, jobCount, "job");
+
+        // Jobs spawned from one worker and stolen by the others
+        unsigned long stealsBefore = jobs.getStealCount();
+        seconds = bench::measure([&]
+        {
+            JobCounter outer;
+            jobs.spawn([&]
+            {
+                JobCounter inner;
+                for (int i = 0; i < jobCount; ++i)
+                    jobs.spawn([] {}, &inner);
+                jobs.wait(inner);
+            }, &outer);
+            jobs.wait(outer);
+        });
+        bench::report("nested spawn + steal" + suffix, seconds, jobCount, "job");
+        std::printf("  %-40s %12lu\n", ("steals" + suffix).c_str(),
+                    jobs.getStealCount() - stealsBefore);
+
+        // Fork-join of a cheap loop
+        std::atomic<long> sum{0};
+        seconds = bench::measure([&]
+        {
+            jobs.parallelFor(0, jobCount, 1024, [&sum](size_t i) { sum.fetch_add(i, std::memory_order_relaxed); });
+        });
+        bench::keep(sum);
+        bench::report("parallelFor, grain 1024" + suffix, seconds, jobCount, "index");
+    }
+}
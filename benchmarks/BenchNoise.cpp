@@ -0,0 +1,63 @@
+#include "bench.h"
+
+#include <thread>
+#include <vector>
+
+#include <lazarus/JobSystem.h>
+#include <lazarus/Noise.h>
+
+using namespace lz;
+
+BENCHMARK(noise)
+{
+    const size_t size = 1024;
+    const double cells = static_cast<double>(size * size);
+    std::vector<float> tile(size * size);
+
+    const std::pair<NoiseSettings::Type, const char*> types[] = {
+        {NoiseSettings::Type::Value, "value"},
+        {NoiseSettings::Type::Perlin, "perlin"},
+        {NoiseSettings::Type::Simplex, "simplex"}};
+    const std::pair<SimdLevel, const char*> levels[] = {
+        {SimdLevel::Scalar, "scalar"},
+        {SimdLevel::SSE2, "sse2"},
+        {SimdLevel::AVX2, "avx2"}};
+
+    for (auto& type : types)
+    {
+        NoiseSettings settings;
+        settings.type = type.first;
+        settings.frequency = 0.01f;
+        Noise noise(12345, settings);
+        for (auto& level : levels)
+        {
+            noise.setSimdLevel(level.first);
+            if (noise.getSimdLevel() != level.first)
+                continue;  // Not supported by this processor
+            double seconds = bench::measure([&] { noise.fillTile(tile.data(), size, size, 0.f, 0.f); });
+            bench::keep(tile);
+            bench::report(std::string(type.second) + " 1024x1024 (" + level.second + ")", seconds, cells, "cell");
+        }
+    }
+
+    NoiseSettings settings;
+    settings.fractal = NoiseSettings::Fractal::FBm;
+    settings.octaves = 6;
+    settings.frequency = 0.01f;
+    Noise fbm(12345, settings);
+    double seconds = bench::measure([&] { fbm.fillTile(tile.data(), size, size, 0.f, 0.f); });
+    bench::keep(tile);
+    bench::report("perlin fbm 6 octaves 1024x1024", seconds, cells, "cell");
+
+    settings.warp = 2.f;
+    Noise warped(12345, settings);
+    seconds = bench::measure([&] { warped.fillTile(tile.data(), size, size, 0.f, 0.f); });
+    bench::keep(tile);
+    bench::report("perlin fbm 6 octaves + warp 1024x1024", seconds, cells, "cell");
+
+    JobSystem jobs(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    seconds = bench::measure([&] { fbm.fillTile(tile.data(), size, size, 0.f, 0.f, 1.f, &jobs); });
+    bench::keep(tile);
+    bench::report("perlin fbm 6 octaves 1024x1024 (" + std::to_string(jobs.getWorkerCount())
+                  + " workers)", seconds, cells, "cell");
+}
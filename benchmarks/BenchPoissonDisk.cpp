@@ -0,0 +1,100 @@
+#include "bench.h"
+
+#include <cmath>
+#include <vector>
+
+#include <lazarus/Noise.h>
+#include <lazarus/PoissonDisk.h>
+#include <lazarus/Random.h>
+
+using namespace lz;
+
+namespace
+{
+const int mapSize = 1024;
+const float radius = 4.f;
+
+// Places points by trying random cells until enough tries in a row fail, the
+// way placement loops usually do, with a grid to check the distances
+size_t rejectionLoop(int maxFailures)
+{
+    const int cellSize = static_cast<int>(radius);
+    const int gridSize = mapSize / cellSize;
+    std::vector<std::vector<PoissonDisk::Point>> grid(gridSize * gridSize);
+    size_t placed = 0;
+    for (int failures = 0; failures < maxFailures;)
+    {
+        PoissonDisk::Point point{static_cast<float>(Random::range(0, mapSize - 1)),
+                                 static_cast<float>(Random::range(0, mapSize - 1))};
+        int cx = static_cast<int>(point.x) / cellSize, cy = static_cast<int>(point.y) / cellSize;
+        bool fits = true;
+        for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, gridSize - 1) && fits; ++y)
+            for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, gridSize - 1) && fits; ++x)
+                for (const auto& other : grid[y * gridSize + x])
+                    if (std::hypot(other.x - point.x, other.y - point.y) < radius)
+                        fits = false;
+        if (fits)
+        {
+            grid[cy * gridSize + cx].push_back(point);
+            ++placed;
+            failures = 0;
+        }
+        else
+            ++failures;
+    }
+    return placed;
+}
+}
+
+BENCHMARK(poissonDisk)
+{
+    Random::seed(12345);
+    size_t count = 0;
+    double seconds;
+    for (int failures : {100, 10000})
+    {
+        seconds = bench::measure([&] { count = rejectionLoop(failures); });
+        bench::report("rejection loop " + std::to_string(failures) + " tries 1024x1024 r=4 ("
+                      + std::to_string(count) + " points)", seconds, count, "point");
+    }
+
+    PoissonDisk sampler(mapSize, mapSize, radius);
+    std::vector<PoissonDisk::Point> points;
+    seconds = bench::measure([&] { points = sampler.generate(12345); });
+    bench::report("bridson 1024x1024 r=4 (" + std::to_string(points.size()) + " points)",
+                  seconds, points.size(), "point");
+
+    // Caves from thresholded noise, with about half of the cells passable
+    NoiseSettings settings;
+    settings.frequency = 0.02f;
+    std::vector<float> values(mapSize * mapSize);
+    Noise(12345, settings).fillTile(values.data(), mapSize, mapSize, 0.f, 0.f);
+    std::vector<bool> open(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+        open[i] = values[i] > 0.f;
+    auto passable = [&open](int x, int y) { return open[y * mapSize + x]; };
+
+    sampler.setMask(passable);
+    seconds = bench::measure([&] { points = sampler.generate(12345); });
+    bench::report("bridson 1024x1024 r=4 caves (" + std::to_string(points.size()) + " points)",
+                  seconds, points.size(), "point");
+
+    PoissonDisk variable(mapSize, mapSize, 3.f, 8.f,
+                         [](float x, float) { return 3.f + 5.f * x / mapSize; });
+    seconds = bench::measure([&] { points = variable.generate(12345); });
+    bench::report("bridson 1024x1024 r=3..8 (" + std::to_string(points.size()) + " points)",
+                  seconds, points.size(), "point");
+
+    seconds = bench::measure([] { bench::keep(BlueNoiseTile(128, radius, 12345).getPoints().size()); });
+    bench::report("blue noise tile 128x128 r=4", seconds, 1, "tile");
+
+    BlueNoiseTile tile(128, radius, 12345);
+    seconds = bench::measure([&] { points = tile.fill(mapSize, mapSize, PoissonDisk::Mask(), 17, 42); });
+    bench::report("tile fill 1024x1024 r=4 (" + std::to_string(points.size()) + " points)",
+                  seconds, points.size(), "point");
+
+    seconds = bench::measure([&] { points = tile.fill(mapSize, mapSize, passable, 17, 42); });
+    bench::report("tile fill 1024x1024 r=4 caves (" + std::to_string(points.size()) + " points)",
+                  seconds, points.size(), "point");
+    bench::keep(points.size());
+}
@@ -0,0 +1,157 @@
+#include "bench.h"
+
+#include <lazarus/Random.h>
+
+using namespace lz;
+
+namespace
+{
+const int drawCount = 2000000;
+
+template <typename Engine>
+void benchEngine(const std::string& name)
+{
+    BasicRandomGenerator<Engine> generator(12345);
+    std::printf("  %-40s %12zu bytes\n", (name + " state").c_str(), sizeof(generator));
+
+    long sum = 0;
+    double seconds = bench::measure([&]
+    {
+        for (int i = 0; i < drawCount; ++i)
+            sum += generator.range(0, 99);
+    });
+    bench::report(name + " range", seconds, drawCount, "draw");
+
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < drawCount; ++i)
+            sum += generator.roll(6, 3);
+    });
+    bench::report(name + " roll 3d6", seconds, drawCount, "roll");
+
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < drawCount; ++i)
+            sum += generator.oneIn(10);
+    });
+    bench::report(name + " oneIn", seconds, drawCount, "draw");
+
+    double total = 0.;
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < drawCount; ++i)
+            total += generator.normal(0., 1.);
+    });
+    bench::report(name + " normal", seconds, drawCount, "draw");
+
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < drawCount / 100; ++i)
+        {
+            generator.seed(i);
+            sum += generator.getEngine()() & 1;
+        }
+    });
+    bench::report(name + " seed + first draw", seconds, drawCount / 100, "seed");
+
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < drawCount / 100; ++i)
+        {
+            auto state = generator.saveState();
+            generator.loadState(state);
+            sum += state[4 + i % 8];
+        }
+    });
+    bench::report(name + " save + load state", seconds, drawCount / 100, "snapshot");
+
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < drawCount / 100; ++i)
+        {
+            generator.discard(1000);
+            sum += generator.getEngine()() & 1;
+        }
+    });
+    bench::report(name + " discard 1000", seconds, drawCount / 100, "skip");
+
+    bench::keep(sum);
+    bench::keep(total);
+}
+}
+
+BENCHMARK(randomEngines)
+{
+    benchEngine<std::mt19937>("mt19937");
+    benchEngine<Xoshiro256StarStar>("xoshiro256**");
+    benchEngine<Pcg32>("pcg32");
+    benchEngine<SplitMix64>("splitmix64");
+
+    // The static interface, which dispatches on the engine selected at runtime
+    long sum = 0;
+    Random::setEngine(Random::Engine::Xoshiro256StarStar);
+    double seconds = bench::measure([&]
+    {
+        for (int i = 0; i < drawCount; ++i)
+            sum += Random::range(0, 99);
+    });
+    bench::report("Random::range (xoshiro256**)", seconds, drawCount, "draw");
+    Random::setEngine(Random::Engine::Mt19937);
+    bench::keep(sum);
+}
+
+BENCHMARK(randomSampling)
+{
+    BasicRandomGenerator<Pcg32> generator(12345);
+    std::vector<int> population(100000);
+    for (size_t i = 0; i < population.size(); ++i)
+        population[i] = static_cast<int>(i);
+    const int rounds = 200;
+
+    // Picking 20 spawn points out of 100000 cells
+    long sum = 0;
+    double seconds = bench::measure([&]
+    {
+        for (int i = 0; i < rounds; ++i)
+        {
+            std::shuffle(population.begin(), population.end(), generator.getEngine());
+            for (int j = 0; j < 20; ++j)
+                sum += population[j];
+        }
+    });
+    bench::report("pick 20 of 100000 with std::shuffle", seconds, rounds, "pick");
+
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < rounds; ++i)
+            for (int item : generator.sample(population, 20))
+                sum += item;
+    });
+    bench::report("pick 20 of 100000 with sample", seconds, rounds, "pick");
+
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < rounds; ++i)
+            sum += generator.sampleIndices(100000, 1000)[0];
+    });
+    bench::report("sampleIndices 1000 of 100000", seconds, rounds, "sample");
+
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < rounds; ++i)
+        {
+            generator.shuffle(population);
+            sum += population[0];
+        }
+    });
+    bench::report("shuffle 100000", seconds, rounds, "shuffle");
+
+    seconds = bench::measure([&]
+    {
+        for (int i = 0; i < rounds; ++i)
+            sum += generator.sample(population.begin(), population.end(), 20)[0];
+    });
+    bench::report("reservoir 20 of 100000", seconds, rounds, "sample");
+
+    bench::keep(sum);
+}
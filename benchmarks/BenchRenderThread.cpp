@@ -0,0 +1,49 @@
+#include "bench.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <lazarus/RenderThread.h>
+
+using namespace lz;
+
+BENCHMARK(renderThread)
+{
+    const int snapshots = 100000;
+
+    // Publishing while the render thread draws as fast as it can
+    std::atomic<uint64_t> drawn{0};
+    {
+        RenderThread<> thread([&drawn](const RenderSnapshot& snapshot, bool) { drawn = snapshot.inputs; });
+        double seconds = bench::measure([&]
+        {
+            for (int i = 1; i <= snapshots; ++i)
+            {
+                thread.getSnapshot().inputs = i;
+                thread.publish();
+            }
+        });
+        bench::report("publish with a busy render thread", seconds, snapshots, "snapshot");
+        while (drawn != static_cast<uint64_t>(snapshots))
+            std::this_thread::yield();
+    }
+
+    // Time from publishing to drawing, when the render thread sleeps in between
+    const int handovers = 1000;
+    RenderThread<> thread([&drawn](const RenderSnapshot& snapshot, bool) { drawn = snapshot.inputs; });
+    double seconds = bench::measure([&]
+    {
+        for (int i = 1; i <= handovers; ++i)
+        {
+            thread.getSnapshot().inputs = thread.receiveInput();
+            thread.publish();
+            while (drawn != static_cast<uint64_t>(i))
+                std::this_thread::yield();
+        }
+    });
+    bench::report("publish to draw, sleeping render thread", seconds, handovers, "snapshot");
+    SystemTiming latency = thread.getInputLatency();
+    bench::report("input latency p50", std::chrono::duration<double>(latency.p50).count(), 1, "input");
+    bench::report("input latency p95", std::chrono::duration<double>(latency.p95).count(), 1, "input");
+}
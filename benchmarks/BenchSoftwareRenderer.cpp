@@ -0,0 +1,79 @@
+#include "bench.h"
+
+#include <sstream>
+
+#include <lazarus/Random.h>
+#include <lazarus/SoftwareRenderer.h>
+
+using namespace lz;
+
+namespace
+{
+const size_t columns = 80, rows = 50;
+const size_t tileWidth = 8, tileHeight = 12;
+const int frames = 200;
+
+// A CP437-sized atlas whose glyphs cover about a third of their tile
+Framebuffer makeAtlas()
+{
+    RandomGenerator random(12345);
+    Framebuffer atlas(16 * tileWidth, 16 * tileHeight, Color::Transparent);
+    for (size_t y = 0; y < atlas.getHeight(); ++y)
+        for (size_t x = 0; x < atlas.getWidth(); ++x)
+            if (random.range(0, 2) == 0)
+                atlas(x, y) = Color::White;
+    return atlas;
+}
+
+Color randomColor(RandomGenerator& random)
+{
+    return Color(static_cast<uint8_t>(random.range(0, 255)), static_cast<uint8_t>(random.range(0, 255)),
+                 static_cast<uint8_t>(random.range(0, 255)));
+}
+}
+
+BENCHMARK(softwareRenderer)
+{
+    const Framebuffer atlas = makeAtlas();
+    RandomGenerator random(12345);
+    CellBuffer cells(columns, rows);
+    for (size_t y = 0; y < rows; ++y)
+        for (size_t x = 0; x < columns; ++x)
+            cells.set(x, y, random.range(0u, 255u), randomColor(random), randomColor(random));
+
+    SoftwareRenderer renderer(atlas, tileWidth, tileHeight);
+    renderer.update(cells);
+    double seconds = bench::measure([&]
+    {
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            cells.markDirty();
+            renderer.update(cells);
+        }
+    });
+    bench::report("full frame 80x50 8x12 tiles", seconds, frames * columns * rows, "cell");
+    bench::report("full frame 80x50 8x12 tiles", seconds, frames, "frame");
+
+    // A typical turn: the player and a few monsters move
+    seconds = bench::measure([&]
+    {
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            for (int moved = 0; moved < 8; ++moved)
+                cells.set(random.range(0u, columns - 1), random.range(0u, rows - 1), '@',
+                          Color::White, Color::Black);
+            renderer.update(cells);
+        }
+    });
+    bench::report("dirty frame 8 cells changed", seconds, frames, "frame");
+
+    std::string png;
+    seconds = bench::measure([&]
+    {
+        std::stringstream stream;
+        renderer.getFramebuffer().writePng(stream);
+        png = stream.str();
+    });
+    bench::report("PNG dump 640x600", seconds, png.size(), "byte");
+    bench::keep(png.size());
+}
@@ -0,0 +1,58 @@
+#include "bench.h"
+
+#include <numeric>
+#include <vector>
+
+#include <lazarus/WeightedSampler.h>
+
+using namespace lz;
+
+BENCHMARK(weightedSampling)
+{
+    const int sampleCount = 2000000;
+    for (size_t size : {16u, 5000u})
+    {
+        RandomGenerator generator(12345);
+        std::vector<double> weights(size), cumulative(size);
+        for (size_t i = 0; i < size; ++i)
+            weights[i] = generator.range(1., 100.);
+        std::partial_sum(weights.begin(), weights.end(), cumulative.begin());
+        std::string suffix = " (" + std::to_string(size) + " weights)";
+
+        // The linear scan of cumulative weights that the samplers replace
+        size_t sum = 0;
+        double seconds = bench::measure([&]
+        {
+            for (int i = 0; i < sampleCount; ++i)
+            {
+                double value = generator.range(0., cumulative.back());
+                size_t index = 0;
+                while (index + 1 < size && cumulative[index] <= value)
+                    ++index;
+                sum += index;
+            }
+        });
+        bench::report("linear scan" + suffix, seconds, sampleCount, "sample");
+
+        AliasTable table(weights);
+        seconds = bench::measure([&]
+        {
+            for (int i = 0; i < sampleCount; ++i)
+                sum += table.sample(generator);
+        });
+        bench::report("alias table" + suffix, seconds, sampleCount, "sample");
+
+        DynamicWeightedSampler sampler(weights);
+        seconds = bench::measure([&]
+        {
+            for (int i = 0; i < sampleCount; ++i)
+            {
+                size_t index = sampler.sample(generator);
+                sampler.setWeight(index, weights[index]);
+                sum += index;
+            }
+        });
+        bench::report("dynamic sample + update" + suffix, seconds, sampleCount, "sample");
+        bench::keep(sum);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal harness for the Lazarus micro-benchmarks.
+ *
+ * Benchmarks are defined with the BENCHMARK macro, and all of them are run by
+ * the lazarus_bench executable, or only those whose name contains the first
+ * command line argument.
+ */
+namespace bench
+{
+using Clock = std::chrono::steady_clock;
+
+struct Benchmark
+{
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<Benchmark>& registry()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+struct Registrar
+{
+    Registrar(const char* name, void (*run)())
+    {
+        registry().push_back(Benchmark{name, run});
+    }
+};
+
+// Returns the seconds taken by a call to func
+template <typename Func>
+double measure(Func func)
+{
+    auto start = Clock::now();
+    func();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Prints the time per operation and the throughput of a measurement
+inline void report(const std::string& label, double seconds, double operations,
+                   const char* unit="op")
+{
+    std::printf("  %-40s %12.1f ns/%s %14.0f %s/s\n", label.c_str(),
+                seconds * 1e9 / operations, unit, operations / seconds, unit);
+}
+
+// Prevents the compiler from optimizing away a computed value
+template <typename T>
+void keep(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    // Makes the compiler assume that the value is read, without any store
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+}
+
+#define BENCHMARK(name) \
+    static void name(); \
+    static bench::Registrar name##Registrar(#name, name); \
+    static void name()
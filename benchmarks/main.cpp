@@ -0,0 +1,16 @@
+#include "bench.h"
+
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : "";
+    for (const auto& benchmark : bench::registry())
+    {
+        if (std::strstr(benchmark.name, filter) == nullptr)
+            continue;
+        std::printf("%s\n", benchmark.name);
+        benchmark.run();
+    }
+    return 0;
+}
@@ -0,0 +1,281 @@
+#include <lazarus/Atlas.h>
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include <lazarus/common.h>
+
+using namespace lz;
+
+namespace
+{
+// Version of the cached atlases, to be increased when the way they are built changes
+const uint32_t CACHE_VERSION = 1;
+
+// A glyph to be packed, which is a rectangle of one of the loaded images
+struct Piece
+{
+    const sf::Image* image;
+    sf::IntRect rect;
+};
+
+// FNV-1a, which is enough to tell apart the inputs of different atlases
+class Hasher
+{
+public:
+    void add(const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+
+    template <typename T>
+    void add(const T& value) { add(&value, sizeof(value)); }
+
+    uint64_t get() const { return hash; }
+
+private:
+    uint64_t hash = 0xCBF29CE484222325ull;
+};
+
+sf::Image& loadImage(std::deque<sf::Image>& images, const std::string& path)
+{
+    images.emplace_back();
+    if (!images.back().loadFromFile(path))
+        throw __lz::LazarusException("Could not load the image " + path);
+    return images.back();
+}
+}
+
+AtlasBuilder::AtlasBuilder(unsigned pageSize, unsigned padding)
+    : pageSize(pageSize)
+    , padding(padding)
+{
+    if (pageSize == 0)
+        throw __lz::LazarusException("The size of the pages must be positive");
+}
+
+void AtlasBuilder::addBitmapFont(const std::string& path, sf::Vector2u tileSize,
+                                 uint32_t firstGlyph, const sf::Color& key)
+{
+    if (tileSize.x == 0 || tileSize.y == 0)
+        throw __lz::LazarusException("The size of the tiles must be positive");
+    sources.push_back(Source{Source::BitmapFont, path, tileSize, firstGlyph, firstGlyph, 0, key});
+}
+
+void AtlasBuilder::addFont(const std::string& path, unsigned characterSize, uint32_t first,
+                           uint32_t last, sf::Vector2u tileSize)
+{
+    if (tileSize.x == 0 || tileSize.y == 0 || characterSize == 0)
+        throw __lz::LazarusException("The size of the tiles and characters must be positive");
+    if (first > last)
+        throw __lz::LazarusException("Empty range of code points");
+    sources.push_back(Source{Source::Font, path, tileSize, first, last, characterSize,
+                             sf::Color::Transparent});
+}
+
+void AtlasBuilder::addTile(const std::string& path, uint32_t glyph)
+{
+    sources.push_back(Source{Source::Tile, path, sf::Vector2u(), glyph, glyph, 0,
+                             sf::Color::Transparent});
+}
+
+void AtlasBuilder::pack(std::vector<sf::Image>& pages, GlyphTable& glyphs) const
+{
+    // Images of the sources, and the glyphs cut from them, where later
+    // sources replace the glyphs of earlier ones
+    std::deque<sf::Image> images;
+    std::map<uint32_t, Piece> pieces;
+
+    for (const Source& source : sources)
+    {
+        const unsigned w = source.tileSize.x, h = source.tileSize.y;
+        if (source.type == Source::Tile)
+        {
+            sf::Image& image = loadImage(images, source.path);
+            sf::Vector2u size = image.getSize();
+            pieces[source.first] = Piece{&image, sf::IntRect(0, 0, size.x, size.y)};
+        }
+        else if (source.type == Source::BitmapFont)
+        {
+            sf::Image& image = loadImage(images, source.path);
+            if (source.key.a != 0)
+                image.createMaskFromColor(source.key);
+            unsigned columns = image.getSize().x / w, rows = image.getSize().y / h;
+            for (unsigned i = 0; i < columns * rows; ++i)
+                pieces[source.first + i] = Piece{&image, sf::IntRect((i % columns) * w, (i / columns) * h, w, h)};
+        }
+        else
+        {
+            sf::Font font;
+            if (!font.loadFromFile(source.path))
+                throw __lz::LazarusException("Could not load the font " + source.path);
+
+            // Render every glyph first, since the texture of the font grows
+            // as glyphs are added, and find the common baseline
+            std::vector<sf::Glyph> rendered;
+            float ascent = 0.f;
+            for (uint32_t codePoint = source.first; ; ++codePoint)
+            {
+                rendered.push_back(font.getGlyph(codePoint, source.characterSize, false));
+                ascent = std::max(ascent, -rendered.back().bounds.top);
+                if (codePoint == source.last)
+                    break;
+            }
+            sf::Image glyphImages = font.getTexture(source.characterSize).copyToImage();
+
+            // Each glyph is copied into its own tile, which clips what overflows it
+            for (size_t i = 0; i < rendered.size(); ++i)
+            {
+                images.emplace_back();
+                sf::Image& tile = images.back();
+                tile.create(w, h, sf::Color::Transparent);
+                const sf::Glyph& glyph = rendered[i];
+                if (glyph.textureRect.width > 0 && glyph.textureRect.height > 0)
+                {
+                    int x = std::max(static_cast<int>(glyph.bounds.left), 0);
+                    int y = std::max(static_cast<int>(ascent + glyph.bounds.top), 0);
+                    if (x < static_cast<int>(w) && y < static_cast<int>(h))
+                        tile.copy(glyphImages, x, y, glyph.textureRect, false);
+                }
+                pieces[source.first + static_cast<uint32_t>(i)] = Piece{&tile, sf::IntRect(0, 0, w, h)};
+            }
+        }
+    }
+
+    // Pack from the tallest to the shortest, which keeps the skyline flat
+    std::vector<std::pair<uint32_t, Piece>> sorted(pieces.begin(), pieces.end());
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const std::pair<uint32_t, Piece>& a, const std::pair<uint32_t, Piece>& b)
+                     {
+                         if (a.second.rect.height != b.second.rect.height)
+                             return a.second.rect.height > b.second.rect.height;
+                         return a.second.rect.width > b.second.rect.width;
+                     });
+
+    std::vector<SkylinePacker> packers;
+    std::vector<AtlasRect> rects;
+    glyphs = GlyphTable();
+    for (const auto& entry : sorted)
+    {
+        const sf::IntRect& rect = entry.second.rect;
+        if (rect.width <= 0 || rect.height <= 0)
+            continue;
+
+        AtlasRect packed{0, 0, 0, static_cast<uint32_t>(rect.width), static_cast<uint32_t>(rect.height)};
+        bool placed = false;
+        for (size_t page = 0; page < packers.size() && !placed; ++page)
+        {
+            placed = packers[page].insert(packed.width + padding, packed.height + padding, packed.x, packed.y);
+            packed.page = static_cast<uint32_t>(page);
+        }
+        if (!placed)
+        {
+            packers.emplace_back(pageSize, pageSize);
+            packed.page = static_cast<uint32_t>(packers.size() - 1);
+            if (!packers.back().insert(packed.width + padding, packed.height + padding, packed.x, packed.y))
+                throw __lz::LazarusException("Glyph " + std::to_string(entry.first)
+                                             + " is bigger than a page of the atlas");
+        }
+        glyphs.set(entry.first, packed);
+        rects.push_back(packed);
+    }
+
+    // Copy the glyphs into pages as high as their contents
+    pages.assign(packers.size(), sf::Image());
+    for (size_t page = 0; page < packers.size(); ++page)
+        pages[page].create(pageSize, std::max(packers[page].getUsedHeight(), 1u), sf::Color::Transparent);
+    size_t index = 0;
+    for (const auto& entry : sorted)
+    {
+        if (entry.second.rect.width <= 0 || entry.second.rect.height <= 0)
+            continue;
+        const AtlasRect& packed = rects[index++];
+        pages[packed.page].copy(*entry.second.image, packed.x, packed.y, entry.second.rect, false);
+    }
+}
+
+Atlas AtlasBuilder::build() const
+{
+    std::vector<sf::Image> images;
+    Atlas atlas;
+    pack(images, atlas.glyphs);
+
+    atlas.pages.resize(images.size());
+    for (size_t page = 0; page < images.size(); ++page)
+        if (!atlas.pages[page].loadFromImage(images[page]))
+            throw __lz::LazarusException("Could not create the texture of the atlas");
+    return atlas;
+}
+
+Atlas AtlasBuilder::build(const std::string& cacheDirectory) const
+{
+    std::stringstream prefix;
+    prefix << cacheDirectory << "/lazarus-atlas-" << std::hex << std::setw(16) << std::setfill('0')
+           << cacheKey();
+    const std::string tablePath = prefix.str() + ".table";
+    auto pagePath = [&prefix](size_t page) { return prefix.str() + "-" + std::to_string(page) + ".png"; };
+
+    // Use the cache if every part of it can be loaded
+    Atlas atlas;
+    std::ifstream cachedTable(tablePath, std::ios::binary);
+    if (cachedTable && atlas.glyphs.load(cachedTable))
+    {
+        atlas.pages.resize(atlas.glyphs.getPageCount());
+        bool loaded = true;
+        for (size_t page = 0; page < atlas.pages.size() && loaded; ++page)
+            loaded = atlas.pages[page].loadFromFile(pagePath(page));
+        if (loaded)
+            return atlas;
+    }
+
+    std::vector<sf::Image> images;
+    atlas = Atlas();
+    pack(images, atlas.glyphs);
+    atlas.pages.resize(images.size());
+    for (size_t page = 0; page < images.size(); ++page)
+    {
+        if (!atlas.pages[page].loadFromImage(images[page]))
+            throw __lz::LazarusException("Could not create the texture of the atlas");
+        images[page].saveToFile(pagePath(page));
+    }
+
+    // The table is written last, so that a cache missing some page is never used
+    std::ofstream table(tablePath, std::ios::binary);
+    if (table)
+        atlas.glyphs.save(table);
+    return atlas;
+}
+
+uint64_t AtlasBuilder::cacheKey() const
+{
+    Hasher hasher;
+    hasher.add(CACHE_VERSION);
+    hasher.add(pageSize);
+    hasher.add(padding);
+    for (const Source& source : sources)
+    {
+        hasher.add(source.type);
+        hasher.add(source.tileSize.x);
+        hasher.add(source.tileSize.y);
+        hasher.add(source.first);
+        hasher.add(source.last);
+        hasher.add(source.characterSize);
+        hasher.add(source.key.r);
+        hasher.add(source.key.g);
+        hasher.add(source.key.b);
+        hasher.add(source.key.a);
+
+        // The contents of the files, so that editing them rebuilds the atlas
+        std::ifstream file(source.path, std::ios::binary);
+        char buffer[4096];
+        while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+            hasher.add(buffer, static_cast<size_t>(file.gcount()));
+    }
+    return hasher.get();
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include <lazarus/AtlasPacker.h>
+
+namespace lz
+{
+/**
+ * Glyphs and tiles packed into one or more textures.
+ *
+ * @see AtlasBuilder
+ */
+class Atlas
+{
+public:
+    /**
+     * Returns the number of textures of the atlas.
+     */
+    size_t getPageCount() const { return pages.size(); }
+
+    /**
+     * Returns one of the textures of the atlas.
+     */
+    const sf::Texture& getPage(size_t page) const { return pages[page]; }
+
+    /**
+     * Returns where each glyph is stored in the pages.
+     */
+    const GlyphTable& getGlyphs() const { return glyphs; }
+
+private:
+    friend class AtlasBuilder;
+
+    std::vector<sf::Texture> pages;
+    GlyphTable glyphs;
+};
+
+/**
+ * Builds a texture atlas out of bitmap fonts, TrueType fonts and loose tiles.
+ *
+ * Every glyph of the sources is identified by a number, which is the value of
+ * Cell::glyph that draws it. The sources are added to the builder, and build
+ * packs all of them into as few pages as possible with a SkylinePacker. When
+ * two sources give the same glyph, the last one is kept.
+ *
+ * Building an atlas from TrueType fonts takes a while, so the result can be
+ * cached in a directory, as PNG pages and a glyph table. The cache is used as
+ * long as the sources and the settings of the builder do not change.
+ *
+ * @see Atlas
+ * @see TileRenderer
+ */
+class AtlasBuilder
+{
+public:
+    /**
+     * Creates a builder for pages of at most the given size, with the given
+     * number of empty pixels between the glyphs, which avoids bleeding
+     * between neighbouring glyphs when the atlas is scaled.
+     */
+    explicit AtlasBuilder(unsigned pageSize=2048, unsigned padding=1);
+
+    /**
+     * Adds the glyphs of a bitmap font, an image made of tiles of the given
+     * size, numbered from left to right and top to bottom starting with the
+     * given glyph. This is the layout of CP437 fonts.
+     *
+     * Fonts that use a color instead of transparency for the background can
+     * give that color as the key, which is made transparent.
+     */
+    void addBitmapFont(const std::string& path, sf::Vector2u tileSize, uint32_t firstGlyph=0,
+                       const sf::Color& key=sf::Color::Transparent);
+
+    /**
+     * Adds the glyphs of a TrueType font for the code points in [first, last],
+     * each rendered into a tile of the given size with its baseline at the
+     * same height. Code points that are not in the font get the replacement
+     * glyph of the font.
+     */
+    void addFont(const std::string& path, unsigned characterSize, uint32_t first, uint32_t last,
+                 sf::Vector2u tileSize);
+
+    /**
+     * Adds an image file as a single glyph.
+     */
+    void addTile(const std::string& path, uint32_t glyph);
+
+    /**
+     * Loads the sources and packs them into an atlas.
+     *
+     * Throws an exception if a source cannot be loaded, or if a glyph is
+     * bigger than a page.
+     */
+    Atlas build() const;
+
+    /**
+     * Loads the atlas from the cache in the given directory, or builds it and
+     * stores it in the cache if the cache is missing or out of date.
+     *
+     * The directory must exist. Errors writing the cache are ignored.
+     */
+    Atlas build(const std::string& cacheDirectory) const;
+
+private:
+    struct Source
+    {
+        enum Type
+        {
+            BitmapFont,
+            Font,
+            Tile
+        };
+
+        Type type;
+        std::string path;
+        sf::Vector2u tileSize;
+        uint32_t first;
+        uint32_t last;
+        unsigned characterSize;
+        sf::Color key;
+    };
+
+    // Loads the sources and packs them into images of the pages
+    void pack(std::vector<sf::Image>& pages, GlyphTable& glyphs) const;
+
+    // Returns a hash of the settings and of the contents of the sources
+    uint64_t cacheKey() const;
+
+private:
+    unsigned pageSize;
+    unsigned padding;
+    std::vector<Source> sources;
+};
+}  // namespace lz
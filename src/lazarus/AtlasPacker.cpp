@@ -0,0 +1,196 @@
+#include <lazarus/AtlasPacker.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <lazarus/common.h>
+
+using namespace lz;
+
+const uint32_t GlyphTable::DENSE_LIMIT;
+
+SkylinePacker::SkylinePacker(uint32_t width, uint32_t height)
+    : width(width)
+    , height(height)
+{
+    if (width == 0 || height == 0)
+        throw __lz::LazarusException("The size of the packed area must be positive");
+    clear();
+}
+
+void SkylinePacker::clear()
+{
+    skyline.assign(1, Segment{0, 0, width});
+    usedArea = 0;
+}
+
+bool SkylinePacker::restingHeight(size_t segment, uint32_t width, uint32_t& y) const
+{
+    if (skyline[segment].x + width > this->width)
+        return false;
+
+    // The rectangle rests on the highest of the segments below it
+    y = 0;
+    uint32_t covered = 0;
+    for (size_t i = segment; covered < width; ++i)
+    {
+        y = std::max(y, skyline[i].y);
+        covered += skyline[i].width;
+    }
+    return true;
+}
+
+bool SkylinePacker::insert(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y)
+{
+    if (width == 0 || height == 0)
+    {
+        x = y = 0;
+        return true;
+    }
+
+    // Bottom-left rule: the lowest top, then the leftmost position
+    size_t best = skyline.size();
+    uint32_t bestTop = 0;
+    for (size_t i = 0; i < skyline.size(); ++i)
+    {
+        uint32_t restY;
+        if (!restingHeight(i, width, restY) || restY + height > this->height)
+            continue;
+        if (best == skyline.size() || restY + height < bestTop)
+        {
+            best = i;
+            bestTop = restY + height;
+        }
+    }
+    if (best == skyline.size())
+        return false;
+
+    x = skyline[best].x;
+    y = bestTop - height;
+
+    // Raise the skyline under the rectangle, trimming the segments it covers
+    skyline.insert(skyline.begin() + best, Segment{x, bestTop, width});
+    size_t next = best + 1;
+    while (next < skyline.size() && skyline[next].x < x + width)
+    {
+        uint32_t end = skyline[next].x + skyline[next].width;
+        if (end <= x + width)
+            skyline.erase(skyline.begin() + next);
+        else
+        {
+            skyline[next].width = end - (x + width);
+            skyline[next].x = x + width;
+            break;
+        }
+    }
+
+    // Merge neighbours at the same height
+    for (size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+            ++i;
+    }
+
+    usedArea += static_cast<uint64_t>(width) * height;
+    return true;
+}
+
+uint32_t SkylinePacker::getUsedHeight() const
+{
+    uint32_t used = 0;
+    for (const Segment& segment : skyline)
+        used = std::max(used, segment.y);
+    return used;
+}
+
+double SkylinePacker::getOccupancy() const
+{
+    uint32_t used = getUsedHeight();
+    return used > 0 ? static_cast<double>(usedArea) / (static_cast<double>(width) * used) : 0.;
+}
+
+void GlyphTable::set(uint32_t glyph, const AtlasRect& rect)
+{
+    if (rect.width == 0 || rect.height == 0)
+        throw __lz::LazarusException("Glyphs must have a positive size");
+
+    bool isNew;
+    if (glyph < DENSE_LIMIT)
+    {
+        if (glyph >= dense.size())
+            dense.resize(glyph + 1, AtlasRect{0, 0, 0, 0, 0});
+        isNew = dense[glyph].width == 0;
+        dense[glyph] = rect;
+    }
+    else
+    {
+        auto inserted = sparse.insert(std::make_pair(glyph, rect));
+        isNew = inserted.second;
+        if (!isNew)
+            inserted.first->second = rect;
+    }
+
+    if (isNew)
+        ++count;
+    pageCount = std::max(pageCount, rect.page + 1);
+}
+
+void GlyphTable::save(std::ostream& out) const
+{
+    auto write = [&out](const void* data, size_t size) { out.write(static_cast<const char*>(data), size); };
+
+    uint64_t glyphs = count;
+    write(__lz::GLYPH_TABLE_MAGIC, sizeof(__lz::GLYPH_TABLE_MAGIC));
+    write(&__lz::GLYPH_TABLE_VERSION, sizeof(__lz::GLYPH_TABLE_VERSION));
+    write(&pageCount, sizeof(pageCount));
+    write(&glyphs, sizeof(glyphs));
+
+    auto writeGlyph = [&write](uint32_t glyph, const AtlasRect& rect)
+    {
+        write(&glyph, sizeof(glyph));
+        write(&rect, sizeof(rect));
+    };
+    for (uint32_t glyph = 0; glyph < dense.size(); ++glyph)
+        if (dense[glyph].width > 0)
+            writeGlyph(glyph, dense[glyph]);
+    for (const auto& entry : sparse)
+        writeGlyph(entry.first, entry.second);
+}
+
+bool GlyphTable::load(std::istream& in)
+{
+    *this = GlyphTable();
+    auto read = [&in](void* data, size_t size)
+    {
+        return static_cast<bool>(in.read(static_cast<char*>(data), size));
+    };
+
+    char magic[sizeof(__lz::GLYPH_TABLE_MAGIC)];
+    uint8_t version;
+    uint32_t pages;
+    uint64_t glyphs;
+    if (!read(magic, sizeof(magic)) || std::memcmp(magic, __lz::GLYPH_TABLE_MAGIC, sizeof(magic)) != 0
+        || !read(&version, sizeof(version)) || version != __lz::GLYPH_TABLE_VERSION
+        || !read(&pages, sizeof(pages)) || !read(&glyphs, sizeof(glyphs)))
+        return false;
+
+    for (uint64_t i = 0; i < glyphs; ++i)
+    {
+        uint32_t glyph;
+        AtlasRect rect;
+        if (!read(&glyph, sizeof(glyph)) || !read(&rect, sizeof(rect))
+            || rect.width == 0 || rect.height == 0 || rect.page >= pages)
+        {
+            *this = GlyphTable();
+            return false;
+        }
+        set(glyph, rect);
+    }
+    pageCount = pages;
+    return true;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace __lz  // Meant for internal use only
+{
+// Magic bytes and version at the start of every saved glyph table
+const char GLYPH_TABLE_MAGIC[4] = {'L', 'Z', 'A', 'T'};
+const uint8_t GLYPH_TABLE_VERSION = 1;
+}
+
+namespace lz
+{
+/**
+ * A rectangle of pixels in a page of a texture atlas.
+ */
+struct AtlasRect
+{
+    uint32_t page;
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+/**
+ * Packs rectangles into a fixed-size area, for building texture atlases.
+ *
+ * The packer keeps the skyline of the rectangles placed so far, and puts each
+ * new one at the lowest position where it fits, which wastes little space when
+ * the rectangles are inserted from the tallest to the shortest.
+ */
+class SkylinePacker
+{
+public:
+    /**
+     * Creates a packer for an empty area of the given size.
+     */
+    SkylinePacker(uint32_t width, uint32_t height);
+
+    /**
+     * Finds room for a rectangle of the given size, and returns its position
+     * in x and y. Returns false, without changing the packer, if it does not fit.
+     */
+    bool insert(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y);
+
+    /**
+     * Empties the area.
+     */
+    void clear();
+
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+
+    /**
+     * Returns the height of the highest rectangle placed so far.
+     */
+    uint32_t getUsedHeight() const;
+
+    /**
+     * Returns the fraction of the used height covered by rectangles.
+     */
+    double getOccupancy() const;
+
+private:
+    // A horizontal segment of the skyline, which starts at x and is y pixels high
+    struct Segment
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+    };
+
+    // Returns the height at which a rectangle of the given width starting at
+    // the given segment would rest, or false if it goes past the right edge
+    bool restingHeight(size_t segment, uint32_t width, uint32_t& y) const;
+
+private:
+    uint32_t width;
+    uint32_t height;
+    std::vector<Segment> skyline;
+    uint64_t usedArea = 0;
+};
+
+/**
+ * Maps glyphs to the rectangles of a texture atlas where they are stored.
+ *
+ * Lookups are an index into an array for the glyphs below DENSE_LIMIT, which
+ * covers CP437, ASCII and most of the Unicode ranges used by roguelikes, and
+ * a hash table lookup for the rest.
+ *
+ * @see AtlasBuilder
+ */
+class GlyphTable
+{
+public:
+    /**
+     * Glyphs below this limit are stored in an array.
+     */
+    static const uint32_t DENSE_LIMIT = 1 << 16;
+
+    /**
+     * Sets the rectangle of a glyph, replacing its previous one if any.
+     */
+    void set(uint32_t glyph, const AtlasRect& rect);
+
+    /**
+     * Returns the rectangle of a glyph, or nullptr if it is not in the atlas.
+     */
+    const AtlasRect* find(uint32_t glyph) const
+    {
+        if (glyph < dense.size())
+            return dense[glyph].width > 0 ? &dense[glyph] : nullptr;
+        auto found = sparse.find(glyph);
+        return found != sparse.end() ? &found->second : nullptr;
+    }
+
+    /**
+     * Returns the number of glyphs in the table.
+     */
+    size_t size() const { return count; }
+
+    /**
+     * Returns the number of pages the rectangles are spread over.
+     */
+    uint32_t getPageCount() const { return pageCount; }
+
+    /**
+     * Writes the table in a binary format, for caching a built atlas.
+     */
+    void save(std::ostream& out) const;
+
+    /**
+     * Reads a table written by save, replacing the contents of this one.
+     * Returns false, leaving the table empty, if the data is not a valid table.
+     */
+    bool load(std::istream& in);
+
+private:
+    // Empty rectangles mark the glyphs that are not in the table
+    std::vector<AtlasRect> dense;
+    std::unordered_map<uint32_t, AtlasRect> sparse;
+    size_t count = 0;
+    uint32_t pageCount = 0;
+};
+}  // namespace lz
@@ -0,0 +1,291 @@
+#include <lazarus/BatchRandom.h>
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef LZ_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace lz;
+
+const uint32_t BatchRandom::DOMAIN_TAG;
+
+namespace
+{
+const uint32_t PHILOX_M0 = 0xD2511F53u;
+const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+const uint32_t PHILOX_W0 = 0x9E3779B9u;
+const uint32_t PHILOX_W1 = 0xBB67AE85u;
+
+// Number of words generated at once by fillRange and fillNormal
+const size_t CHUNK_SIZE = 256;
+
+using KernelFunc = void (*)(const Philox4x32::Key& key, uint32_t first,
+                            size_t blocks, uint32_t* out);
+
+// Writes the blocks with counters (first + i, 0, 0, DOMAIN_TAG) for i in [0, blocks)
+void philoxScalar(const Philox4x32::Key& key, uint32_t first, size_t blocks, uint32_t* out)
+{
+    for (size_t i = 0; i < blocks; ++i)
+    {
+        Philox4x32::Counter block = Philox4x32::block(
+            {first + static_cast<uint32_t>(i), 0, 0, BatchRandom::DOMAIN_TAG}, key);
+        std::copy(block.begin(), block.end(), out + 4 * i);
+    }
+}
+
+#ifdef LZ_X86_SIMD
+// Multiplies the lanes of a by m, returning the low and high halves of the products
+__attribute__((target("sse2")))
+inline void mulHiLo(__m128i a, __m128i m, __m128i& lo, __m128i& hi)
+{
+    // Products of the even lanes, then of the odd ones, as [lo, hi, lo, hi]
+    __m128i even = _mm_mul_epu32(a, m);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+    even = _mm_shuffle_epi32(even, _MM_SHUFFLE(3, 1, 2, 0));
+    odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(3, 1, 2, 0));
+    lo = _mm_unpacklo_epi32(even, odd);
+    hi = _mm_unpackhi_epi32(even, odd);
+}
+
+// Computes four blocks at a time, with a word of each block in each lane
+__attribute__((target("sse2")))
+void philoxSSE2(const Philox4x32::Key& key, uint32_t first, size_t blocks, uint32_t* out)
+{
+    const __m128i m0 = _mm_set1_epi32(static_cast<int>(PHILOX_M0));
+    const __m128i m1 = _mm_set1_epi32(static_cast<int>(PHILOX_M1));
+    size_t i = 0;
+    for (; i + 4 <= blocks; i += 4)
+    {
+        uint32_t base = first + static_cast<uint32_t>(i);
+        __m128i c0 = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(base)), _mm_set_epi32(3, 2, 1, 0));
+        __m128i c1 = _mm_setzero_si128();
+        __m128i c2 = _mm_setzero_si128();
+        __m128i c3 = _mm_set1_epi32(static_cast<int>(BatchRandom::DOMAIN_TAG));
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; ++round)
+        {
+            if (round > 0)
+            {
+                k0 += PHILOX_W0;
+                k1 += PHILOX_W1;
+            }
+            __m128i lo0, hi0, lo1, hi1;
+            mulHiLo(c0, m0, lo0, hi0);
+            mulHiLo(c2, m1, lo1, hi1);
+            __m128i n0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32(static_cast<int>(k0)));
+            __m128i n2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32(static_cast<int>(k1)));
+            c0 = n0;
+            c1 = lo1;
+            c2 = n2;
+            c3 = lo0;
+        }
+
+        // Transpose the lanes back into blocks
+        __m128i t0 = _mm_unpacklo_epi32(c0, c1);
+        __m128i t1 = _mm_unpacklo_epi32(c2, c3);
+        __m128i t2 = _mm_unpackhi_epi32(c0, c1);
+        __m128i t3 = _mm_unpackhi_epi32(c2, c3);
+        __m128i* dst = reinterpret_cast<__m128i*>(out + 4 * i);
+        _mm_storeu_si128(dst, _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128(dst + 1, _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128(dst + 2, _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128(dst + 3, _mm_unpackhi_epi64(t2, t3));
+    }
+    philoxScalar(key, first + static_cast<uint32_t>(i), blocks - i, out + 4 * i);
+}
+
+__attribute__((target("avx2")))
+inline void mulHiLo(__m256i a, __m256i m, __m256i& lo, __m256i& hi)
+{
+    __m256i even = _mm256_mul_epu32(a, m);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    even = _mm256_shuffle_epi32(even, _MM_SHUFFLE(3, 1, 2, 0));
+    odd = _mm256_shuffle_epi32(odd, _MM_SHUFFLE(3, 1, 2, 0));
+    lo = _mm256_unpacklo_epi32(even, odd);
+    hi = _mm256_unpackhi_epi32(even, odd);
+}
+
+// Computes eight blocks at a time, with a word of each block in each lane
+__attribute__((target("avx2")))
+void philoxAVX2(const Philox4x32::Key& key, uint32_t first, size_t blocks, uint32_t* out)
+{
+    const __m256i m0 = _mm256_set1_epi32(static_cast<int>(PHILOX_M0));
+    const __m256i m1 = _mm256_set1_epi32(static_cast<int>(PHILOX_M1));
+    size_t i = 0;
+    for (; i + 8 <= blocks; i += 8)
+    {
+        uint32_t base = first + static_cast<uint32_t>(i);
+        __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(base)),
+                                      _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+        __m256i c1 = _mm256_setzero_si256();
+        __m256i c2 = _mm256_setzero_si256();
+        __m256i c3 = _mm256_set1_epi32(static_cast<int>(BatchRandom::DOMAIN_TAG));
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; ++round)
+        {
+            if (round > 0)
+            {
+                k0 += PHILOX_W0;
+                k1 += PHILOX_W1;
+            }
+            __m256i lo0, hi0, lo1, hi1;
+            mulHiLo(c0, m0, lo0, hi0);
+            mulHiLo(c2, m1, lo1, hi1);
+            __m256i n0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(static_cast<int>(k0)));
+            __m256i n2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(static_cast<int>(k1)));
+            c0 = n0;
+            c1 = lo1;
+            c2 = n2;
+            c3 = lo0;
+        }
+
+        // The unpacks work within each half, which hold blocks 0-3 and 4-7
+        __m256i t0 = _mm256_unpacklo_epi32(c0, c1);
+        __m256i t1 = _mm256_unpacklo_epi32(c2, c3);
+        __m256i t2 = _mm256_unpackhi_epi32(c0, c1);
+        __m256i t3 = _mm256_unpackhi_epi32(c2, c3);
+        __m256i b04 = _mm256_unpacklo_epi64(t0, t1);
+        __m256i b15 = _mm256_unpackhi_epi64(t0, t1);
+        __m256i b26 = _mm256_unpacklo_epi64(t2, t3);
+        __m256i b37 = _mm256_unpackhi_epi64(t2, t3);
+        __m256i* dst = reinterpret_cast<__m256i*>(out + 4 * i);
+        _mm256_storeu_si256(dst, _mm256_permute2x128_si256(b04, b15, 0x20));
+        _mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(b26, b37, 0x20));
+        _mm256_storeu_si256(dst + 2, _mm256_permute2x128_si256(b04, b15, 0x31));
+        _mm256_storeu_si256(dst + 3, _mm256_permute2x128_si256(b26, b37, 0x31));
+    }
+    // Avoid the penalty of mixing AVX and legacy SSE code in the callers
+    _mm256_zeroupper();
+    philoxSSE2(key, first + static_cast<uint32_t>(i), blocks - i, out + 4 * i);
+}
+#endif
+
+KernelFunc kernelFunction(BatchRandom::Kernel kernel)
+{
+    switch (kernel)
+    {
+#ifdef LZ_X86_SIMD
+        case BatchRandom::Kernel::AVX2:
+            return philoxAVX2;
+        case BatchRandom::Kernel::SSE2:
+            return philoxSSE2;
+#endif
+        default:
+            return philoxScalar;
+    }
+}
+
+// Converts the upper 24 bits of a word into a float in [0, 1)
+inline float toUnit(uint32_t bits)
+{
+    return static_cast<float>(bits >> 8) * (1.f / 16777216.f);
+}
+}
+
+BatchRandom::BatchRandom(unsigned seed, uint32_t stream)
+    : kernel(bestKernel())
+{
+    this->seed(seed, stream);
+}
+
+void BatchRandom::seed(unsigned seed, uint32_t stream)
+{
+    key = Philox4x32::Key{seed, stream};
+    lastSeed = seed;
+    position = 0;
+}
+
+BatchRandom::Kernel BatchRandom::bestKernel()
+{
+    return bestSimdLevel();
+}
+
+void BatchRandom::setKernel(Kernel kernel)
+{
+    this->kernel = std::min(kernel, bestKernel());
+}
+
+uint32_t BatchRandom::nextBits()
+{
+    Philox4x32::Counter block = Philox4x32::block({static_cast<uint32_t>(position / 4), 0, 0, DOMAIN_TAG}, key);
+    return block[position++ % 4];
+}
+
+void BatchRandom::fillBits(uint32_t* values, size_t count)
+{
+    // Finish the current block, then generate whole blocks with the kernel
+    while (count > 0 && position % 4 != 0)
+    {
+        *values++ = nextBits();
+        --count;
+    }
+    size_t blocks = count / 4;
+    kernelFunction(kernel)(key, static_cast<uint32_t>(position / 4), blocks, values);
+    position += 4 * blocks;
+    values += 4 * blocks;
+    for (size_t i = 0; i < count % 4; ++i)
+        *values++ = nextBits();
+}
+
+void BatchRandom::fillRange(int* values, size_t count, int a, int b)
+{
+    if (a > b)
+        std::swap(a, b);
+    uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(b) - a) + 1;
+    // Words below the threshold would make some results more likely than others
+    uint32_t threshold = static_cast<uint32_t>((uint64_t(1) << 32) % range);
+
+    uint32_t chunk[CHUNK_SIZE];
+    for (size_t done = 0; done < count; done += CHUNK_SIZE)
+    {
+        size_t size = std::min(CHUNK_SIZE, count - done);
+        fillBits(chunk, size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            // Lemire's multiply and shift, redrawing the rare biased words
+            uint64_t product = chunk[i] * range;
+            while (static_cast<uint32_t>(product) < threshold)
+                product = nextBits() * range;
+            values[done + i] = static_cast<int>(a + static_cast<int64_t>(product >> 32));
+        }
+    }
+}
+
+void BatchRandom::fillUniform(float* values, size_t count, float a, float b)
+{
+    float scale = b - a;
+    // Rounding can take a + u * scale up to b when u is close to 1
+    float below = a < b ? std::nextafter(b, a) : b;
+    uint32_t chunk[CHUNK_SIZE];
+    for (size_t done = 0; done < count; done += CHUNK_SIZE)
+    {
+        size_t size = std::min(CHUNK_SIZE, count - done);
+        fillBits(chunk, size);
+        for (size_t i = 0; i < size; ++i)
+            values[done + i] = std::min(a + toUnit(chunk[i]) * scale, below);
+    }
+}
+
+void BatchRandom::fillNormal(float* values, size_t count, float mean, float stdev)
+{
+    const double twoPi = 6.283185307179586;
+    uint32_t chunk[CHUNK_SIZE];
+    for (size_t done = 0; done < count; done += CHUNK_SIZE)
+    {
+        // Use an even number of words, since each pair gives two numbers
+        size_t size = std::min(CHUNK_SIZE, count - done);
+        fillBits(chunk, size + size % 2);
+        for (size_t i = 0; i < size; i += 2)
+        {
+            // Shift the first number to (0, 1] to avoid the logarithm of zero
+            double u1 = ((chunk[i] >> 8) + 1) * (1. / 16777216.);
+            double u2 = (chunk[i + 1] >> 8) * (1. / 16777216.);
+            double radius = std::sqrt(-2. * std::log(u1));
+            values[done + i] = static_cast<float>(mean + stdev * radius * std::cos(twoPi * u2));
+            if (i + 1 < size)
+                values[done + i + 1] = static_cast<float>(mean + stdev * radius * std::sin(twoPi * u2));
+        }
+    }
+}
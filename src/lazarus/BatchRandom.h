@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <lazarus/RandomEngines.h>
+#include <lazarus/Simd.h>
+
+namespace lz
+{
+/**
+ * Generates random numbers in bulk.
+ *
+ * Filling a whole array at once is much faster than calling lz::Random for
+ * each value, which is useful for map generation or for spawning particles.
+ *
+ * The numbers come from a Philox4x32 stream, whose blocks are computed several
+ * at a time with SSE2 or AVX2 when the processor supports it. All the kernels
+ * produce exactly the same stream, so the same seed and the same calls fill
+ * the same values regardless of the instruction set used.
+ *
+ * fillBits and fillUniform use one word per value, so they also fill the same
+ * values however they are split between calls. fillRange redraws some words
+ * to avoid bias, and fillNormal uses the words in pairs, so their values
+ * depend on how they are split.
+ *
+ * @see Philox4x32
+ */
+class BatchRandom
+{
+public:
+    /**
+     * The implementations of the generation of the stream.
+     */
+    using Kernel = SimdLevel;
+
+    /**
+     * Last word of the counters of the stream, which keeps it apart from the
+     * streams of counterRandom for the same seed.
+     */
+    static const uint32_t DOMAIN_TAG = 0x42415443;  // "BATC"
+
+    /**
+     * Creates a generator with the given seed, and one of its independent streams.
+     */
+    explicit BatchRandom(unsigned seed=0, uint32_t stream=0);
+
+    /**
+     * Restarts the generator with the given seed and stream.
+     */
+    void seed(unsigned seed, uint32_t stream=0);
+
+    /**
+     * Returns the last seed used for the generator.
+     */
+    unsigned getSeed() const { return lastSeed; }
+
+    /**
+     * Fills the values with uniformly distributed 32 bit words.
+     */
+    void fillBits(uint32_t* values, size_t count);
+
+    /**
+     * Fills the values with random integers between a and b, both included,
+     * with equal probability.
+     *
+     * As with Random::range, a and b can be given in any order.
+     */
+    void fillRange(int* values, size_t count, int a, int b);
+    void fillRange(std::vector<int>& values, int a, int b)
+    {
+        fillRange(values.data(), values.size(), a, b);
+    }
+
+    /**
+     * Fills the values with random numbers in [a, b) with equal probability.
+     *
+     * The numbers have 24 bits of randomness, the precision of a float. Values
+     * that would round up to b are replaced by the float just below it.
+     */
+    void fillUniform(float* values, size_t count, float a=0.f, float b=1.f);
+    void fillUniform(std::vector<float>& values, float a=0.f, float b=1.f)
+    {
+        fillUniform(values.data(), values.size(), a, b);
+    }
+
+    /**
+     * Fills the values with random numbers from a normal distribution with
+     * the given mean and standard deviation.
+     *
+     * The numbers are generated in pairs with the Box-Muller transform, which
+     * uses the math functions of the standard library, so they are only
+     * reproducible across platforms whose math libraries give the same results.
+     */
+    void fillNormal(float* values, size_t count, float mean=0.f, float stdev=1.f);
+    void fillNormal(std::vector<float>& values, float mean=0.f, float stdev=1.f)
+    {
+        fillNormal(values.data(), values.size(), mean, stdev);
+    }
+
+    /**
+     * Sets the kernel used to generate the stream.
+     *
+     * Kernels that the processor does not support fall back to the best
+     * supported one. This is meant for testing and benchmarking, since the
+     * best kernel is selected by default.
+     */
+    void setKernel(Kernel kernel);
+
+    /**
+     * Returns the kernel used to generate the stream.
+     */
+    Kernel getKernel() const { return kernel; }
+
+    /**
+     * Returns the fastest kernel supported by the processor.
+     */
+    static Kernel bestKernel();
+
+private:
+    // Returns the next word of the stream
+    uint32_t nextBits();
+
+private:
+    Philox4x32::Key key;
+    unsigned lastSeed;
+    // Index of the next word of the stream
+    uint64_t position = 0;
+    Kernel kernel;
+};
+}  // namespace lz
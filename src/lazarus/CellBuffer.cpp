@@ -0,0 +1,128 @@
+#include <lazarus/CellBuffer.h>
+
+#include <algorithm>
+
+#include <lazarus/common.h>
+
+using namespace lz;
+
+const Color Color::Black(0, 0, 0);
+const Color Color::White(255, 255, 255);
+const Color Color::Transparent(0, 0, 0, 0);
+
+CellBuffer::CellBuffer(size_t width, size_t height, const Cell& fill)
+    : width(width)
+    , height(height)
+    , cells(width * height, fill)
+{
+    markDirty();
+}
+
+void CellBuffer::resize(size_t width, size_t height, const Cell& fill)
+{
+    std::vector<Cell> resized(width * height, fill);
+    size_t keptWidth = std::min(width, this->width);
+    size_t keptHeight = std::min(height, this->height);
+    for (size_t y = 0; y < keptHeight; ++y)
+        std::copy(cells.begin() + y * this->width, cells.begin() + y * this->width + keptWidth,
+                  resized.begin() + y * width);
+
+    cells.swap(resized);
+    this->width = width;
+    this->height = height;
+    markDirty();
+}
+
+Cell& CellBuffer::at(size_t x, size_t y)
+{
+    if (x >= width || y >= height)
+        throw __lz::LazarusException("Cell out of the buffer");
+    return (*this)(x, y);  // Marks the cell as dirty
+}
+
+const Cell& CellBuffer::at(size_t x, size_t y) const
+{
+    if (x >= width || y >= height)
+        throw __lz::LazarusException("Cell out of the buffer");
+    return (*this)(x, y);
+}
+
+void CellBuffer::set(size_t x, size_t y, const Cell& cell)
+{
+    if (x < width && y < height)
+        (*this)(x, y) = cell;
+}
+
+void CellBuffer::set(size_t x, size_t y, uint32_t glyph, Color foreground, Color background)
+{
+    Cell cell;
+    cell.glyph = glyph;
+    cell.foreground = foreground;
+    cell.background = background;
+    set(x, y, cell);
+}
+
+void CellBuffer::fill(const Cell& cell)
+{
+    std::fill(cells.begin(), cells.end(), cell);
+    markDirty();
+}
+
+void CellBuffer::assign(const CellBuffer& other)
+{
+    if (other.width != width || other.height != height)
+    {
+        width = other.width;
+        height = other.height;
+        cells = other.cells;
+        markDirty();
+        return;
+    }
+
+    for (size_t y = 0; y < height; ++y)
+    {
+        Cell* row = cells.data() + y * width;
+        const Cell* source = other.getRow(y);
+        size_t begin = 0, end = width;
+        while (begin < end && row[begin] == source[begin])
+            ++begin;
+        while (end > begin && row[end - 1] == source[end - 1])
+            --end;
+        if (begin < end)
+        {
+            std::copy(source + begin, source + end, row + begin);
+            markColumns(y, begin, end);
+        }
+    }
+}
+
+size_t CellBuffer::print(size_t x, size_t y, const std::string& text,
+                         Color foreground, Color background)
+{
+    if (y >= height || x >= width)
+        return 0;
+
+    size_t count = std::min(text.size(), width - x);
+    if (count > 0)
+        markColumns(y, x, x + count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Cell& cell = cells[y * width + x + i];
+        cell.glyph = static_cast<unsigned char>(text[i]);
+        cell.foreground = foreground;
+        cell.background = background;
+    }
+    return count;
+}
+
+void CellBuffer::markDirty()
+{
+    dirtyRows.assign(height, Span{0, width});
+    dirty = width > 0 && height > 0;
+}
+
+void CellBuffer::clearDirty()
+{
+    dirtyRows.assign(height, Span{width, 0});
+    dirty = false;
+}
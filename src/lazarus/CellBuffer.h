@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lz
+{
+/**
+ * An RGBA color, with 8 bits per channel.
+ *
+ * It has the same layout as sf::Color, but does not depend on SFML, so the
+ * contents of the screen can be built and tested without a window.
+ */
+struct Color
+{
+    constexpr Color() : r(0), g(0), b(0), a(255) {}
+    constexpr Color(uint8_t r, uint8_t g, uint8_t b, uint8_t a=255) : r(r), g(g), b(b), a(a) {}
+
+    static const Color Black;
+    static const Color White;
+    static const Color Transparent;
+
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+};
+
+inline bool operator==(Color left, Color right)
+{
+    return left.r == right.r && left.g == right.g && left.b == right.b && left.a == right.a;
+}
+
+inline bool operator!=(Color left, Color right)
+{
+    return !(left == right);
+}
+
+/**
+ * A cell of a console: a glyph drawn over a background.
+ */
+struct Cell
+{
+    // Index of the glyph in the atlas, which is the character code for
+    // CP437 and ASCII fonts
+    uint32_t glyph = ' ';
+    Color foreground = Color::White;
+    Color background = Color::Black;
+};
+
+inline bool operator==(const Cell& left, const Cell& right)
+{
+    return left.glyph == right.glyph && left.foreground == right.foreground
+           && left.background == right.background;
+}
+
+inline bool operator!=(const Cell& left, const Cell& right)
+{
+    return !(left == right);
+}
+
+/**
+ * A grid of cells that holds the contents of a console or tile map, to be
+ * drawn by a TileRenderer.
+ *
+ * Cells are stored row by row, with (0, 0) at the top left.
+ *
+ * The buffer keeps track of the cells that may have changed since the last
+ * call to clearDirty, as a range of columns in each row, so that a renderer
+ * can update only those. Every access through a non-const method marks the
+ * cell as dirty, so references to cells must not be kept to change them later.
+ *
+ * @see TileRenderer
+ */
+class CellBuffer
+{
+public:
+    /**
+     * Creates a buffer of the given size, with every cell set to fill.
+     */
+    CellBuffer(size_t width=0, size_t height=0, const Cell& fill=Cell());
+
+    /**
+     * Changes the size of the buffer, keeping the cells that are still
+     * inside it and setting the new ones to fill.
+     */
+    void resize(size_t width, size_t height, const Cell& fill=Cell());
+
+    size_t getWidth() const { return width; }
+    size_t getHeight() const { return height; }
+
+    /**
+     * Returns the cell at the given position, without checking the bounds.
+     */
+    Cell& operator()(size_t x, size_t y)
+    {
+        markColumns(y, x, x + 1);
+        return cells[y * width + x];
+    }
+    const Cell& operator()(size_t x, size_t y) const { return cells[y * width + x]; }
+
+    /**
+     * Returns the cell at the given position.
+     *
+     * An exception is thrown if the position is out of the buffer.
+     */
+    Cell& at(size_t x, size_t y);
+    const Cell& at(size_t x, size_t y) const;
+
+    /**
+     * Sets the cell at the given position, if it is inside the buffer.
+     */
+    void set(size_t x, size_t y, const Cell& cell);
+    void set(size_t x, size_t y, uint32_t glyph, Color foreground, Color background);
+
+    /**
+     * Sets every cell to the given one.
+     */
+    void fill(const Cell& cell=Cell());
+
+    /**
+     * Copies the size and the cells of another buffer, and marks as dirty
+     * only the cells that differ, so that a renderer fed with copies of
+     * buffers, such as snapshots from another thread, still only updates what
+     * changed.
+     */
+    void assign(const CellBuffer& other);
+
+    /**
+     * Writes the text from the given position towards the right, one byte
+     * per cell, and returns the number of cells written. The text is clipped
+     * at the edge of the buffer.
+     */
+    size_t print(size_t x, size_t y, const std::string& text,
+                 Color foreground=Color::White, Color background=Color::Black);
+
+    /**
+     * Returns the first cell of the given row.
+     */
+    const Cell* getRow(size_t y) const { return cells.data() + y * width; }
+
+    /**
+     * Returns all the cells, row by row.
+     */
+    const std::vector<Cell>& getCells() const { return cells; }
+
+    /**
+     * Returns whether any cell may have changed since the last call to clearDirty.
+     */
+    bool isDirty() const { return dirty; }
+
+    /**
+     * Returns the range [first, second) of the columns of the row that may
+     * have changed, which is empty if none did.
+     */
+    std::pair<size_t, size_t> getDirtyColumns(size_t y) const
+    {
+        return std::make_pair(dirtyRows[y].begin, dirtyRows[y].end);
+    }
+
+    /**
+     * Marks every cell as dirty, for example to redraw the whole buffer.
+     */
+    void markDirty();
+
+    /**
+     * Marks every cell as clean, once the changes have been drawn.
+     */
+    void clearDirty();
+
+private:
+    // Marks the columns [begin, end) of the row as dirty
+    void markColumns(size_t y, size_t begin, size_t end)
+    {
+        Span& span = dirtyRows[y];
+        span.begin = begin < span.begin ? begin : span.begin;
+        span.end = end > span.end ? end : span.end;
+        dirty = true;
+    }
+
+private:
+    // Range of dirty columns of a row, which is empty if begin >= end
+    struct Span
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    size_t width;
+    size_t height;
+    std::vector<Cell> cells;
+    std::vector<Span> dirtyRows;
+    bool dirty;
+};
+}  // namespace lz
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <lazarus/CellBuffer.h>
+
+namespace lz
+{
+/**
+ * Interface for the backends that draw a CellBuffer.
+ *
+ * Game code only writes cells, and the backend turns them into pixels: the
+ * TileRenderer draws them on the graphics card through SFML, and the
+ * SoftwareRenderer into an image in memory, which works without a window or
+ * a graphics card and is used by the rendering tests and benchmarks.
+ *
+ * @see TileRenderer
+ * @see SoftwareRenderer
+ */
+class CellRenderer
+{
+public:
+    virtual ~CellRenderer() = default;
+
+    /**
+     * Draws the dirty cells of the buffer, and marks them as clean.
+     *
+     * Returns whether any cell changed, so that frames where none did can
+     * skip presenting the grid again. The whole grid is drawn if the size of
+     * the buffer changed since the last update.
+     */
+    virtual bool update(CellBuffer& cells) = 0;
+};
+}  // namespace lz
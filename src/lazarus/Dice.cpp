@@ -0,0 +1,323 @@
+#include <lazarus/Dice.h>
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+using namespace lz;
+
+const unsigned Dice::EXACT_THRESHOLD;
+const unsigned Dice::APPROXIMATE_THRESHOLD;
+
+namespace
+{
+// Limits on the number of dice and of sides of a roll
+const unsigned MAX_TIMES = 100000;
+const unsigned MAX_SIDES = 1000000;
+// Deepest nesting of parentheses and negations, which are parsed recursively
+const unsigned MAX_NESTING = 64;
+// Largest distribution kept for a roll, in number of possible sums
+const unsigned long long MAX_DISTRIBUTION = 1 << 16;
+// Largest number of steps spent computing the distribution of a roll, which
+// takes about the number of dice times the number of sums
+const unsigned long long MAX_DISTRIBUTION_WORK = 1 << 24;
+
+// Returns the probabilities of each sum of the dice, from times to times * sides
+std::vector<double> sumDistribution(unsigned sides, unsigned times)
+{
+    std::vector<double> distribution{1.};
+    for (unsigned die = 0; die < times; ++die)
+    {
+        // Each new sum is the mean of the sides previous sums below it, which
+        // is computed with a sliding window over the old distribution
+        std::vector<double> next(distribution.size() + sides - 1, 0.);
+        double window = 0.;
+        for (size_t sum = 0; sum < next.size(); ++sum)
+        {
+            if (sum < distribution.size())
+                window += distribution[sum];
+            if (sum >= sides)
+                window -= distribution[sum - sides];
+            next[sum] = std::max(window, 0.) / sides;
+        }
+        distribution.swap(next);
+    }
+    return distribution;
+}
+
+struct Bounds
+{
+    long min;
+    long max;
+    double mean;
+};
+
+// Arithmetic on the bounds of the values, which returns false instead of
+// overflowing
+bool checkedAdd(long a, long b, long& result)
+{
+    if ((b > 0 && a > std::numeric_limits<long>::max() - b) || (b < 0 && a < std::numeric_limits<long>::min() - b))
+        return false;
+    result = a + b;
+    return true;
+}
+
+bool checkedSubtract(long a, long b, long& result)
+{
+    if ((b < 0 && a > std::numeric_limits<long>::max() + b) || (b > 0 && a < std::numeric_limits<long>::min() + b))
+        return false;
+    result = a - b;
+    return true;
+}
+
+bool checkedMultiply(long a, long b, long& result)
+{
+    const long max = std::numeric_limits<long>::max(), min = std::numeric_limits<long>::min();
+    if (a != 0 && b != 0)
+    {
+        bool overflows = a > 0 ? (b > 0 ? a > max / b : b < min / a)
+                               : (b > 0 ? a < min / b : a < max / b);
+        if (overflows)
+            return false;
+    }
+    result = a * b;
+    return true;
+}
+}
+
+Dice::Dice(const std::string& expression)
+    : expression(expression)
+{
+    size_t pos = 0;
+    parseSum(pos);
+    skipSpaces(pos);
+    if (pos < expression.size())
+        fail(pos, "unexpected character");
+    analyze();
+}
+
+const Dice& Dice::get(const std::string& expression)
+{
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::unique_ptr<Dice>> registry;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = registry.find(expression);
+    if (found == registry.end())
+        found = registry.emplace(expression, std::unique_ptr<Dice>(new Dice(expression))).first;
+    return *found->second;
+}
+
+void Dice::parseSum(size_t& pos)
+{
+    parseProduct(pos);
+    while (true)
+    {
+        skipSpaces(pos);
+        if (pos >= expression.size() || (expression[pos] != '+' && expression[pos] != '-'))
+            return;
+        char op = expression[pos++];
+        parseProduct(pos);
+        program.push_back(Instruction{op == '+' ? Instruction::Add : Instruction::Subtract, 0, 0, 0});
+    }
+}
+
+void Dice::parseProduct(size_t& pos)
+{
+    parseFactor(pos);
+    while (true)
+    {
+        skipSpaces(pos);
+        if (pos >= expression.size() || expression[pos] != '*')
+            return;
+        ++pos;
+        parseFactor(pos);
+        program.push_back(Instruction{Instruction::Multiply, 0, 0, 0});
+    }
+}
+
+void Dice::parseFactor(size_t& pos)
+{
+    skipSpaces(pos);
+    if (pos >= expression.size())
+        fail(pos, "expected a number, dice or parenthesis");
+
+    char c = expression[pos];
+    if ((c == '-' || c == '(') && ++nesting > MAX_NESTING)
+        fail(pos, "too deeply nested");
+    if (c == '-')
+    {
+        ++pos;
+        parseFactor(pos);
+        program.push_back(Instruction{Instruction::Negate, 0, 0, 0});
+        --nesting;
+        return;
+    }
+    if (c == '(')
+    {
+        ++pos;
+        parseSum(pos);
+        skipSpaces(pos);
+        if (pos >= expression.size() || expression[pos] != ')')
+            fail(pos, "expected )");
+        ++pos;
+        --nesting;
+        return;
+    }
+
+    unsigned number = 1;
+    bool hasNumber = std::isdigit(static_cast<unsigned char>(c));
+    if (hasNumber)
+        number = parseNumber(pos);
+    if (pos >= expression.size() || std::tolower(static_cast<unsigned char>(expression[pos])) != 'd')
+    {
+        if (!hasNumber)
+            fail(pos, "expected a number, dice or parenthesis");
+        if (static_cast<unsigned long>(number) > static_cast<unsigned long>(std::numeric_limits<long>::max()))
+            fail(pos, "number too big");
+        program.push_back(Instruction{Instruction::Constant, static_cast<long>(number), 0, 0});
+        return;
+    }
+
+    // Dice
+    ++pos;
+    unsigned sides;
+    if (pos < expression.size() && expression[pos] == '%')
+    {
+        sides = 100;
+        ++pos;
+    }
+    else if (pos < expression.size() && std::isdigit(static_cast<unsigned char>(expression[pos])))
+    {
+        size_t start = pos;
+        sides = parseNumber(pos);
+        if (sides == 0 || sides > MAX_SIDES)
+            fail(start, "invalid number of sides");
+    }
+    else
+        fail(pos, "expected the number of sides of the dice");
+    if (number > MAX_TIMES)
+        fail(pos, "too many dice");
+
+    Instruction roll{Instruction::Roll, -1, number, sides};
+    unsigned long long sums = static_cast<unsigned long long>(number) * (sides - 1) + 1;
+    if (number >= EXACT_THRESHOLD && sides > 1)
+    {
+        if (sums <= MAX_DISTRIBUTION && number * sums <= MAX_DISTRIBUTION_WORK)
+        {
+            roll.value = static_cast<long>(distributions.size());
+            distributions.emplace_back(sumDistribution(sides, number));
+        }
+        else if (number >= APPROXIMATE_THRESHOLD)
+            roll.type = Instruction::ApproximateRoll;
+    }
+    program.push_back(roll);
+}
+
+unsigned Dice::parseNumber(size_t& pos)
+{
+    size_t start = pos;
+    unsigned number = 0;
+    while (pos < expression.size() && std::isdigit(static_cast<unsigned char>(expression[pos])))
+    {
+        unsigned digit = static_cast<unsigned>(expression[pos++] - '0');
+        if (number > (std::numeric_limits<unsigned>::max() - digit) / 10)
+            fail(start, "number too big");
+        number = number * 10 + digit;
+    }
+    return number;
+}
+
+void Dice::skipSpaces(size_t& pos) const
+{
+    while (pos < expression.size() && std::isspace(static_cast<unsigned char>(expression[pos])))
+        ++pos;
+}
+
+void Dice::fail(size_t pos, const std::string& message) const
+{
+    std::stringstream msg;
+    msg << "Invalid dice expression \"" << expression << "\" at position " << pos << ": " << message;
+    throw __lz::LazarusException(msg.str());
+}
+
+void Dice::analyze()
+{
+    // Evaluate the program over the bounds of the values instead of the
+    // values. Every value lies within its bounds, so when no bound overflows,
+    // no value does either
+    std::vector<Bounds> stack;
+    bool inRange = true;
+    for (const Instruction& instruction : program)
+    {
+        switch (instruction.type)
+        {
+            case Instruction::Constant:
+                stack.push_back(Bounds{instruction.value, instruction.value,
+                                       static_cast<double>(instruction.value)});
+                break;
+            case Instruction::Roll:
+            case Instruction::ApproximateRoll:
+            {
+                long times = instruction.times, max = 0;
+                inRange = inRange && checkedMultiply(times, static_cast<long>(instruction.sides), max);
+                stack.push_back(Bounds{times, max, times * (instruction.sides + 1) / 2.});
+                break;
+            }
+            case Instruction::Negate:
+            {
+                Bounds& top = stack.back();
+                inRange = inRange && top.min != std::numeric_limits<long>::min();
+                top = Bounds{-top.max, -top.min, -top.mean};
+                break;
+            }
+            default:
+            {
+                Bounds b = stack.back();
+                stack.pop_back();
+                Bounds& a = stack.back();
+                Bounds result{0, 0, 0.};
+                if (instruction.type == Instruction::Add)
+                {
+                    inRange = inRange && checkedAdd(a.min, b.min, result.min) && checkedAdd(a.max, b.max, result.max);
+                    result.mean = a.mean + b.mean;
+                }
+                else if (instruction.type == Instruction::Subtract)
+                {
+                    inRange = inRange && checkedSubtract(a.min, b.max, result.min)
+                                      && checkedSubtract(a.max, b.min, result.max);
+                    result.mean = a.mean - b.mean;
+                }
+                else
+                {
+                    long products[4] = {};
+                    inRange = inRange && checkedMultiply(a.min, b.min, products[0])
+                                      && checkedMultiply(a.min, b.max, products[1])
+                                      && checkedMultiply(a.max, b.min, products[2])
+                                      && checkedMultiply(a.max, b.max, products[3]);
+                    result.min = *std::min_element(products, products + 4);
+                    result.max = *std::max_element(products, products + 4);
+                    // Every roll is independent, so the mean of a product is
+                    // the product of the means
+                    result.mean = a.mean * b.mean;
+                }
+                a = result;
+                break;
+            }
+        }
+        if (!inRange)
+        {
+            std::stringstream msg;
+            msg << "Invalid dice expression \"" << expression << "\": its values can exceed the range of a long";
+            throw __lz::LazarusException(msg.str());
+        }
+        stackSize = std::max(stackSize, stack.size());
+    }
+    minimum = stack.back().min;
+    maximum = stack.back().max;
+    mean = stack.back().mean;
+}
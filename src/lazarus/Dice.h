@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <lazarus/Random.h>
+#include <lazarus/WeightedSampler.h>
+
+namespace lz
+{
+/**
+ * A compiled dice expression, such as "3d6+2".
+ *
+ * Expressions are made of integers, dice and the operators +, - and *, with
+ * parentheses. Dice are written NdS, to roll N dice with S sides each, where
+ * N can be omitted to roll one die, and S can be % for a hundred sides.
+ * For example, "d20", "2d8-1", "(1d4+1)*10" and "d%".
+ *
+ * The expression is parsed once into a small program that is evaluated every
+ * time it is rolled. Rolls of many dice, such as "100d6", are sampled from the
+ * exact distribution of their sum in constant time, instead of rolling every
+ * die. That distribution is computed when the expression is compiled, so it is
+ * only kept for rolls with up to 65536 possible sums that are cheap enough to
+ * compute. Bigger rolls of many dice, such as "1000d100", are sampled from the
+ * normal approximation of their sum, rounded to the nearest integer, also in
+ * constant time, and the others roll every die. These rolls are approximate:
+ * for N dice, the probability of rolling at most any given value differs from
+ * the exact one by less than 0.03 / N, which is below 0.001 for the 32 dice
+ * they have at least.
+ *
+ * Expressions whose values could exceed the range of a long, or that nest
+ * parentheses and negations more than 64 deep, are rejected.
+ *
+ * Expressions that appear in data files can be compiled once and shared
+ * through Dice::get.
+ */
+class Dice
+{
+public:
+    /**
+     * Rolls of at least this many dice are sampled from the distribution of
+     * their sum, when it is small enough to compute.
+     */
+    static const unsigned EXACT_THRESHOLD = 8;
+
+    /**
+     * Rolls of at least this many dice whose distribution is too big to
+     * compute are sampled from a normal approximation of it.
+     */
+    static const unsigned APPROXIMATE_THRESHOLD = 32;
+
+    /**
+     * Compiles the given expression.
+     *
+     * If the expression is not valid, an exception is thrown with the position
+     * of the error.
+     */
+    explicit Dice(const std::string& expression);
+
+    /**
+     * Returns the compiled expression for the given string, compiling it the
+     * first time it is requested.
+     *
+     * The returned reference is valid for the rest of the program.
+     */
+    static const Dice& get(const std::string& expression);
+
+    /**
+     * Rolls the dice and returns the value of the expression.
+     */
+    template <typename Generator>
+    long roll(Generator& generator) const
+    {
+        return evaluate(
+            [&generator](unsigned sides, unsigned times) { return generator.roll(sides, times); },
+            [&generator](const AliasTable& table) { return table.sample(generator); },
+            [&generator](double mean, double stdev) { return generator.normal(mean, stdev); });
+    }
+
+    /**
+     * Rolls the dice using lz::Random.
+     */
+    long roll() const
+    {
+        return evaluate(
+            [](unsigned sides, unsigned times) { return Random::roll(sides, times); },
+            [](const AliasTable& table) { return table.sample(); },
+            [](double mean, double stdev) { return Random::normal(mean, stdev); });
+    }
+
+    /**
+     * Returns the lowest value the expression can take.
+     */
+    long getMin() const { return minimum; }
+
+    /**
+     * Returns the highest value the expression can take.
+     */
+    long getMax() const { return maximum; }
+
+    /**
+     * Returns the expected value of the expression.
+     */
+    double getMean() const { return mean; }
+
+    /**
+     * Returns the source of the expression.
+     */
+    const std::string& getExpression() const { return expression; }
+
+private:
+    struct Instruction
+    {
+        enum Type
+        {
+            Constant,
+            Roll,
+            ApproximateRoll,
+            Add,
+            Subtract,
+            Multiply,
+            Negate
+        };
+
+        Type type;
+        long value;  // Value of a constant, or index of the distribution of a roll
+        unsigned times;
+        unsigned sides;
+    };
+
+    // Parsing, by recursive descent, writing the instructions in postfix order
+    void parseSum(size_t& pos);
+    void parseProduct(size_t& pos);
+    void parseFactor(size_t& pos);
+    unsigned parseNumber(size_t& pos);
+    void skipSpaces(size_t& pos) const;
+    [[noreturn]] void fail(size_t pos, const std::string& message) const;
+
+    // Computes the bounds and mean of the expression
+    void analyze();
+
+    template <typename RollFunc, typename SampleFunc, typename NormalFunc>
+    long evaluate(RollFunc rollDice, SampleFunc sample, NormalFunc normal) const;
+
+private:
+    std::string expression;
+    std::vector<Instruction> program;
+    // Distributions of the sums of the big rolls, offset by their minimum
+    std::vector<AliasTable> distributions;
+    size_t stackSize = 0;
+    // Depth of the parentheses and negations being parsed
+    unsigned nesting = 0;
+    long minimum = 0;
+    long maximum = 0;
+    double mean = 0.;
+};
+
+template <typename RollFunc, typename SampleFunc, typename NormalFunc>
+long Dice::evaluate(RollFunc rollDice, SampleFunc sample, NormalFunc normal) const
+{
+    // Expressions are small, so the stack rarely needs the heap
+    long fixedStack[16] = {};
+    std::vector<long> heapStack;
+    long* stack = fixedStack;
+    if (stackSize > 16)
+    {
+        heapStack.resize(stackSize);
+        stack = heapStack.data();
+    }
+
+    size_t top = 0;
+    for (const Instruction& instruction : program)
+    {
+        switch (instruction.type)
+        {
+            case Instruction::Constant:
+                stack[top++] = instruction.value;
+                break;
+            case Instruction::Roll:
+                if (instruction.value >= 0)
+                    stack[top++] = instruction.times + static_cast<long>(sample(distributions[instruction.value]));
+                else
+                    stack[top++] = static_cast<long>(rollDice(instruction.sides, instruction.times));
+                break;
+            case Instruction::ApproximateRoll:
+            {
+                // The sum of the dice has the mean and variance of a die times the number of dice
+                const double times = instruction.times, sides = instruction.sides;
+                double value = std::round(normal(times * (sides + 1.) / 2., std::sqrt(times * (sides * sides - 1.) / 12.)));
+                stack[top++] = static_cast<long>(std::min(std::max(value, times), times * sides));
+                break;
+            }
+            case Instruction::Add:
+                --top;
+                stack[top - 1] += stack[top];
+                break;
+            case Instruction::Subtract:
+                --top;
+                stack[top - 1] -= stack[top];
+                break;
+            case Instruction::Multiply:
+                --top;
+                stack[top - 1] *= stack[top];
+                break;
+            case Instruction::Negate:
+                stack[top - 1] = -stack[top - 1];
+                break;
+        }
+    }
+    return stack[0];
+}
+}  // namespace lz
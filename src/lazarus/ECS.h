@@ -1,6 +1,17 @@
 #pragma once
 
 #include <lazarus/ECS/ECSEngine.h>
+#include <lazarus/ECS/EngineStats.h>
 #include <lazarus/ECS/Entity.h>
 #include <lazarus/ECS/EventListener.h>
+#include <lazarus/ECS/EventRecorder.h>
+#include <lazarus/ECS/EventReplayer.h>
+#include <lazarus/ECS/Interpolated.h>
+#include <lazarus/ECS/InterpolationSystem.h>
+#include <lazarus/ECS/SystemAccess.h>
+#include <lazarus/ECS/SystemScheduler.h>
+#include <lazarus/ECS/SystemTiming.h>
+#include <lazarus/ECS/TimeSlicedUpdateable.h>
+#include <lazarus/ECS/TurnScheduler.h>
+#include <lazarus/ECS/UpdateRate.h>
 #include <lazarus/ECS/Updateable.h>
@@ -2,6 +2,12 @@
 
 using namespace lz;
 
+ECSEngine::ECSEngine()
+{
+    unsigned hardwareThreads = std::thread::hardware_concurrency();
+    workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
 Entity* ECSEngine::addEntity()
 {
     Entity entity;
@@ -24,32 +30,202 @@ Entity* ECSEngine::getEntity(Identifier entityId)
     return found->second.get();
 }
 
-void ECSEngine::registerUpdateable(Updateable* updateable)
+void ECSEngine::cancelEvent()
+{
+    __lz::eventCancelled() = true;
+}
+
+void ECSEngine::registerUpdateable(Updateable* updateable, UpdateRate rate)
 {
-    updateables.push_back(updateable);
+    scheduler.add(updateable, rate);
 }
 
-void ECSEngine::update()
+void ECSEngine::registerTimeSliced(TimeSlicedUpdateable* updateable)
 {
-    // Update all updateable systems
-    for (auto updateable : updateables)
+    timeSliced.emplace_back(updateable, 0);
+}
+
+void ECSEngine::setFrameBudget(std::chrono::microseconds budget)
+{
+    frameBudget = budget;
+}
+
+void ECSEngine::update(double elapsed)
+{
+    // Fixed rates accumulate the elapsed time, which such values would corrupt for good
+    if (!std::isfinite(elapsed) || elapsed < 0.)
+        throw __lz::LazarusException("Elapsed time must be a finite, non-negative number of seconds");
+
+    auto start = std::chrono::steady_clock::now();
     {
-        updateable->update(*this);
+        __lz::DepthGuard guard(dispatchDepth);
+
+        // Update all updateable systems
+        scheduler.run(*this, tick, elapsed);
+        updateTimeSliced(start);
+
+        // Run garbage collector
+        garbageCollect();
     }
+    lastUpdateTime = std::chrono::steady_clock::now() - start;
+    ++tick;
+    time += elapsed;
 
-    // Run garbage collector
-    garbageCollect();
+    if (recorder != nullptr)
+        recorder->tick(elapsed);
+}
+
+std::vector<SystemTiming> ECSEngine::getSystemTimings() const
+{
+    return scheduler.getTimings();
+}
+
+void ECSEngine::setWorkerCount(unsigned workers)
+{
+    if (dispatchDepth > 0)
+        throw __lz::LazarusException("The worker count cannot be changed during an update or an event");
+
+    std::lock_guard<std::mutex> lock(jobSystemMutex);
+    workerCount = workers;
+    jobSystem.reset();
+}
+
+JobSystem& ECSEngine::getJobSystem()
+{
+    std::lock_guard<std::mutex> lock(jobSystemMutex);
+    if (!jobSystem)
+    {
+        jobSystem.reset(new JobSystem(workerCount));
+        threadRandoms.clear();
+        for (unsigned i = 1; i <= workerCount; ++i)
+            threadRandoms.push_back(random.split(i));
+    }
+    return *jobSystem;
+}
+
+void ECSEngine::seedRandom(unsigned seed)
+{
+    if (dispatchDepth > 0)
+        throw __lz::LazarusException("Random generators cannot be seeded during an update or an event");
+
+    std::lock_guard<std::mutex> lock(jobSystemMutex);
+    random.seed(seed);
+    for (unsigned i = 1; i <= threadRandoms.size(); ++i)
+        threadRandoms[i - 1] = random.split(i);
+}
+
+RandomGenerator& ECSEngine::getThreadRandom()
+{
+    // Only the workers of the job system have generators of their own, and
+    // the job system exists as long as they run
+    const JobSystem* system = JobSystem::current();
+    unsigned worker = system != nullptr && system == jobSystem.get() ? system->currentWorker() : 0;
+    return worker == 0 ? random : threadRandoms[worker - 1];
+}
+
+void ECSEngine::setEventRecorder(EventRecorder* eventRecorder)
+{
+    recorder = eventRecorder;
+}
+
+EngineStats ECSEngine::stats() const
+{
+    // Counters that were reset and not used since are left out
+    EngineStats snapshot;
+    eventCounters.forEach([&snapshot](const __lz::EventCounters& counters)
+    {
+        EventStats stats;
+        stats.name = counters.name;
+        stats.emitted = counters.emitted.load(std::memory_order_relaxed);
+        stats.delivered = counters.delivered.load(std::memory_order_relaxed);
+        stats.listenerTime = std::chrono::nanoseconds(counters.listenerNanoseconds.load(std::memory_order_relaxed));
+        if (stats.emitted > 0)
+            snapshot.events.push_back(stats);
+    });
+    queryCounters.forEach([&snapshot](const __lz::QueryCounters& counters)
+    {
+        QueryStats stats;
+        stats.name = counters.name;
+        stats.calls = counters.calls.load(std::memory_order_relaxed);
+        stats.visited = counters.visited.load(std::memory_order_relaxed);
+        stats.matched = counters.matched.load(std::memory_order_relaxed);
+        if (stats.calls > 0)
+            snapshot.queries.push_back(stats);
+    });
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        snapshot.garbage = garbageStats;
+    }
+
+    std::sort(snapshot.events.begin(), snapshot.events.end(),
+              [](const EventStats& a, const EventStats& b) { return a.name < b.name; });
+    std::sort(snapshot.queries.begin(), snapshot.queries.end(),
+              [](const QueryStats& a, const QueryStats& b) { return a.name < b.name; });
+    return snapshot;
+}
+
+void ECSEngine::resetStats()
+{
+    // The counters are zeroed rather than removed, since emits and queries
+    // running on other threads may hold them
+    eventCounters.forEach([](__lz::EventCounters& counters)
+    {
+        counters.emitted.store(0, std::memory_order_relaxed);
+        counters.delivered.store(0, std::memory_order_relaxed);
+        counters.listenerNanoseconds.store(0, std::memory_order_relaxed);
+    });
+    queryCounters.forEach([](__lz::QueryCounters& counters)
+    {
+        counters.calls.store(0, std::memory_order_relaxed);
+        counters.visited.store(0, std::memory_order_relaxed);
+        counters.matched.store(0, std::memory_order_relaxed);
+    });
+    std::lock_guard<std::mutex> lock(statsMutex);
+    garbageStats = GarbageStats();
+}
+
+void ECSEngine::updateTimeSliced(std::chrono::steady_clock::time_point frameStart)
+{
+    if (timeSliced.empty())
+        return;
+
+    // The budget counts from the start of the update, so the time taken by
+    // the other updateables is not given again
+    auto frameEnd = frameStart + frameBudget;
+    // Rotate which updateable goes first, so none of them is always left
+    // with the smallest share when the others overrun theirs
+    size_t count = timeSliced.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto& entry = timeSliced[(nextTimeSliced + i) % count];
+        // Split the remaining time evenly, so unused time goes to the next ones
+        auto now = TimeSlicedUpdateable::Clock::now();
+        auto share = now < frameEnd ? (frameEnd - now) / static_cast<long>(count - i)
+                                    : TimeSlicedUpdateable::Clock::duration::zero();
+        if (entry.first->update(*this, now + share, entry.second))
+            entry.second = 0;
+    }
+    nextTimeSliced = (nextTimeSliced + 1) % count;
 }
 
 void ECSEngine::garbageCollect()
 {
+    ulong collected = 0;
     auto it = entities.begin();
     while (it != entities.end())
     {
         Entity* entity = it->second.get();
         if (entity->isDeleted())
+        {
             it = entities.erase(it);
+            ++collected;
+        }
         else
             ++it;
     }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    ++garbageStats.passes;
+    garbageStats.collected += collected;
+    garbageStats.lastCollected = collected;
 }
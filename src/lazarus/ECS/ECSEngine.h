@@ -1,11 +1,124 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <tuple>
 
+#include <lazarus/ECS/EngineStats.h>
 #include <lazarus/ECS/Entity.h>
 #include <lazarus/ECS/EventListener.h>
+#include <lazarus/ECS/EventRecorder.h>
+#include <lazarus/ECS/SystemScheduler.h>
+#include <lazarus/ECS/TimeSlicedUpdateable.h>
 #include <lazarus/ECS/Updateable.h>
+#include <lazarus/JobSystem.h>
+#include <lazarus/Random.h>
+
+namespace __lz  // Meant for internal use only
+{
+// Increments a counter for the lifetime of the guard
+class DepthGuard
+{
+public:
+    DepthGuard(std::atomic<int>& depth)
+        : depth(depth)
+    {
+        ++depth;
+    }
+
+    ~DepthGuard() { --depth; }
+
+private:
+    std::atomic<int>& depth;
+};
+
+// Event listener subscribed to an event type, with its priority
+struct Subscription
+{
+    BaseEventListener* listener;
+    int priority;
+};
+
+// Listeners of an event type, sorted by descending priority. Lists are never
+// modified once shared: subscribing and unsubscribing replace them, so an
+// emit keeps iterating over the list it started with without copying it
+using Subscriptions = std::shared_ptr<const std::vector<Subscription>>;
+
+// Returns the names of the given types, separated by commas
+template <typename... Types>
+std::string typeNames()
+{
+    std::string names;
+    for (const char* name : {typeid(Types).name()...})
+    {
+        if (!names.empty())
+            names += ", ";
+        names += name;
+    }
+    return names;
+}
+
+// Whether the event being emitted on this thread has been cancelled
+inline bool& eventCancelled()
+{
+    static thread_local bool cancelled = false;
+    return cancelled;
+}
+
+// Starts a dispatch on this thread, saving the state of the dispatch it is
+// nested in, and restores that state when it ends, even if a listener throws
+class DispatchGuard
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    DispatchGuard()
+        : cancelled(eventCancelled())
+        , nested(nestedListenerTime())
+        , outerCancelled(cancelled)
+        , outerNested(nested)
+        , start(Clock::now())
+    {
+        cancelled = false;
+        nested = std::chrono::nanoseconds(0);
+    }
+
+    ~DispatchGuard()
+    {
+        if (!finished)
+            finish();
+        cancelled = outerCancelled;
+        // The outer dispatch does not count the time of this one as its own
+        nested = outerNested + elapsed;
+    }
+
+    bool isCancelled() const { return cancelled; }
+
+    // Ends the timing of the dispatch, and returns the time spent in it
+    // without the dispatches nested in it
+    std::chrono::nanoseconds finish()
+    {
+        elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+        finished = true;
+        return elapsed - nested;
+    }
+
+private:
+    bool& cancelled;
+    std::chrono::nanoseconds& nested;
+    bool outerCancelled;
+    std::chrono::nanoseconds outerNested;
+    Clock::time_point start;
+    std::chrono::nanoseconds elapsed{0};
+    bool finished = false;
+};
+}
 
 namespace lz
 {
@@ -27,6 +140,12 @@ namespace lz
 class ECSEngine
 {
 public:
+    /**
+     * Creates an engine whose job system has one worker thread less than the
+     * number of hardware threads.
+     */
+    ECSEngine();
+
     /**
      * Adds a new entity to the collection and returns a pointer to it.
      */
@@ -79,10 +198,13 @@ public:
      * event listeners subscribed to this event type, by calling their receive
      * method.
      * 
+     * Listeners with a higher priority receive the event first. Listeners with the
+     * same priority receive it in the order they subscribed.
+     * 
      * @see EventListener
      */
     template <typename EventType>
-    void subscribe(EventListener<EventType>* eventListener);
+    void subscribe(EventListener<EventType>* eventListener, int priority=0);
 
     /**
      * Unsubscribes the event listener from the list of listeners of that event type.
@@ -92,23 +214,215 @@ public:
 
     /**
      * Emit an event to all listeners of that type of event.
+     * 
+     * Returns true if the event was passed to all the listeners, or false if a
+     * listener cancelled it.
      */
     template <typename EventType>
-    void emit(const EventType& event);
+    bool emit(const EventType& event);
+
+    /**
+     * Cancels the event that is currently being emitted.
+     * 
+     * Meant to be called by an event listener from its receive method, for events
+     * that are consumed by the first listener that handles them. The listeners
+     * with lower priority will not receive the event.
+     */
+    void cancelEvent();
 
     /**
      * Adds an updateable object to the engine.
      * 
-     * The update method on this object will be called when the engine is updated.
+     * The update method on this object will be called when the engine is updated,
+     * as often as the given rate specifies. By default, it is called on every update.
+     * 
+     * @see UpdateRate
+     */
+    void registerUpdateable(Updateable* updateable,
+                            UpdateRate rate=UpdateRate::everyTick());
+
+    /**
+     * Adds a time sliced updateable to the engine.
+     * 
+     * Time sliced updateables are updated on every tick, after the other
+     * updateables, and share what those left of the frame budget of the
+     * engine between them.
+     * 
+     * @see TimeSlicedUpdateable
+     */
+    void registerTimeSliced(TimeSlicedUpdateable* updateable);
+
+    /**
+     * Sets the time that an update of the engine can take on each tick.
+     * 
+     * The time taken by the other updateables is counted, and time sliced
+     * updateables only get what remains of the budget once they are done.
+     * 
+     * Defaults to 2 milliseconds.
+     */
+    void setFrameBudget(std::chrono::microseconds budget);
+
+    /**
+     * Returns the time that an update of the engine can take on each tick.
      */
-    void registerUpdateable(Updateable* updateable);
+    std::chrono::microseconds getFrameBudget() const { return frameBudget; }
 
     /**
-     * Updates all the updateable objects in the engine.
+     * Updates all the updateable objects in the engine which are due on this tick.
+     * 
+     * Each call to update is a tick of the engine. The elapsed time is only used
+     * by updateables registered with a fixed frequency, which are updated once
+     * per period of time elapsed.
+     * 
+     * Updateables whose accesses do not conflict may be updated at the same
+     * time on different threads. Updateables which do not declare their access
+     * are updated on their own, in the order they were registered.
      * 
      * Will also garbage collect deleted entities.
+     * 
+     * @param elapsed Seconds passed since the previous update. Throws a
+     * LazarusException if it is negative, infinite or NaN.
+     * 
+     * @see Updateable::getAccess
+     */
+    virtual void update(double elapsed=0.);
+
+    /**
+     * Returns the number of ticks the engine has been updated for.
+     */
+    ulong getTick() const { return tick; }
+
+    /**
+     * Returns the total number of seconds passed to update.
+     */
+    double getTime() const { return time; }
+
+    /**
+     * Sets the number of worker threads of the job system of the engine.
+     * 
+     * Defaults to one less than the number of hardware threads. With no workers,
+     * all updateables are updated serially, and jobs run on the thread that
+     * waits for them.
+     * 
+     * The current job system is destroyed after running its queued jobs.
+     * Throws a LazarusException if called during an update or an event, whose
+     * jobs may still be running on it.
+     */
+    void setWorkerCount(unsigned workers);
+
+    /**
+     * Returns the job system of the engine, creating it on first use.
+     * 
+     * The engine runs updateables on it, and updateables can use it to split
+     * their own work into jobs, for example with JobSystem::parallelFor.
+     * 
+     * @see JobSystem
+     */
+    JobSystem& getJobSystem();
+
+    /**
+     * Returns the scheduler that runs the updateables of the engine.
+     */
+    SystemScheduler& getScheduler() { return scheduler; }
+
+    /**
+     * Seeds the random generators of the engine from the given master seed.
+     *
+     * The main generator is seeded with the master seed itself, and the generator
+     * of each worker thread with a seed split from it, so that engines with the
+     * same seed produce the same streams, independently of lz::Random and of any
+     * other engine in the process.
+     *
+     * It replaces the generators that worker threads may be using, so it must
+     * not be called while the engine is updating or dispatching an event, and
+     * throws a LazarusException if it is.
+     *
+     * @see RandomGenerator::split
+     */
+    void seedRandom(unsigned seed);
+
+    /**
+     * Returns the main random generator of the engine.
+     *
+     * It must only be used from the thread that updates the engine.
+     */
+    RandomGenerator& getRandom() { return random; }
+
+    /**
+     * Returns the random generator of the calling thread.
+     *
+     * Worker threads of the job system of the engine get a generator of their
+     * own, and any other thread gets the main generator. This avoids data races
+     * between updateables and jobs running in parallel, but which numbers each
+     * job gets depends on which worker runs it. Jobs that must be reproducible
+     * should use a generator split from the main one for each job instead.
+     *
+     * It never creates the job system, and takes no lock.
+     */
+    RandomGenerator& getThreadRandom();
+
+    /**
+     * Returns a generator for the given entity on the current tick.
+     *
+     * Its values only depend on the seed of the engine, the entity, the tick
+     * and the stream, so updateables that run in parallel, or split their work
+     * into jobs, get the same values regardless of the number of threads and
+     * of the order in which entities are visited.
+     *
+     * @see counterRandom
+     */
+    CounterRandomGenerator getEntityRandom(Identifier entity, uint32_t stream=0) const
+    {
+        return counterRandom(random.getSeed(), entity, tick, stream);
+    }
+
+    /**
+     * Returns a summary of the duration of the recent updates of each updateable,
+     * in the order they were registered.
+     * 
+     * The median, 95th percentile and maximum are computed over a rolling window
+     * of the most recent updates.
+     * 
+     * @see SystemTiming
+     */
+    std::vector<SystemTiming> getSystemTimings() const;
+
+    /**
+     * Returns how long the last call to update took, including the garbage collector.
+     */
+    std::chrono::nanoseconds getLastUpdateTime() const { return lastUpdateTime; }
+
+    /**
+     * Sets the recorder that events emitted by the engine are written to.
+     *
+     * Only events emitted from outside the engine are recorded, that is, events
+     * which are not emitted during an update or by another event listener, since
+     * those will be emitted again when the log is replayed.
+     * The end of each update is also recorded as a tick boundary, with the
+     * elapsed time passed to it.
+     *
+     * Passing a nullptr stops recording.
+     *
+     * @see EventRecorder
+     */
+    void setEventRecorder(EventRecorder* eventRecorder);
+
+    /**
+     * Returns a snapshot of the counters kept by the engine.
+     * 
+     * The engine counts the events emitted and delivered to listeners and the
+     * time spent in listeners for each event type, the entities visited and
+     * matched by each query over a set of component types, and the entities
+     * removed by the garbage collector.
+     * 
+     * @see EngineStats
+     */
+    EngineStats stats() const;
+
+    /**
+     * Resets all the counters kept by the engine.
      */
-    virtual void update();
+    void resetStats();
 
 private:
     /**
@@ -116,12 +430,54 @@ private:
      */
     void garbageCollect();
 
+    /**
+     * Updates the time sliced updateables within what remains of the frame
+     * budget of the update that started at the given time.
+     */
+    void updateTimeSliced(std::chrono::steady_clock::time_point frameStart);
+
+    /**
+     * Returns the counters for the given event type, creating them if needed.
+     */
+    template <typename EventType>
+    __lz::EventCounters* eventCountersFor();
+
+    /**
+     * Returns the counters for a query over the given component types,
+     * creating them if needed.
+     */
+    template <typename... Types>
+    __lz::QueryCounters* queryCountersFor();
+
 private:
     std::unordered_map<Identifier, std::shared_ptr<Entity>> entities;
-    std::vector<Updateable*> updateables;
+    SystemScheduler scheduler;
+    std::unique_ptr<JobSystem> jobSystem;
+    std::mutex jobSystemMutex;
+    unsigned workerCount;
+    RandomGenerator random;
+    // Generators of the worker threads, created along with the job system
+    std::vector<RandomGenerator> threadRandoms;
+    // Time sliced updateables, with the cursors where their jobs stopped
+    std::vector<std::pair<TimeSlicedUpdateable*, size_t>> timeSliced;
+    // Index of the time sliced updateable that goes first on the next tick
+    size_t nextTimeSliced = 0;
+    std::chrono::microseconds frameBudget{2000};
+    ulong tick = 0;
+    double time = 0.;
+    std::chrono::nanoseconds lastUpdateTime{0};
     // Maps event type index -> list of event listeners for that event type
-    std::unordered_map<std::type_index,
-                       std::vector<__lz::BaseEventListener*>> subscribers;
+    std::unordered_map<std::type_index, __lz::Subscriptions> subscribers;
+    EventRecorder* recorder = nullptr;
+    // Depth of nested updates and event dispatches currently running
+    std::atomic<int> dispatchDepth{0};
+    // Counters, by event type and by tuple of component types respectively.
+    // They are atomic since updateables may run on different threads
+    __lz::CounterTable<__lz::EventCounters> eventCounters;
+    __lz::CounterTable<__lz::QueryCounters> queryCounters;
+    // Guards the garbage collector counters
+    mutable std::mutex statsMutex;
+    GarbageStats garbageStats;
 };
 
 template <typename... Types>
@@ -141,6 +497,7 @@ void ECSEngine::applyToEach(
     typename std::common_type<std::function<void(Entity*, Types*...)>>::type&& func,
     bool includeDeleted)
 {
+    ulong matched = 0;
     for (auto it = entities.begin(); it != entities.end(); ++it)
     {
         Entity* entity = it->second.get();
@@ -149,42 +506,52 @@ void ECSEngine::applyToEach(
             continue;
 
         if (entity->has<Types...>())
+        {
+            ++matched;
             func(entity, entity->get<Types>()...);
+        }
+    }
+
+    __lz::QueryCounters* counters = queryCountersFor<Types...>();
+    if (counters)
+    {
+        counters->calls.fetch_add(1, std::memory_order_relaxed);
+        counters->visited.fetch_add(entities.size(), std::memory_order_relaxed);
+        counters->matched.fetch_add(matched, std::memory_order_relaxed);
     }
 }
 
 template <typename EventType>
-void ECSEngine::subscribe(EventListener<EventType>* eventListener)
+void ECSEngine::subscribe(EventListener<EventType>* eventListener, int priority)
 {
-    std::type_index typeId = __lz::getTypeIndex<EventType>();
-    auto found = subscribers.find(typeId);
-    if (found == subscribers.end())
+    // Keep the list sorted by descending priority, after listeners of equal priority
+    __lz::Subscriptions& current = subscribers[__lz::getTypeIndex<EventType>()];
+    auto eventListeners = current ? std::make_shared<std::vector<__lz::Subscription>>(*current)
+                                  : std::make_shared<std::vector<__lz::Subscription>>();
+    auto position = std::upper_bound(eventListeners->begin(), eventListeners->end(), priority,
+        [](int prio, const __lz::Subscription& subscription)
     {
-        // No subscribers to this type of event yet, create vector
-        std::vector<__lz::BaseEventListener*> vec;
-        vec.push_back(eventListener);
-        subscribers[typeId] = vec;
-    }
-    else
-    {
-        // There already exists a list of subscribers to this event type
-        found->second.push_back(eventListener);
-    }
+        return prio > subscription.priority;
+    });
+    eventListeners->insert(position, __lz::Subscription{eventListener, priority});
+    current = std::move(eventListeners);
 }
 
 template <typename EventType>
 void ECSEngine::unsubscribe(EventListener<EventType>* eventListener)
 {
     auto found = subscribers.find(__lz::getTypeIndex<EventType>());
-    if (found != subscribers.end())
+    if (found != subscribers.end() && found->second)
     {
-        auto eventListeners = found->second;
-        for (auto it = eventListeners.begin(); it != eventListeners.end(); ++it)
+        const auto& current = *found->second;
+        for (auto it = current.begin(); it != current.end(); ++it)
         {
-            if (*it == eventListener)
+            if (it->listener == eventListener)
             {
-                // System found, remove it from the subscriber list
-                eventListeners.erase(it);
+                // System found, remove it from a copy of the subscriber list
+                auto eventListeners = std::make_shared<std::vector<__lz::Subscription>>(current);
+                eventListeners->erase(eventListeners->begin() + (it - current.begin()));
+                found->second = std::move(eventListeners);
                 return;
             }
         }
@@ -197,18 +564,54 @@ void ECSEngine::unsubscribe(EventListener<EventType>* eventListener)
 }
 
 template <typename EventType>
-void ECSEngine::emit(const EventType& event)
+bool ECSEngine::emit(const EventType& event)
 {
+    if (recorder != nullptr && dispatchDepth == 0)
+        recorder->record(event);
+
+    __lz::DepthGuard guard(dispatchDepth);
+    __lz::EventCounters* counters = eventCountersFor<EventType>();
+    if (counters)
+        counters->emitted.fetch_add(1, std::memory_order_relaxed);
     // TODO: Log case in which an event is emitted but no listeners for that type exist
     auto found = subscribers.find(__lz::getTypeIndex<EventType>());
-    if (found != subscribers.end())
+    if (found == subscribers.end() || !found->second)
+        return true;
+
+    // Listeners may emit other events, which must not see the cancellation of
+    // this one. Only the time of this dispatch is counted, not the one of the
+    // events emitted by its listeners, which are counted for their own types
+    __lz::DispatchGuard dispatch;
+    ulong delivered = 0;
+    // Holding the list keeps it alive if listeners subscribe or unsubscribe
+    __lz::Subscriptions eventListeners = found->second;
+    for (auto it = eventListeners->begin(); it != eventListeners->end() && !dispatch.isCancelled(); ++it)
     {
-        auto eventListeners = found->second;
-        for (auto it = eventListeners.begin(); it != eventListeners.end(); ++it)
-        {
-            auto* listener = dynamic_cast<EventListener<EventType>*>(*it);
-            listener->receive(*this, event);
-        }
+        // The listener was subscribed for this event type, so the cast is safe
+        auto* listener = static_cast<EventListener<EventType>*>(it->listener);
+        listener->receive(*this, event);
+        ++delivered;
     }
+    std::chrono::nanoseconds listenerTime = dispatch.finish();
+    if (counters)
+    {
+        counters->delivered.fetch_add(delivered, std::memory_order_relaxed);
+        counters->listenerNanoseconds.fetch_add(listenerTime.count(), std::memory_order_relaxed);
+    }
+    return !dispatch.isCancelled();
+}
+
+template <typename EventType>
+__lz::EventCounters* ECSEngine::eventCountersFor()
+{
+    return eventCounters.get(__lz::counterSlot<EventType>(),
+                             [] { return std::string(typeid(EventType).name()); });
+}
+
+template <typename... Types>
+__lz::QueryCounters* ECSEngine::queryCountersFor()
+{
+    return queryCounters.get(__lz::counterSlot<std::tuple<Types...>>(),
+                             [] { return __lz::typeNames<Types...>(); });
 }
 }  // namespace lz
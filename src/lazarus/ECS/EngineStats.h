@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <lazarus/common.h>
+
+namespace lz
+{
+/**
+ * Counters for the events of one type emitted by an ECS engine.
+ */
+struct EventStats
+{
+    // Name of the event type, as given by typeid
+    std::string name;
+    // Number of times an event of this type was emitted
+    ulong emitted = 0;
+    // Number of times an event of this type was passed to a listener
+    ulong delivered = 0;
+    // Total time spent in the listeners of this event type, not counting the
+    // time spent in the listeners of the events they emit
+    std::chrono::nanoseconds listenerTime{0};
+};
+
+/**
+ * Counters for the queries over one set of component types run by an ECS engine.
+ */
+struct QueryStats
+{
+    // Names of the component types of the query, as given by typeid
+    std::string name;
+    // Number of times the query was run
+    ulong calls = 0;
+    // Number of entities checked by the query
+    ulong visited = 0;
+    // Number of entities that had all the components of the query
+    ulong matched = 0;
+};
+
+/**
+ * Counters for the garbage collector of an ECS engine.
+ */
+struct GarbageStats
+{
+    // Number of times the garbage collector was run
+    ulong passes = 0;
+    // Total number of entities removed by the garbage collector
+    ulong collected = 0;
+    // Number of entities removed on the last pass
+    ulong lastCollected = 0;
+};
+
+/**
+ * Snapshot of the counters kept by an ECS engine.
+ *
+ * Event and query counters are sorted by name.
+ *
+ * @see ECSEngine::stats
+ */
+struct EngineStats
+{
+    std::vector<EventStats> events;
+    std::vector<QueryStats> queries;
+    GarbageStats garbage;
+};
+}  // namespace lz
+
+namespace __lz  // Meant for internal use only
+{
+// Counters of an event type, updated without locks
+struct EventCounters
+{
+    std::string name;
+    std::atomic<ulong> emitted{0};
+    std::atomic<ulong> delivered{0};
+    std::atomic<long long> listenerNanoseconds{0};
+};
+
+// Counters of a query over a set of component types, updated without locks
+struct QueryCounters
+{
+    std::string name;
+    std::atomic<ulong> calls{0};
+    std::atomic<ulong> visited{0};
+    std::atomic<ulong> matched{0};
+};
+
+// Returns a new slot for the counters of a type, the same in every engine
+inline size_t newCounterSlot()
+{
+    static std::atomic<size_t> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Returns the slot of the counters of the given type
+template <typename T>
+size_t counterSlot()
+{
+    static const size_t slot = newCounterSlot();
+    return slot;
+}
+
+/**
+ * Counters of each type, indexed by their slot.
+ *
+ * Finding the counters of a type only takes two atomic loads. They are
+ * created under a lock the first time, and stay in place until the table is
+ * destroyed. Types past the first SLOTS ones are not counted.
+ */
+template <typename Counters>
+class CounterTable
+{
+public:
+    static const size_t CHUNK_SIZE = 64;
+    static const size_t SLOTS = 256 * CHUNK_SIZE;
+
+    /**
+     * Returns the counters in the slot, creating them with the name returned
+     * by makeName if needed, or nullptr if the slot is out of the table.
+     */
+    template <typename MakeName>
+    Counters* get(size_t slot, MakeName makeName)
+    {
+        if (slot >= SLOTS)
+            return nullptr;
+        Chunk* chunk = chunks[slot / CHUNK_SIZE].load(std::memory_order_acquire);
+        Counters* counters = chunk ? (*chunk)[slot % CHUNK_SIZE].load(std::memory_order_acquire) : nullptr;
+        return counters ? counters : create(slot, makeName());
+    }
+
+    /**
+     * Calls the function with each of the counters created so far.
+     */
+    template <typename Function>
+    void forEach(Function function)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& counters : created)
+            function(*counters);
+    }
+
+    template <typename Function>
+    void forEach(Function function) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& counters : created)
+            function(static_cast<const Counters&>(*counters));
+    }
+
+private:
+    using Chunk = std::array<std::atomic<Counters*>, CHUNK_SIZE>;
+
+    Counters* create(size_t slot, std::string name)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::atomic<Chunk*>& chunk = chunks[slot / CHUNK_SIZE];
+        if (!chunk.load(std::memory_order_relaxed))
+        {
+            createdChunks.emplace_back(new Chunk());
+            chunk.store(createdChunks.back().get(), std::memory_order_release);
+        }
+        std::atomic<Counters*>& entry = (*chunk.load(std::memory_order_relaxed))[slot % CHUNK_SIZE];
+        if (!entry.load(std::memory_order_relaxed))
+        {
+            created.emplace_back(new Counters());
+            created.back()->name = std::move(name);
+            entry.store(created.back().get(), std::memory_order_release);
+        }
+        return entry.load(std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<Chunk*>, SLOTS / CHUNK_SIZE> chunks{};
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Chunk>> createdChunks;
+    std::vector<std::unique_ptr<Counters>> created;
+};
+
+template <typename Counters>
+const size_t CounterTable<Counters>::CHUNK_SIZE;
+
+template <typename Counters>
+const size_t CounterTable<Counters>::SLOTS;
+
+// Time spent on this thread in the listeners of the events emitted by the
+// listeners that are running, so that they are not counted twice
+inline std::chrono::nanoseconds& nestedListenerTime()
+{
+    static thread_local std::chrono::nanoseconds time{0};
+    return time;
+}
+}
@@ -25,6 +25,9 @@ class ECSEngine;
  * Usually, systems will also be event listeners, so they can implement this
  * interface.
  * 
+ * A listener can stop an event from reaching the listeners with lower priority
+ * by calling ECSEngine::cancelEvent from its receive method.
+ * 
  * @see ECSEngine
  * @see BaseSystem
  */
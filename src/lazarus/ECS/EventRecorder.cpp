@@ -0,0 +1,65 @@
+#include <lazarus/ECS/EventRecorder.h>
+
+#include <algorithm>
+
+using namespace lz;
+
+EventRecorder::EventRecorder(std::ostream& out)
+    : out(out)
+{
+}
+
+void EventRecorder::begin(unsigned seed)
+{
+    if (recording)
+        throw __lz::LazarusException("Event recorder has already begun");
+
+    // Write the registry sorted by ID, so the replayer can index types by position
+    std::vector<const __lz::EventLogType*> registry;
+    for (const auto& entry : types)
+        registry.push_back(&entry.second);
+    std::sort(registry.begin(), registry.end(),
+              [](const __lz::EventLogType* a, const __lz::EventLogType* b)
+    {
+        return a->id < b->id;
+    });
+
+    uint32_t seed32 = seed;
+    uint16_t count = static_cast<uint16_t>(registry.size());
+    write(__lz::EVENT_LOG_MAGIC, sizeof(__lz::EVENT_LOG_MAGIC));
+    write(&__lz::EVENT_LOG_VERSION, sizeof(__lz::EVENT_LOG_VERSION));
+    write(&seed32, sizeof(seed32));
+    write(&count, sizeof(count));
+    for (auto type : registry)
+    {
+        uint16_t nameLength = static_cast<uint16_t>(type->name.size());
+        write(&type->size, sizeof(type->size));
+        write(&nameLength, sizeof(nameLength));
+        write(type->name.data(), nameLength);
+    }
+    recording = true;
+}
+
+void EventRecorder::tick(double elapsed)
+{
+    if (!recording)
+        return;
+    uint8_t tag = static_cast<uint8_t>(__lz::EventLogTag::Tick);
+    write(&tag, sizeof(tag));
+    write(&elapsed, sizeof(elapsed));
+}
+
+void EventRecorder::end()
+{
+    if (!recording)
+        return;
+    uint8_t tag = static_cast<uint8_t>(__lz::EventLogTag::End);
+    write(&tag, sizeof(tag));
+    out.flush();
+    recording = false;
+}
+
+void EventRecorder::write(const void* data, size_t size)
+{
+    out.write(static_cast<const char*>(data), size);
+}
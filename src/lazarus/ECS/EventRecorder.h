@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include <lazarus/common.h>
+
+namespace __lz  // Meant for internal use only
+{
+// Magic bytes and version at the start of every event log
+const char EVENT_LOG_MAGIC[4] = {'L', 'Z', 'E', 'V'};
+const uint8_t EVENT_LOG_VERSION = 2;
+
+// Tags that precede each record in the body of an event log
+enum class EventLogTag : uint8_t
+{
+    Event = 0,
+    Tick = 1,
+    End = 2
+};
+
+// Entry of the type registry of an event log
+struct EventLogType
+{
+    uint16_t id;
+    uint32_t size;
+    std::string name;
+};
+}
+
+namespace lz
+{
+/**
+ * Records the events emitted by an ECS engine into a compact binary log.
+ *
+ * The log starts with a header that holds the RNG seed and a registry of the
+ * recorded event types, and is followed by one record per event and one marker
+ * with the elapsed time at the end of each engine tick. The log can then be
+ * replayed against a fresh engine with an EventReplayer, which gives a
+ * reproducible workload.
+ *
+ * Only event types registered before calling begin are recorded. Since events
+ * are stored as raw bytes, they must be trivially copyable, and a log can only
+ * be replayed by a build with the same layout for those types.
+ *
+ * @see ECSEngine
+ * @see EventReplayer
+ */
+class EventRecorder
+{
+public:
+    /**
+     * Creates a recorder that writes the log to the given stream.
+     *
+     * The stream should be opened in binary mode, and must outlive the recorder.
+     */
+    EventRecorder(std::ostream& out);
+
+    /**
+     * Registers an event type to be recorded under the given name.
+     *
+     * The name identifies the type in the log, so the replayer must register
+     * the type under the same name.
+     * Throws an exception if recording has already begun, or if the type or
+     * the name is already registered.
+     */
+    template <typename EventType>
+    void registerEvent(const std::string& name);
+
+    /**
+     * Writes the header of the log and starts recording.
+     *
+     * @param seed The seed of the RNG used by the recorded session.
+     */
+    void begin(unsigned seed);
+
+    /**
+     * Writes an event to the log.
+     *
+     * Events whose type has not been registered, or that are recorded before
+     * begin or after end, are ignored.
+     */
+    template <typename EventType>
+    void record(const EventType& event);
+
+    /**
+     * Writes a marker for the end of an engine tick.
+     *
+     * @param elapsed Seconds passed to the engine on that tick.
+     */
+    void tick(double elapsed=0.);
+
+    /**
+     * Marks the end of the log and stops recording.
+     */
+    void end();
+
+    /**
+     * Returns whether the recorder has begun and not ended yet.
+     */
+    bool isRecording() const { return recording; }
+
+private:
+    void write(const void* data, size_t size);
+
+private:
+    std::ostream& out;
+    std::unordered_map<std::type_index, __lz::EventLogType> types;
+    bool recording = false;
+};
+
+template <typename EventType>
+void EventRecorder::registerEvent(const std::string& name)
+{
+    static_assert(std::is_trivially_copyable<EventType>::value,
+                  "Recorded events must be trivially copyable");
+    if (recording)
+        throw __lz::LazarusException("Cannot register event types after recording has begun");
+
+    // IDs are positions in the registry of the log, so they must stay contiguous
+    std::type_index type(typeid(EventType));
+    if (types.count(type) > 0)
+        throw __lz::LazarusException("Event type " + name + " is already registered");
+    for (const auto& entry : types)
+        if (entry.second.name == name)
+            throw __lz::LazarusException("Event type name " + name + " is already used");
+    if (types.size() > UINT16_MAX)
+        throw __lz::LazarusException("Too many event types registered");
+
+    auto id = static_cast<uint16_t>(types.size());
+    types.emplace(type, __lz::EventLogType{id, static_cast<uint32_t>(sizeof(EventType)), name});
+}
+
+template <typename EventType>
+void EventRecorder::record(const EventType& event)
+{
+    if (!recording)
+        return;
+    auto found = types.find(std::type_index(typeid(EventType)));
+    if (found == types.end())
+        return;
+
+    uint8_t tag = static_cast<uint8_t>(__lz::EventLogTag::Event);
+    uint16_t id = found->second.id;
+    write(&tag, sizeof(tag));
+    write(&id, sizeof(id));
+    write(&event, sizeof(EventType));
+}
+}  // namespace lz
@@ -0,0 +1,111 @@
+#include <lazarus/ECS/EventReplayer.h>
+
+#include <algorithm>
+
+#include <lazarus/Random.h>
+
+using namespace lz;
+
+EventReplayer::EventReplayer(std::istream& in)
+    : in(in)
+{
+}
+
+unsigned EventReplayer::begin()
+{
+    char magic[sizeof(__lz::EVENT_LOG_MAGIC)];
+    uint8_t version;
+    uint32_t seed;
+    uint16_t count;
+    read(magic, sizeof(magic));
+    if (!std::equal(magic, magic + sizeof(magic), __lz::EVENT_LOG_MAGIC))
+        throw __lz::LazarusException("Stream does not hold an event log");
+    read(&version, sizeof(version));
+    if (version != __lz::EVENT_LOG_VERSION)
+        throw __lz::LazarusException("Unsupported event log version");
+    read(&seed, sizeof(seed));
+    read(&count, sizeof(count));
+
+    logTypes.clear();
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        uint32_t size;
+        uint16_t nameLength;
+        read(&size, sizeof(size));
+        read(&nameLength, sizeof(nameLength));
+        std::string name(nameLength, '\0');
+        read(&name[0], nameLength);
+
+        auto found = registered.find(name);
+        if (found == registered.end())
+            throw __lz::LazarusException("Event type " + name + " is not registered in the replayer");
+        if (found->second.size != size)
+            throw __lz::LazarusException("Size of event type " + name + " does not match the log");
+        logTypes.push_back(&found->second);
+        buffer.resize(std::max<size_t>(buffer.size(), size));
+    }
+
+    finished = false;
+    Random::seed(seed);
+    return seed;
+}
+
+unsigned EventReplayer::begin(ECSEngine& engine)
+{
+    unsigned seed = begin();
+    engine.seedRandom(seed);
+    return seed;
+}
+
+bool EventReplayer::step(ECSEngine& engine)
+{
+    while (!finished)
+    {
+        uint8_t tag;
+        // A log cut short, e.g. by a crash, ends where the stream ends
+        if (!in.read(reinterpret_cast<char*>(&tag), sizeof(tag)))
+            break;
+
+        switch (static_cast<__lz::EventLogTag>(tag))
+        {
+        case __lz::EventLogTag::Event:
+        {
+            uint16_t id;
+            read(&id, sizeof(id));
+            if (id >= logTypes.size())
+                throw __lz::LazarusException("Event log holds an unknown event type");
+            read(buffer.data(), logTypes[id]->size);
+            logTypes[id]->decode(engine, buffer.data());
+            break;
+        }
+        case __lz::EventLogTag::Tick:
+        {
+            double elapsed;
+            read(&elapsed, sizeof(elapsed));
+            engine.update(elapsed);
+            return true;
+        }
+        case __lz::EventLogTag::End:
+            finished = true;
+            break;
+        default:
+            throw __lz::LazarusException("Event log is corrupted");
+        }
+    }
+    finished = true;
+    return false;
+}
+
+ulong EventReplayer::replay(ECSEngine& engine)
+{
+    ulong ticks = 0;
+    while (step(engine))
+        ++ticks;
+    return ticks;
+}
+
+void EventReplayer::read(void* data, size_t size)
+{
+    if (!in.read(static_cast<char*>(data), size))
+        throw __lz::LazarusException("Unexpected end of event log");
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <functional>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <lazarus/ECS/ECSEngine.h>
+#include <lazarus/ECS/EventRecorder.h>
+
+namespace lz
+{
+/**
+ * Replays an event log written by an EventRecorder against an ECS engine.
+ *
+ * The replayer emits the recorded events through the engine in the same order
+ * they were recorded, and updates the engine at each recorded tick boundary.
+ * No window or input is needed, so it can be used to profile the engine
+ * headless with a reproducible workload.
+ *
+ * The event types found in the log must be registered in the replayer under
+ * the same names they were recorded with.
+ *
+ * @see EventRecorder
+ */
+class EventReplayer
+{
+public:
+    /**
+     * Creates a replayer that reads the log from the given stream.
+     *
+     * The stream should be opened in binary mode, and must outlive the replayer.
+     */
+    EventReplayer(std::istream& in);
+
+    /**
+     * Registers an event type to be replayed, with the name it was recorded under.
+     */
+    template <typename EventType>
+    void registerEvent(const std::string& name);
+
+    /**
+     * Reads the header of the log and seeds lz::Random with the recorded seed.
+     *
+     * Throws an exception if the log is malformed, or if it holds an event type
+     * that is not registered or whose size does not match the registered type.
+     *
+     * @return The recorded seed.
+     */
+    unsigned begin();
+
+    /**
+     * Same as begin(), but also seeds the random generators of the engine the
+     * log is replayed against, so that systems drawing from them replay the
+     * same numbers.
+     *
+     * @see ECSEngine::seedRandom
+     */
+    unsigned begin(ECSEngine& engine);
+
+    /**
+     * Replays the events of the next tick and updates the engine.
+     *
+     * Returns false when the end of the log is reached. Events recorded after
+     * the last tick are still emitted, but the engine is not updated for them.
+     */
+    bool step(ECSEngine& engine);
+
+    /**
+     * Replays all the remaining ticks of the log.
+     *
+     * @return The number of ticks replayed.
+     */
+    ulong replay(ECSEngine& engine);
+
+private:
+    void read(void* data, size_t size);
+
+private:
+    using Decoder = std::function<void(ECSEngine&, const char*)>;
+
+    struct RegisteredType
+    {
+        uint32_t size;
+        Decoder decode;
+    };
+
+    std::istream& in;
+    std::unordered_map<std::string, RegisteredType> registered;
+    // Types found in the log, indexed by their ID in the log
+    std::vector<const RegisteredType*> logTypes;
+    std::vector<char> buffer;
+    bool finished = false;
+};
+
+template <typename EventType>
+void EventReplayer::registerEvent(const std::string& name)
+{
+    static_assert(std::is_trivially_copyable<EventType>::value,
+                  "Replayed events must be trivially copyable");
+    registered[name] = RegisteredType{
+        static_cast<uint32_t>(sizeof(EventType)),
+        [](ECSEngine& engine, const char* data)
+        {
+            // Events are not required to be default constructible
+            typename std::aligned_storage<sizeof(EventType), alignof(EventType)>::type storage;
+            std::memcpy(&storage, data, sizeof(EventType));
+            engine.emit(*reinterpret_cast<const EventType*>(&storage));
+        }
+    };
+}
+}  // namespace lz
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cmath>
+
+namespace lz
+{
+/**
+ * Position, rotation and scale of an entity that is drawn.
+ */
+struct Transform
+{
+    float x = 0.f;
+    float y = 0.f;
+    // Angle in degrees
+    float rotation = 0.f;
+    float scale = 1.f;
+};
+
+/**
+ * Returns the transform at the given fraction of the way from one transform
+ * to the other, turning the shortest way around.
+ */
+inline Transform interpolate(const Transform& from, const Transform& to, float alpha)
+{
+    float turn = std::fmod(to.rotation - from.rotation, 360.f);
+    if (turn > 180.f)
+        turn -= 360.f;
+    else if (turn < -180.f)
+        turn += 360.f;
+
+    Transform result;
+    result.x = from.x + (to.x - from.x) * alpha;
+    result.y = from.y + (to.y - from.y) * alpha;
+    result.rotation = from.rotation + turn * alpha;
+    result.scale = from.scale + (to.scale - from.scale) * alpha;
+    return result;
+}
+
+/**
+ * Component of the entities whose motion is drawn smoothly between the fixed
+ * steps of the simulation.
+ *
+ * The simulation only sets the current transform, and the
+ * InterpolationSystem keeps the transform of the previous step. Frames drawn
+ * between two steps show the entity in between, at the fraction of the step
+ * that passed since the last one, so motion looks smooth on displays that
+ * refresh faster than the simulation runs, without running it faster.
+ *
+ * This draws the entities up to one step behind the simulation.
+ *
+ * @see InterpolationSystem
+ */
+struct Interpolated
+{
+    Interpolated() = default;
+    explicit Interpolated(const Transform& transform) : previous(transform), current(transform) {}
+
+    Transform previous;
+    Transform current;
+
+    /**
+     * Moves the entity without drawing its motion, for example when it
+     * spawns or teleports.
+     */
+    void teleport(const Transform& transform)
+    {
+        previous = transform;
+        current = transform;
+    }
+
+    /**
+     * Returns the transform to draw, at the given fraction of the step from
+     * the previous transform to the current one.
+     */
+    Transform at(float alpha) const { return interpolate(previous, current, alpha); }
+};
+}  // namespace lz
@@ -0,0 +1,13 @@
+#include <lazarus/ECS/InterpolationSystem.h>
+
+#include <lazarus/ECS/ECSEngine.h>
+
+using namespace lz;
+
+void InterpolationSystem::update(ECSEngine& engine)
+{
+    engine.applyToEach<Interpolated>([](Entity*, Interpolated* transform)
+    {
+        transform->previous = transform->current;
+    });
+}
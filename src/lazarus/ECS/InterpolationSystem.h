@@ -0,0 +1,28 @@
+#pragma once
+
+#include <lazarus/ECS/Interpolated.h>
+#include <lazarus/ECS/Updateable.h>
+
+namespace lz
+{
+/**
+ * Keeps the transform of the previous step of the Interpolated components.
+ *
+ * On each update, it copies the current transform of every Interpolated
+ * component into the previous one, so it must be registered with the same
+ * rate as, and before, the updateables that move the entities. Since its
+ * access writes Interpolated components, the engine always runs it before
+ * the updateables registered after it that also write them.
+ *
+ * @see Interpolated
+ */
+class InterpolationSystem : public Updateable
+{
+public:
+    void update(ECSEngine& engine) override;
+
+    SystemAccess getAccess() const override { return SystemAccess().writes<Interpolated>(); }
+
+    std::string getName() const override { return "InterpolationSystem"; }
+};
+}  // namespace lz
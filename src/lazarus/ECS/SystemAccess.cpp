@@ -0,0 +1,50 @@
+#include <lazarus/ECS/SystemAccess.h>
+
+using namespace lz;
+
+namespace
+{
+// Returns whether any element of the first set is in the second one
+template <typename T>
+bool intersects(const std::unordered_set<T>& a, const std::unordered_set<T>& b)
+{
+    for (const auto& element : a)
+    {
+        if (b.count(element) > 0)
+            return true;
+    }
+    return false;
+}
+}
+
+SystemAccess SystemAccess::exclusive()
+{
+    SystemAccess access;
+    access.exclusiveAccess = true;
+    return access;
+}
+
+SystemAccess& SystemAccess::readsResource(const std::string& resource)
+{
+    readResources.insert(resource);
+    return *this;
+}
+
+SystemAccess& SystemAccess::writesResource(const std::string& resource)
+{
+    writtenResources.insert(resource);
+    return *this;
+}
+
+bool SystemAccess::conflictsWith(const SystemAccess& other) const
+{
+    if (exclusiveAccess || other.exclusiveAccess)
+        return true;
+
+    return intersects(writtenComponents, other.writtenComponents)
+        || intersects(writtenComponents, other.readComponents)
+        || intersects(readComponents, other.writtenComponents)
+        || intersects(writtenResources, other.writtenResources)
+        || intersects(writtenResources, other.readResources)
+        || intersects(readResources, other.writtenResources);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <typeindex>
+#include <unordered_set>
+
+namespace lz
+{
+/**
+ * Declaration of the data an updateable reads and writes when it is updated.
+ *
+ * The data is declared as component types and named resources, which can be
+ * anything shared between systems, such as the map or the message log.
+ * Two updateables conflict when one of them writes data that the other one
+ * reads or writes. The ECS engine can run updateables that do not conflict
+ * at the same time.
+ *
+ * An exclusive access conflicts with any other access. This is the access of
+ * updateables that do not declare theirs.
+ *
+ * @see Updateable::getAccess
+ */
+class SystemAccess
+{
+public:
+    /**
+     * Returns an access that conflicts with every other access.
+     */
+    static SystemAccess exclusive();
+
+    /**
+     * Declares that the components of the given types are read.
+     */
+    template <typename... Types>
+    SystemAccess& reads();
+
+    /**
+     * Declares that the components of the given types are written.
+     */
+    template <typename... Types>
+    SystemAccess& writes();
+
+    /**
+     * Declares that the resource with the given name is read.
+     */
+    SystemAccess& readsResource(const std::string& resource);
+
+    /**
+     * Declares that the resource with the given name is written.
+     */
+    SystemAccess& writesResource(const std::string& resource);
+
+    /**
+     * Returns whether this access conflicts with the other one.
+     */
+    bool conflictsWith(const SystemAccess& other) const;
+
+    /**
+     * Returns whether this access conflicts with every other access.
+     */
+    bool isExclusive() const { return exclusiveAccess; }
+
+private:
+    std::unordered_set<std::type_index> readComponents;
+    std::unordered_set<std::type_index> writtenComponents;
+    std::unordered_set<std::string> readResources;
+    std::unordered_set<std::string> writtenResources;
+    bool exclusiveAccess = false;
+};
+
+template <typename... Types>
+SystemAccess& SystemAccess::reads()
+{
+    for (auto typeId : {std::type_index(typeid(Types))...})
+        readComponents.insert(typeId);
+    return *this;
+}
+
+template <typename... Types>
+SystemAccess& SystemAccess::writes()
+{
+    for (auto typeId : {std::type_index(typeid(Types))...})
+        writtenComponents.insert(typeId);
+    return *this;
+}
+}  // namespace lz
@@ -0,0 +1,112 @@
+#include <lazarus/ECS/SystemScheduler.h>
+
+#include <algorithm>
+
+#include <lazarus/ECS/ECSEngine.h>
+#include <lazarus/ECS/Updateable.h>
+#include <lazarus/JobSystem.h>
+
+using namespace lz;
+
+void SystemScheduler::add(Updateable* updateable, UpdateRate rate)
+{
+    updateables.push_back(updateable);
+    timings.emplace_back();
+    rates.push_back(rate);
+    dueCounts.push_back(0);
+    stagesDirty = true;
+}
+
+void SystemScheduler::run(ECSEngine& engine, ulong tick, double elapsed)
+{
+    if (stagesDirty)
+        buildStages();
+
+    for (size_t i = 0; i < rates.size(); ++i)
+        dueCounts[i] = rates[i].advance(tick, elapsed);
+
+    std::vector<size_t> due;
+    for (const auto& stage : stageIndices)
+    {
+        due.clear();
+        for (auto index : stage)
+        {
+            if (dueCounts[index] > 0)
+                due.push_back(index);
+        }
+
+        if (due.size() <= 1)
+        {
+            for (auto index : due)
+                runTimed(index, engine);
+            continue;
+        }
+
+        JobSystem& jobs = engine.getJobSystem();
+        JobCounter counter;
+        for (auto index : due)
+            jobs.spawn([this, index, &engine] { runTimed(index, engine); }, &counter);
+        jobs.wait(counter);
+    }
+}
+
+std::vector<SystemTiming> SystemScheduler::getTimings() const
+{
+    std::vector<SystemTiming> result(updateables.size());
+    for (size_t i = 0; i < updateables.size(); ++i)
+    {
+        result[i].updateable = updateables[i];
+        result[i].name = updateables[i]->getName();
+        timings[i].summarize(result[i]);
+    }
+    return result;
+}
+
+void SystemScheduler::runTimed(size_t index, ECSEngine& engine)
+{
+    // Each updateable is only run by one thread at a time, so its history needs no lock
+    for (unsigned i = 0; i < dueCounts[index]; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        updateables[index]->update(engine);
+        timings[index].add(std::chrono::steady_clock::now() - start);
+    }
+}
+
+const std::vector<std::vector<Updateable*>>& SystemScheduler::getStages()
+{
+    if (stagesDirty)
+        buildStages();
+    return stages;
+}
+
+void SystemScheduler::buildStages()
+{
+    std::vector<SystemAccess> accesses;
+    std::vector<size_t> stageOf;
+    stages.clear();
+    stageIndices.clear();
+    for (size_t index = 0; index < updateables.size(); ++index)
+    {
+        // Run after every earlier updateable it conflicts with
+        Updateable* updateable = updateables[index];
+        SystemAccess access = updateable->getAccess();
+        size_t stage = 0;
+        for (size_t i = 0; i < accesses.size(); ++i)
+        {
+            if (access.conflictsWith(accesses[i]))
+                stage = std::max(stage, stageOf[i] + 1);
+        }
+
+        if (stage == stages.size())
+        {
+            stages.emplace_back();
+            stageIndices.emplace_back();
+        }
+        stages[stage].push_back(updateable);
+        stageIndices[stage].push_back(index);
+        accesses.push_back(std::move(access));
+        stageOf.push_back(stage);
+    }
+    stagesDirty = false;
+}
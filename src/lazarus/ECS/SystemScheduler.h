@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+
+#include <lazarus/ECS/SystemTiming.h>
+#include <lazarus/ECS/UpdateRate.h>
+
+namespace lz
+{
+class ECSEngine;
+class Updateable;
+
+/**
+ * Runs the updateables of an ECS engine in stages.
+ *
+ * Each updateable is placed in the stage after the last stage that holds an
+ * updateable registered before it and whose access conflicts with its own.
+ * Updateables in the same stage do not conflict, so they are run at the same
+ * time as jobs of the job system of the engine, while conflicting updateables
+ * still run in registration order. This keeps the results deterministic.
+ *
+ * Each updateable has an update rate, and is skipped on the ticks it is not
+ * due on. The scheduler also measures how long each update of each updateable
+ * takes.
+ *
+ * @see SystemAccess
+ * @see Updateable::getAccess
+ */
+class SystemScheduler
+{
+public:
+    /**
+     * Adds an updateable after the ones already added, to be updated at the given rate.
+     */
+    void add(Updateable* updateable, UpdateRate rate=UpdateRate::everyTick());
+
+    /**
+     * Updates all the updateables that are due on the given tick, stage by stage.
+     * 
+     * @param tick Number of the tick, starting at 0.
+     * @param elapsed Seconds passed since the previous tick.
+     */
+    void run(ECSEngine& engine, ulong tick, double elapsed);
+
+    /**
+     * Returns the updateables of each stage, in the order the stages are run.
+     */
+    const std::vector<std::vector<Updateable*>>& getStages();
+
+    /**
+     * Returns a summary of the duration of the recent updates of each
+     * updateable, in the order they were added.
+     */
+    std::vector<SystemTiming> getTimings() const;
+
+private:
+    void buildStages();
+    // Updates the updateable at the given index as many times as it is due,
+    // and records how long each update took
+    void runTimed(size_t index, ECSEngine& engine);
+
+private:
+    std::vector<Updateable*> updateables;
+    std::vector<__lz::TimingHistory> timings;
+    std::vector<UpdateRate> rates;
+    // Number of times each updateable is due on the current tick
+    std::vector<unsigned> dueCounts;
+    std::vector<std::vector<Updateable*>> stages;
+    // Same as stages, with the indices of the updateables
+    std::vector<std::vector<size_t>> stageIndices;
+    bool stagesDirty = false;
+};
+}  // namespace lz
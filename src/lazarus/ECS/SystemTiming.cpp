@@ -0,0 +1,30 @@
+#include <lazarus/ECS/SystemTiming.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace __lz;
+
+const size_t TimingHistory::WINDOW;
+
+void TimingHistory::add(std::chrono::nanoseconds duration)
+{
+    durations[next] = duration;
+    next = (next + 1) % WINDOW;
+    count = std::min(count + 1, WINDOW);
+}
+
+void TimingHistory::summarize(lz::SystemTiming& timing) const
+{
+    timing.samples = count;
+    if (count == 0)
+        return;
+
+    timing.last = durations[(next + WINDOW - 1) % WINDOW];
+    std::vector<std::chrono::nanoseconds> sorted(durations.begin(), durations.begin() + count);
+    std::sort(sorted.begin(), sorted.end());
+    // Nearest-rank percentiles
+    timing.p50 = sorted[(count - 1) * 50 / 100];
+    timing.p95 = sorted[(count - 1) * 95 / 100];
+    timing.max = sorted.back();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+
+namespace lz
+{
+class Updateable;
+
+/**
+ * Summary of the time an updateable took on its recent updates.
+ *
+ * @see ECSEngine::getSystemTimings
+ */
+struct SystemTiming
+{
+    Updateable* updateable = nullptr;
+    // Name of the updateable, as given by Updateable::getName
+    std::string name;
+    // Number of recent updates the summary is computed from
+    size_t samples = 0;
+    std::chrono::nanoseconds last{0};
+    std::chrono::nanoseconds p50{0};
+    std::chrono::nanoseconds p95{0};
+    std::chrono::nanoseconds max{0};
+};
+}  // namespace lz
+
+namespace __lz  // Meant for internal use only
+{
+/**
+ * Rolling window with the durations of the most recent updates of an updateable.
+ */
+class TimingHistory
+{
+public:
+    // Number of updates kept in the window
+    static const size_t WINDOW = 128;
+
+    /**
+     * Adds the duration of an update, replacing the oldest one if the window is full.
+     */
+    void add(std::chrono::nanoseconds duration);
+
+    /**
+     * Fills the sample count and duration percentiles of the timing summary.
+     */
+    void summarize(lz::SystemTiming& timing) const;
+
+private:
+    std::array<std::chrono::nanoseconds, WINDOW> durations;
+    size_t count = 0;
+    size_t next = 0;
+};
+}
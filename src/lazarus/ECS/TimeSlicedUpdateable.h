@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+
+namespace lz
+{
+class ECSEngine;
+
+/**
+ * Interface for long jobs that the ECS engine spreads over several ticks.
+ *
+ * Objects which derive from TimeSlicedUpdateable will need to implement the
+ * update method, which is called by the ECS engine on every tick with a
+ * deadline and a cursor. The job should do as much work as possible before the
+ * deadline, then save where it stopped in the cursor and return. On the next
+ * tick, it is called again with the same cursor, so it can resume from there.
+ *
+ * Each tick, the engine splits its frame budget between all the time sliced
+ * updateables, so jobs such as refreshing a dungeon-wide Dijkstra map can run
+ * without causing hitches.
+ *
+ * @see ECSEngine::registerTimeSliced
+ * @see ECSEngine::setFrameBudget
+ */
+class TimeSlicedUpdateable
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~TimeSlicedUpdateable() = default;
+
+    /**
+     * Continues the job until it is finished or the deadline passes.
+     *
+     * The job should do at least one step of work before checking the deadline,
+     * so it always makes progress even if its share of the budget is empty.
+     *
+     * @param engine Reference to the ECS engine the updateable lives in.
+     * @param deadline Time at which the job should return.
+     * @param cursor Position the job reached, which is 0 when the job starts.
+     * @return Whether the job finished. The engine then resets the cursor to 0,
+     *         and the job starts again on the next tick.
+     */
+    virtual bool update(ECSEngine& engine, Clock::time_point deadline, size_t& cursor) = 0;
+};
+}  // namespace lz
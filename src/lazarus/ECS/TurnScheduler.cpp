@@ -0,0 +1,206 @@
+#include <lazarus/ECS/TurnScheduler.h>
+
+using namespace lz;
+
+const unsigned TurnScheduler::ACTION_COST;
+const unsigned TurnScheduler::SPEED_SCALE;
+const TurnScheduler::NodeIndex TurnScheduler::NONE;
+
+void TurnScheduler::add(Identifier actor, unsigned speed, ulong delay)
+{
+    if (speed == 0)
+        throw __lz::LazarusException("Actor speed must be positive");
+    if (contains(actor))
+    {
+        std::stringstream msg;
+        msg << "Actor " << actor << " is already in the turn queue";
+        throw __lz::LazarusException(msg.str());
+    }
+
+    NodeIndex node = createNode(actor, now + delay);
+    actors[actor] = Actor{speed, node};
+    root = meld(root, node);
+}
+
+void TurnScheduler::remove(Identifier actor)
+{
+    // The node of the actor, if any, becomes stale and is freed when popped
+    actors.erase(actor);
+}
+
+void TurnScheduler::setSpeed(Identifier actor, unsigned speed)
+{
+    if (speed == 0)
+        throw __lz::LazarusException("Actor speed must be positive");
+    auto found = actors.find(actor);
+    if (found == actors.end())
+    {
+        std::stringstream msg;
+        msg << "Actor " << actor << " is not in the turn queue";
+        throw __lz::LazarusException(msg.str());
+    }
+
+    Actor& info = found->second;
+    unsigned oldSpeed = info.speed;
+    info.speed = speed;
+    if (info.node == NONE || speed == oldSpeed)
+        return;
+
+    Node& node = nodes[info.node];
+    ulong time = now + (node.time - now) * oldSpeed / speed;
+    if (time < node.time)
+    {
+        // Decrease key
+        node.time = time;
+        if (info.node != root)
+        {
+            cut(info.node);
+            root = meld(root, info.node);
+        }
+    }
+    else if (time > node.time)
+    {
+        // Leave the old node stale and schedule the actor again
+        info.node = createNode(actor, time);
+        root = meld(root, info.node);
+    }
+}
+
+unsigned TurnScheduler::getSpeed(Identifier actor) const
+{
+    auto found = actors.find(actor);
+    return found == actors.end() ? 0 : found->second.speed;
+}
+
+Entity* TurnScheduler::next(ECSEngine& engine)
+{
+    while (root != NONE)
+    {
+        NodeIndex top = root;
+        root = popRoot();
+        Identifier actor = nodes[top].actor;
+        ulong time = nodes[top].time;
+        freeNodes.push_back(top);
+
+        auto found = actors.find(actor);
+        if (found == actors.end() || found->second.node != top)
+            continue;  // Stale node
+
+        Entity* entity = engine.getEntity(actor);
+        if (entity == nullptr || entity->isDeleted())
+        {
+            actors.erase(found);
+            continue;
+        }
+
+        found->second.node = NONE;
+        now = time;
+        return entity;
+    }
+    return nullptr;
+}
+
+void TurnScheduler::endTurn(Identifier actor, unsigned cost)
+{
+    auto found = actors.find(actor);
+    if (found == actors.end() || found->second.node != NONE)
+    {
+        std::stringstream msg;
+        msg << "Actor " << actor << " is not taking its turn";
+        throw __lz::LazarusException(msg.str());
+    }
+
+    Actor& info = found->second;
+    info.node = createNode(actor, now + delayFor(cost, info.speed));
+    root = meld(root, info.node);
+}
+
+bool TurnScheduler::before(NodeIndex a, NodeIndex b) const
+{
+    const Node& nodeA = nodes[a];
+    const Node& nodeB = nodes[b];
+    if (nodeA.time != nodeB.time)
+        return nodeA.time < nodeB.time;
+    return nodeA.sequence < nodeB.sequence;
+}
+
+TurnScheduler::NodeIndex TurnScheduler::createNode(Identifier actor, ulong time)
+{
+    Node node{time, sequence++, actor, NONE, NONE, NONE};
+    if (!freeNodes.empty())
+    {
+        NodeIndex index = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[index] = node;
+        return index;
+    }
+    nodes.push_back(node);
+    return static_cast<NodeIndex>(nodes.size() - 1);
+}
+
+TurnScheduler::NodeIndex TurnScheduler::meld(NodeIndex a, NodeIndex b)
+{
+    if (a == NONE)
+        return b;
+    if (b == NONE)
+        return a;
+    if (before(b, a))
+        std::swap(a, b);
+
+    // Make b the first child of a
+    Node& parent = nodes[a];
+    Node& child = nodes[b];
+    child.sibling = parent.child;
+    if (parent.child != NONE)
+        nodes[parent.child].prev = b;
+    child.prev = a;
+    parent.child = b;
+    return a;
+}
+
+TurnScheduler::NodeIndex TurnScheduler::popRoot()
+{
+    // Detach the children of the root
+    pairing.clear();
+    NodeIndex child = nodes[root].child;
+    while (child != NONE)
+    {
+        NodeIndex sibling = nodes[child].sibling;
+        nodes[child].sibling = NONE;
+        nodes[child].prev = NONE;
+        pairing.push_back(child);
+        child = sibling;
+    }
+
+    // First pass: meld pairs from left to right
+    size_t paired = 0;
+    for (size_t i = 0; i + 1 < pairing.size(); i += 2)
+        pairing[paired++] = meld(pairing[i], pairing[i + 1]);
+    if (pairing.size() % 2 == 1)
+        pairing[paired++] = pairing.back();
+
+    // Second pass: meld the pairs from right to left
+    NodeIndex newRoot = NONE;
+    for (size_t i = paired; i > 0; --i)
+        newRoot = meld(pairing[i - 1], newRoot);
+    return newRoot;
+}
+
+void TurnScheduler::cut(NodeIndex index)
+{
+    Node& node = nodes[index];
+    Node& prev = nodes[node.prev];
+    if (prev.child == index)
+        prev.child = node.sibling;
+    else
+        prev.sibling = node.sibling;
+    if (node.sibling != NONE)
+        nodes[node.sibling].prev = node.prev;
+    node.prev = NONE;
+    node.sibling = NONE;
+}
+
+ulong TurnScheduler::delayFor(unsigned cost, unsigned speed) const
+{
+    return static_cast<ulong>(cost) * SPEED_SCALE / speed;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <lazarus/ECS/ECSEngine.h>
+#include <lazarus/ECS/Entity.h>
+
+namespace lz
+{
+/**
+ * Speed and energy based turn queue for the actors of an ECS engine.
+ *
+ * Each actor is an entity with a speed, and taking an action costs it energy.
+ * After an actor acts, its next turn comes after cost * SPEED_SCALE / speed
+ * units of time, so an actor with twice the speed acts twice as often.
+ *
+ * The actors are kept in a pairing heap keyed by the time of their next turn,
+ * which takes amortized O(log n) to pick the next actor and O(1) to add an
+ * actor or speed it up. Removing an actor, slowing it down or deleting its
+ * entity with Entity::markForDeletion are lazy: the stale entry is skipped
+ * when it reaches the top of the heap.
+ *
+ * Actors with their turn at the same time act in the order they were scheduled.
+ */
+class TurnScheduler
+{
+public:
+    // Energy cost of a standard action
+    static const unsigned ACTION_COST = 100;
+    // Speed of an actor which takes a standard action every ACTION_COST units of time
+    static const unsigned SPEED_SCALE = 100;
+
+    /**
+     * Adds an actor to the queue.
+     *
+     * If the actor is already in the queue, an exception is thrown.
+     *
+     * @param actor ID of the entity of the actor.
+     * @param speed Speed of the actor, which must be positive.
+     * @param delay Units of time from now until the first turn of the actor.
+     */
+    void add(Identifier actor, unsigned speed=SPEED_SCALE, ulong delay=0);
+
+    /**
+     * Removes an actor from the queue.
+     *
+     * Removing an actor that is not in the queue does nothing.
+     */
+    void remove(Identifier actor);
+
+    /**
+     * Changes the speed of an actor.
+     *
+     * If the actor is waiting for its turn, the time left until its turn is
+     * scaled by the ratio between the old and the new speed.
+     * If the actor is not in the queue, an exception is thrown.
+     */
+    void setSpeed(Identifier actor, unsigned speed);
+
+    /**
+     * Returns the speed of an actor, or 0 if it is not in the queue.
+     */
+    unsigned getSpeed(Identifier actor) const;
+
+    /**
+     * Advances the time to the next turn and returns the entity whose turn it is.
+     *
+     * Actors whose entities no longer exist in the engine or are marked for
+     * deletion are removed from the queue on the way. Returns a nullptr if
+     * there are no actors left waiting for their turn.
+     *
+     * The actor does not get another turn until endTurn is called for it.
+     */
+    Entity* next(ECSEngine& engine);
+
+    /**
+     * Schedules the next turn of an actor that has acted, after the time its
+     * action takes with its speed.
+     *
+     * If the actor is not in the queue or is already waiting for its turn,
+     * an exception is thrown.
+     *
+     * @param actor ID of the entity of the actor.
+     * @param cost Energy spent by the action.
+     */
+    void endTurn(Identifier actor, unsigned cost=ACTION_COST);
+
+    /**
+     * Returns whether the actor is in the queue, either waiting or taking its turn.
+     */
+    bool contains(Identifier actor) const { return actors.count(actor) > 0; }
+
+    /**
+     * Returns the number of actors in the queue.
+     */
+    size_t size() const { return actors.size(); }
+
+    /**
+     * Returns the current time, which is the time of the last turn given.
+     */
+    ulong getTime() const { return now; }
+
+private:
+    using NodeIndex = uint32_t;
+    static const NodeIndex NONE = UINT32_MAX;
+
+    struct Node
+    {
+        ulong time;
+        ulong sequence;
+        Identifier actor;
+        NodeIndex child;
+        NodeIndex sibling;
+        // Previous sibling, or parent for the first child
+        NodeIndex prev;
+    };
+
+    struct Actor
+    {
+        unsigned speed;
+        // Node of the next turn of the actor, or NONE while it takes its turn
+        NodeIndex node;
+    };
+
+    // Returns whether node a goes before node b
+    bool before(NodeIndex a, NodeIndex b) const;
+    NodeIndex createNode(Identifier actor, ulong time);
+    NodeIndex meld(NodeIndex a, NodeIndex b);
+    // Removes the root and returns the new root, built by pairing its children
+    NodeIndex popRoot();
+    // Detaches a node other than the root from its parent
+    void cut(NodeIndex node);
+    ulong delayFor(unsigned cost, unsigned speed) const;
+
+private:
+    std::vector<Node> nodes;
+    std::vector<NodeIndex> freeNodes;
+    std::vector<NodeIndex> pairing;
+    std::unordered_map<Identifier, Actor> actors;
+    NodeIndex root = NONE;
+    ulong now = 0;
+    ulong sequence = 0;
+};
+}  // namespace lz
@@ -0,0 +1,44 @@
+#include <lazarus/ECS/UpdateRate.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace lz;
+
+UpdateRate UpdateRate::everyTick()
+{
+    return UpdateRate();
+}
+
+UpdateRate UpdateRate::everyNthTick(unsigned n, unsigned phase)
+{
+    UpdateRate rate;
+    rate.interval = n > 0 ? n : 1;
+    rate.phase = phase % rate.interval;
+    return rate;
+}
+
+UpdateRate UpdateRate::fixedHz(double hz, unsigned maxCatchUp)
+{
+    if (hz <= 0.)
+        throw __lz::LazarusException("Update frequency must be positive");
+
+    UpdateRate rate;
+    rate.period = 1. / hz;
+    rate.maxCatchUp = maxCatchUp > 0 ? maxCatchUp : 1;
+    return rate;
+}
+
+unsigned UpdateRate::advance(ulong tick, double elapsed)
+{
+    if (period == 0.)
+        return tick % interval == phase ? 1 : 0;
+
+    accumulator += elapsed;
+    // Tolerate rounding errors, so that adding up frame times reaches the period
+    double steps = std::floor(accumulator / period + 1e-9);
+    // When too far behind, the whole steps that cannot be caught up with are
+    // dropped, but the time towards the next step is kept
+    accumulator -= steps * period;
+    return static_cast<unsigned>(std::min(steps, static_cast<double>(maxCatchUp)));
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <lazarus/common.h>
+
+namespace lz
+{
+/**
+ * Rate at which an updateable is updated by the ECS engine.
+ *
+ * An updateable can be updated on every tick of the engine, on every Nth tick,
+ * or a fixed number of times per second of the time passed to
+ * ECSEngine::update. Updateables that are not due on a tick are skipped, so
+ * they cost nothing on that tick.
+ *
+ * @see ECSEngine::registerUpdateable
+ */
+class UpdateRate
+{
+public:
+    /**
+     * Returns a rate that updates on every tick.
+     */
+    static UpdateRate everyTick();
+
+    /**
+     * Returns a rate that updates once every n ticks.
+     *
+     * @param n Number of ticks between updates. 0 is treated as 1.
+     * @param phase Tick, from 0 to n - 1, on which the first update happens.
+     */
+    static UpdateRate everyNthTick(unsigned n, unsigned phase=0);
+
+    /**
+     * Returns a rate that updates a fixed number of times per second.
+     *
+     * The time passed to each engine update is accumulated, and the
+     * updateable is updated once per full period in the accumulator. If the
+     * engine falls behind, at most maxCatchUp updates are run on one tick, and
+     * the other full periods in the accumulator are dropped.
+     *
+     * @param hz Number of updates per second.
+     * @param maxCatchUp Maximum number of updates run on a single tick. 0 is
+     * treated as 1.
+     */
+    static UpdateRate fixedHz(double hz, unsigned maxCatchUp=4);
+
+    /**
+     * Advances the rate to the given tick and returns how many times the
+     * updateable has to be updated on it.
+     *
+     * @param tick Number of the tick, starting at 0.
+     * @param elapsed Seconds passed since the previous tick.
+     */
+    unsigned advance(ulong tick, double elapsed);
+
+    /**
+     * Returns the number of seconds between updates for fixed rates, or 0 for
+     * rates based on ticks.
+     */
+    double getPeriod() const { return period; }
+
+private:
+    UpdateRate() = default;
+
+private:
+    unsigned interval = 1;
+    unsigned phase = 0;
+    double period = 0.;
+    unsigned maxCatchUp = 0;
+    double accumulator = 0.;
+};
+}  // namespace lz
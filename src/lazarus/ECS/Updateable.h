@@ -1,6 +1,10 @@
 #pragma once
 
+#include <string>
+#include <typeinfo>
+
 #include <lazarus/ECS/ECSEngine.h>
+#include <lazarus/ECS/SystemAccess.h>
 
 namespace lz
 {
@@ -26,5 +30,29 @@ public:
      * the update method from the ECSEngine is called.
      */
     virtual void update(ECSEngine& engine) = 0;
+
+    /**
+     * Returns the data this updateable reads and writes when it is updated.
+     * 
+     * The ECS engine runs updateables whose accesses do not conflict at the
+     * same time, on different threads, so the access must declare everything
+     * the update method touches, and must not change once the updateable is
+     * registered.
+     * 
+     * Adding entities, marking them for deletion or emitting events whose
+     * listeners have side effects change state shared by all updateables, so
+     * updateables that do any of these should keep the default access, which
+     * is exclusive and makes them run on their own.
+     * 
+     * @see SystemAccess
+     */
+    virtual SystemAccess getAccess() const { return SystemAccess::exclusive(); }
+
+    /**
+     * Returns the name used to identify this updateable in timing reports.
+     * 
+     * Defaults to the name of its type, as given by typeid.
+     */
+    virtual std::string getName() const { return typeid(*this).name(); }
 };
 }  // namespace lz
@@ -0,0 +1,150 @@
+#include <lazarus/Framebuffer.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+using namespace lz;
+
+static_assert(sizeof(Color) == 4, "Colors must be packed RGBA bytes");
+
+namespace
+{
+// Largest amount of data in a stored deflate block
+const size_t MAX_STORED_BLOCK = 65535;
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc=0)
+{
+    static const std::array<uint32_t, 256> table = []
+    {
+        std::array<uint32_t, 256> table;
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit)
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            table[i] = value;
+        }
+        return table;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t adler32(const uint8_t* data, size_t size)
+{
+    // 5552 bytes is the most that can be summed before the sums can overflow
+    uint32_t a = 1, b = 0;
+    while (size > 0)
+    {
+        size_t chunk = std::min<size_t>(size, 5552);
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += chunk;
+        size -= chunk;
+    }
+    return (b << 16) | a;
+}
+
+void appendBigEndian(std::vector<uint8_t>& bytes, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        bytes.push_back(static_cast<uint8_t>(value >> shift));
+}
+
+void writeChunk(std::ostream& out, const char* type, const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    appendBigEndian(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    appendBigEndian(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+    out.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+}
+
+Framebuffer::Framebuffer(size_t width, size_t height, Color fill)
+{
+    create(width, height, fill);
+}
+
+Framebuffer::Framebuffer(size_t width, size_t height, const uint8_t* pixels)
+    : width(width)
+    , height(height)
+    , pixels(width * height)
+{
+    std::memcpy(this->pixels.data(), pixels, width * height * sizeof(Color));
+}
+
+void Framebuffer::create(size_t width, size_t height, Color fill)
+{
+    this->width = width;
+    this->height = height;
+    pixels.assign(width * height, fill);
+}
+
+void Framebuffer::fill(Color color)
+{
+    std::fill(pixels.begin(), pixels.end(), color);
+}
+
+bool Framebuffer::savePng(const std::string& path) const
+{
+    std::ofstream out(path, std::ios::binary);
+    return out && writePng(out);
+}
+
+bool Framebuffer::writePng(std::ostream& out) const
+{
+    static const uint8_t SIGNATURE[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.write(reinterpret_cast<const char*>(SIGNATURE), sizeof(SIGNATURE));
+
+    // 8 bits per channel, RGBA, no interlacing
+    std::vector<uint8_t> header;
+    appendBigEndian(header, static_cast<uint32_t>(width));
+    appendBigEndian(header, static_cast<uint32_t>(height));
+    header.insert(header.end(), {8, 6, 0, 0, 0});
+    writeChunk(out, "IHDR", header);
+
+    // Each row starts with its filter type, which is none
+    const size_t rowSize = 1 + width * sizeof(Color);
+    std::vector<uint8_t> raw(rowSize * height);
+    for (size_t y = 0; y < height; ++y)
+    {
+        raw[y * rowSize] = 0;
+        std::memcpy(&raw[y * rowSize + 1], getRow(y), width * sizeof(Color));
+    }
+
+    // A zlib stream made of stored deflate blocks
+    const size_t blocks = std::max<size_t>((raw.size() + MAX_STORED_BLOCK - 1) / MAX_STORED_BLOCK, 1);
+    std::vector<uint8_t> data;
+    data.reserve(2 + raw.size() + blocks * 5 + 4);
+    data.push_back(0x78);
+    data.push_back(0x01);
+    for (size_t block = 0; block < blocks; ++block)
+    {
+        const size_t begin = block * MAX_STORED_BLOCK;
+        const size_t size = std::min(MAX_STORED_BLOCK, raw.size() - begin);
+        data.push_back(block + 1 == blocks ? 1 : 0);
+        data.push_back(static_cast<uint8_t>(size));
+        data.push_back(static_cast<uint8_t>(size >> 8));
+        data.push_back(static_cast<uint8_t>(~size));
+        data.push_back(static_cast<uint8_t>(~size >> 8));
+        data.insert(data.end(), raw.begin() + begin, raw.begin() + begin + size);
+    }
+    appendBigEndian(data, adler32(raw.data(), raw.size()));
+    writeChunk(out, "IDAT", data);
+
+    writeChunk(out, "IEND", std::vector<uint8_t>());
+    return static_cast<bool>(out);
+}
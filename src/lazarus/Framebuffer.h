@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <lazarus/CellBuffer.h>
+
+namespace lz
+{
+/**
+ * An RGBA image in memory, with (0, 0) at the top left.
+ *
+ * Pixels are stored row by row with 8 bits per channel, which is the layout
+ * of sf::Image, so a framebuffer can be converted to and from SFML images
+ * and textures with getPixelsPtr and the constructor that copies pixels.
+ *
+ * @see SoftwareRenderer
+ */
+class Framebuffer
+{
+public:
+    /**
+     * Creates an image of the given size, with every pixel set to fill.
+     */
+    Framebuffer(size_t width=0, size_t height=0, Color fill=Color::Black);
+
+    /**
+     * Creates an image of the given size from RGBA pixels, row by row.
+     */
+    Framebuffer(size_t width, size_t height, const uint8_t* pixels);
+
+    size_t getWidth() const { return width; }
+    size_t getHeight() const { return height; }
+
+    /**
+     * Returns the pixel at the given position, without checking the bounds.
+     */
+    Color& operator()(size_t x, size_t y) { return pixels[y * width + x]; }
+    Color operator()(size_t x, size_t y) const { return pixels[y * width + x]; }
+
+    /**
+     * Returns the first pixel of the given row.
+     */
+    Color* getRow(size_t y) { return pixels.data() + y * width; }
+    const Color* getRow(size_t y) const { return pixels.data() + y * width; }
+
+    /**
+     * Returns the pixels as RGBA bytes, row by row.
+     */
+    const uint8_t* getPixelsPtr() const { return reinterpret_cast<const uint8_t*>(pixels.data()); }
+
+    /**
+     * Changes the size of the image, and sets every pixel to fill.
+     */
+    void create(size_t width, size_t height, Color fill=Color::Black);
+
+    /**
+     * Sets every pixel to the given color.
+     */
+    void fill(Color color);
+
+    /**
+     * Writes the image as a PNG file. Returns false if it cannot be written.
+     *
+     * The image data is stored without compression, which is fast and needs
+     * no dependency, at the cost of files as large as the pixels. It is meant
+     * for dumping frames to look at, not for shipping assets.
+     */
+    bool savePng(const std::string& path) const;
+    bool writePng(std::ostream& out) const;
+
+private:
+    size_t width;
+    size_t height;
+    std::vector<Color> pixels;
+};
+
+inline bool operator==(const Framebuffer& left, const Framebuffer& right)
+{
+    if (left.getWidth() != right.getWidth() || left.getHeight() != right.getHeight())
+        return false;
+    for (size_t y = 0; y < left.getHeight(); ++y)
+        for (size_t x = 0; x < left.getWidth(); ++x)
+            if (left(x, y) != right(x, y))
+                return false;
+    return true;
+}
+
+inline bool operator!=(const Framebuffer& left, const Framebuffer& right)
+{
+    return !(left == right);
+}
+}  // namespace lz
@@ -0,0 +1,210 @@
+#include <lazarus/JobSystem.h>
+
+using namespace lz;
+
+namespace
+{
+// Job system and queue index of the worker running on this thread, if any
+struct WorkerContext
+{
+    const JobSystem* system;
+    unsigned index;
+};
+
+thread_local WorkerContext workerContext{nullptr, 0};
+
+unsigned defaultWorkerCount()
+{
+    unsigned hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+}
+
+JobSystem::JobSystem(unsigned workerCount)
+{
+    for (unsigned i = 0; i <= workerCount; ++i)
+        queues.emplace_back(new Queue());
+    for (unsigned i = 1; i <= workerCount; ++i)
+        workers.emplace_back(&JobSystem::work, this, i);
+}
+
+JobSystem::JobSystem()
+    : JobSystem(defaultWorkerCount())
+{
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    sleeping.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+    // Without workers, or for jobs released by the last ones, the remaining
+    // jobs run on this thread
+    while (runOne(currentWorker()))
+        ;
+}
+
+void JobSystem::spawn(Job job, JobCounter* counter)
+{
+    if (counter != nullptr)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    push(Task{std::move(job), counter});
+}
+
+void JobSystem::spawnAfter(JobCounter& dependency, Job job, JobCounter* counter)
+{
+    if (counter != nullptr)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        // The dependency is only decremented under its lock, so it cannot
+        // release its continuations between this check and the insertion
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (!dependency.isDone())
+        {
+            dependency.continuations.emplace_back(std::move(job), counter);
+            return;
+        }
+    }
+    push(Task{std::move(job), counter});
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    unsigned index = currentWorker();
+    while (!counter.isDone())
+    {
+        if (!runOne(index))
+            std::this_thread::yield();
+    }
+
+    std::exception_ptr error;
+    {
+        // Also makes sure the last job to finish is done with the counter
+        std::lock_guard<std::mutex> lock(counter.mutex);
+        std::swap(error, counter.error);
+    }
+    if (!error)
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        std::swap(error, orphanError);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+unsigned JobSystem::currentWorker() const
+{
+    return workerContext.system == this ? workerContext.index : 0;
+}
+
+const JobSystem* JobSystem::current()
+{
+    return workerContext.system;
+}
+
+void JobSystem::push(Task task)
+{
+    Queue& queue = *queues[currentWorker()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+    {
+        // Taking the lock makes sure a worker about to sleep sees the new job
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    sleeping.notify_one();
+}
+
+bool JobSystem::runOne(unsigned index)
+{
+    Task task;
+    bool found = false;
+    {
+        // Newest job of the own queue first
+        Queue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+    for (size_t i = 1; i < queues.size() && !found; ++i)
+    {
+        // Oldest job of another queue
+        Queue& victim = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            found = true;
+            steals.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (!found)
+        return false;
+
+    queued.fetch_sub(1);
+    std::exception_ptr error;
+    try
+    {
+        task.job();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    finish(task.counter, error);
+    return true;
+}
+
+void JobSystem::finish(JobCounter* counter, std::exception_ptr error)
+{
+    if (counter == nullptr)
+    {
+        if (error)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!orphanError)
+                orphanError = error;
+        }
+        return;
+    }
+
+    std::vector<std::pair<Job, JobCounter*>> released;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (error && !counter->error)
+            counter->error = error;
+        if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            released.swap(counter->continuations);
+    }
+    // The counter may be destroyed by now, only use the released jobs
+    for (auto& continuation : released)
+        push(Task{std::move(continuation.first), continuation.second});
+}
+
+void JobSystem::work(unsigned index)
+{
+    workerContext = WorkerContext{this, index};
+    while (true)
+    {
+        if (runOne(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.wait(lock, [this] { return stopping || queued.load() > 0; });
+        // Queued jobs are still run when stopping, a worker that is running a job
+        // runs the jobs it releases before leaving
+        if (stopping && queued.load() == 0)
+            return;
+    }
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lz
+{
+class JobSystem;
+
+/**
+ * Counts the unfinished jobs of a group of jobs.
+ *
+ * A counter is passed to JobSystem::spawn to add jobs to its group, and can
+ * then be waited on with JobSystem::wait, or used as a dependency of other jobs
+ * with JobSystem::spawnAfter. Counters can be reused once they reach zero.
+ */
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    /**
+     * Returns whether all the jobs of the group have finished.
+     */
+    bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<int> pending{0};
+    std::mutex mutex;
+    // Jobs to spawn once the counter reaches zero, with their own counters
+    std::vector<std::pair<std::function<void()>, JobCounter*>> continuations;
+    std::exception_ptr error;
+};
+
+/**
+ * Pool of worker threads that run jobs, with work stealing.
+ *
+ * Each worker has its own queue of jobs. Jobs spawned from a worker go to its
+ * queue, and the worker runs the most recently spawned jobs first. Workers
+ * that run out of jobs steal the oldest jobs from the queues of the others.
+ *
+ * Threads that wait for a group of jobs run queued jobs while waiting, so the
+ * job system also works without worker threads, running every job on the
+ * thread that waits for it.
+ *
+ * @see JobCounter
+ * @see ECSEngine::getJobSystem
+ */
+class JobSystem
+{
+public:
+    using Job = std::function<void()>;
+
+    /**
+     * Creates a job system with the given number of worker threads.
+     */
+    explicit JobSystem(unsigned workers);
+
+    /**
+     * Creates a job system with one worker thread less than the number of
+     * hardware threads.
+     */
+    JobSystem();
+
+    /**
+     * Runs the jobs that are still queued, including the ones they spawn or
+     * release, and stops the workers once every queue is empty.
+     *
+     * Counters of those jobs are thus signalled, so threads that wait on them
+     * do not hang. Exceptions thrown by those jobs are only kept on their counters.
+     */
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * Queues a job to be run by any thread.
+     *
+     * If a counter is given, the job is added to its group. If the job throws,
+     * the exception is rethrown by the next wait on its counter, or by the next
+     * wait on any counter if the job has none.
+     */
+    void spawn(Job job, JobCounter* counter=nullptr);
+
+    /**
+     * Queues a job to be run once all the jobs of the dependency have finished.
+     *
+     * The job is added to the group of its own counter right away, if given.
+     */
+    void spawnAfter(JobCounter& dependency, Job job, JobCounter* counter=nullptr);
+
+    /**
+     * Runs queued jobs until all the jobs of the counter have finished.
+     *
+     * If a job of the group threw an exception, it is rethrown.
+     */
+    void wait(JobCounter& counter);
+
+    /**
+     * Calls func(i) for every i in [begin, end), split into jobs of at most
+     * grain indices each, and waits for all of them to finish.
+     */
+    template <typename Func>
+    void parallelFor(size_t begin, size_t end, size_t grain, Func func);
+
+    /**
+     * Returns the number of worker threads.
+     */
+    unsigned getWorkerCount() const { return static_cast<unsigned>(workers.size()); }
+
+    /**
+     * Returns the index of the worker thread that calls this method, from 1 to the
+     * number of workers, or 0 if it is not called from a worker of this job system.
+     */
+    unsigned currentWorker() const;
+
+    /**
+     * Returns the job system whose worker thread calls this method, or nullptr
+     * if it is not called from a worker thread.
+     */
+    static const JobSystem* current();
+
+    /**
+     * Returns the number of jobs that were stolen from the queue of another thread.
+     */
+    unsigned long getStealCount() const { return steals.load(std::memory_order_relaxed); }
+
+private:
+    struct Task
+    {
+        Job job;
+        JobCounter* counter;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task);
+    // Takes a job from the queue of the given thread, or steals one from another
+    // queue, and runs it. Returns false if there were no jobs to run.
+    bool runOne(unsigned index);
+    void finish(JobCounter* counter, std::exception_ptr error);
+    void work(unsigned index);
+
+private:
+    std::vector<std::thread> workers;
+    // Queue 0 is shared by all threads that are not workers
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::atomic<long> queued{0};
+    std::atomic<unsigned long> steals{0};
+    std::mutex sleepMutex;
+    std::condition_variable sleeping;
+    bool stopping = false;
+    std::mutex errorMutex;
+    std::exception_ptr orphanError;
+};
+
+template <typename Func>
+void JobSystem::parallelFor(size_t begin, size_t end, size_t grain, Func func)
+{
+    if (begin >= end)
+        return;
+    grain = std::max<size_t>(grain, 1);
+
+    JobCounter counter;
+    for (size_t first = begin; first < end; first += grain)
+    {
+        size_t last = std::min(end, first + grain);
+        spawn([first, last, &func]
+        {
+            for (size_t i = first; i < last; ++i)
+                func(i);
+        }, &counter);
+    }
+    wait(counter);
+}
+}  // namespace lz
@@ -0,0 +1,642 @@
+#include <lazarus/Noise.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <lazarus/JobSystem.h>
+#include <lazarus/Random.h>
+
+#ifdef LZ_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace lz;
+
+namespace
+{
+// Points evaluated at once by fill, which bounds the size of its buffers
+const size_t CHUNK_SIZE = 256;
+// Cells per job when tiles are split among threads
+const size_t CELLS_PER_JOB = 16384;
+
+// Multipliers that spread the grid coordinates over the hash
+const uint32_t PRIME_X = 0x27D4EB2Du;
+const uint32_t PRIME_Y = 0x165667B1u;
+const uint32_t PRIME_Z = 0x1B873593u;
+const uint32_t MIX_1 = 0x2C1B3C6Du;
+const uint32_t MIX_2 = 0x297A2D39u;
+
+// Scales that bring the gradient noises to about [-1, 1]
+const float SIMPLEX2_SCALE = 70.f;
+const float SIMPLEX3_SCALE = 32.f;
+
+// Scalar versions of the noise functions
+
+inline uint32_t mix(uint32_t h)
+{
+    h ^= h >> 15;
+    h *= MIX_1;
+    h ^= h >> 12;
+    h *= MIX_2;
+    h ^= h >> 15;
+    return h;
+}
+
+inline int32_t fastFloor(float value)
+{
+    int32_t truncated = static_cast<int32_t>(value);
+    return static_cast<float>(truncated) > value ? truncated - 1 : truncated;
+}
+
+inline float fade(float t)
+{
+    return t * t * t * (t * (t * 6.f - 15.f) + 10.f);
+}
+
+inline float lerp(float a, float b, float t)
+{
+    return a + t * (b - a);
+}
+
+// Dot product with one of the four diagonal gradients
+inline float gradient(uint32_t h, float x, float y)
+{
+    return ((h & 1) ? -x : x) + ((h & 2) ? -y : y);
+}
+
+// Dot product with one of the twelve gradients to the edges of a cube
+inline float gradient(uint32_t h, float x, float y, float z)
+{
+    h &= 15;
+    float u = h < 8 ? x : y;
+    float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+    return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+// Maps a hash to a value in [-1, 1)
+inline float hashValue(uint32_t h)
+{
+    return static_cast<float>(h >> 8) * (1.f / 8388608.f) - 1.f;
+}
+
+template <bool Gradient>
+float lattice2(uint32_t seed, float x, float y)
+{
+    int32_t ix = fastFloor(x);
+    int32_t iy = fastFloor(y);
+    float fx = x - static_cast<float>(ix);
+    float fy = y - static_cast<float>(iy);
+    uint32_t x0 = static_cast<uint32_t>(ix) * PRIME_X, x1 = x0 + PRIME_X;
+    uint32_t y0 = static_cast<uint32_t>(iy) * PRIME_Y, y1 = y0 + PRIME_Y;
+    uint32_t h00 = mix(seed ^ x0 ^ y0), h10 = mix(seed ^ x1 ^ y0);
+    uint32_t h01 = mix(seed ^ x0 ^ y1), h11 = mix(seed ^ x1 ^ y1);
+
+    float n00, n10, n01, n11;
+    if (Gradient)
+    {
+        n00 = gradient(h00, fx, fy);
+        n10 = gradient(h10, fx - 1.f, fy);
+        n01 = gradient(h01, fx, fy - 1.f);
+        n11 = gradient(h11, fx - 1.f, fy - 1.f);
+    }
+    else
+    {
+        n00 = hashValue(h00);
+        n10 = hashValue(h10);
+        n01 = hashValue(h01);
+        n11 = hashValue(h11);
+    }
+    float u = fade(fx);
+    float v = fade(fy);
+    return lerp(lerp(n00, n10, u), lerp(n01, n11, u), v);
+}
+
+float simplex2(uint32_t seed, float x, float y)
+{
+    const float F2 = 0.36602540378f;  // (sqrt(3) - 1) / 2
+    const float G2 = 0.21132486540f;  // (3 - sqrt(3)) / 6
+
+    // Skew the space to find the simplex cell, and unskew its origin
+    float s = (x + y) * F2;
+    int32_t i = fastFloor(x + s);
+    int32_t j = fastFloor(y + s);
+    float t = static_cast<float>(i + j) * G2;
+    float x0 = x - (static_cast<float>(i) - t);
+    float y0 = y - (static_cast<float>(j) - t);
+
+    // The middle corner depends on which triangle of the cell the point is in
+    uint32_t i1 = x0 > y0 ? 1 : 0;
+    uint32_t j1 = 1 - i1;
+    float x1 = x0 - static_cast<float>(i1) + G2;
+    float y1 = y0 - static_cast<float>(j1) + G2;
+    float x2 = x0 - 1.f + 2.f * G2;
+    float y2 = y0 - 1.f + 2.f * G2;
+
+    uint32_t xp = static_cast<uint32_t>(i) * PRIME_X;
+    uint32_t yp = static_cast<uint32_t>(j) * PRIME_Y;
+    auto corner = [seed](uint32_t xh, uint32_t yh, float cx, float cy)
+    {
+        float falloff = 0.5f - cx * cx - cy * cy;
+        if (falloff <= 0.f)
+            return 0.f;
+        falloff *= falloff;
+        return falloff * falloff * gradient(mix(seed ^ xh ^ yh), cx, cy);
+    };
+    float n = corner(xp, yp, x0, y0)
+            + corner(xp + i1 * PRIME_X, yp + j1 * PRIME_Y, x1, y1)
+            + corner(xp + PRIME_X, yp + PRIME_Y, x2, y2);
+    return SIMPLEX2_SCALE * n;
+}
+
+template <bool Gradient>
+float lattice3(uint32_t seed, float x, float y, float z)
+{
+    int32_t ix = fastFloor(x), iy = fastFloor(y), iz = fastFloor(z);
+    float fx = x - static_cast<float>(ix);
+    float fy = y - static_cast<float>(iy);
+    float fz = z - static_cast<float>(iz);
+    uint32_t xs[2] = {static_cast<uint32_t>(ix) * PRIME_X, static_cast<uint32_t>(ix) * PRIME_X + PRIME_X};
+    uint32_t ys[2] = {static_cast<uint32_t>(iy) * PRIME_Y, static_cast<uint32_t>(iy) * PRIME_Y + PRIME_Y};
+    uint32_t zs[2] = {static_cast<uint32_t>(iz) * PRIME_Z, static_cast<uint32_t>(iz) * PRIME_Z + PRIME_Z};
+
+    float corners[2][2][2];
+    for (int dz = 0; dz < 2; ++dz)
+        for (int dy = 0; dy < 2; ++dy)
+            for (int dx = 0; dx < 2; ++dx)
+            {
+                uint32_t h = mix(seed ^ xs[dx] ^ ys[dy] ^ zs[dz]);
+                corners[dz][dy][dx] = Gradient ? gradient(h, fx - dx, fy - dy, fz - dz) : hashValue(h);
+            }
+
+    float u = fade(fx), v = fade(fy), w = fade(fz);
+    float front = lerp(lerp(corners[0][0][0], corners[0][0][1], u), lerp(corners[0][1][0], corners[0][1][1], u), v);
+    float back = lerp(lerp(corners[1][0][0], corners[1][0][1], u), lerp(corners[1][1][0], corners[1][1][1], u), v);
+    return lerp(front, back, w);
+}
+
+float simplex3(uint32_t seed, float x, float y, float z)
+{
+    const float F3 = 1.f / 3.f;
+    const float G3 = 1.f / 6.f;
+
+    float s = (x + y + z) * F3;
+    int32_t i = fastFloor(x + s), j = fastFloor(y + s), k = fastFloor(z + s);
+    float t = static_cast<float>(i + j + k) * G3;
+    float x0 = x - (static_cast<float>(i) - t);
+    float y0 = y - (static_cast<float>(j) - t);
+    float z0 = z - (static_cast<float>(k) - t);
+
+    // Offsets of the second and third corners, depending on the order of the coordinates
+    int i1, j1, k1, i2, j2, k2;
+    if (x0 >= y0)
+    {
+        if (y0 >= z0)      { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+        else if (x0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+        else               { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+    }
+    else
+    {
+        if (y0 < z0)       { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+        else if (x0 < z0)  { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+        else               { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+    }
+
+    uint32_t xp = static_cast<uint32_t>(i) * PRIME_X;
+    uint32_t yp = static_cast<uint32_t>(j) * PRIME_Y;
+    uint32_t zp = static_cast<uint32_t>(k) * PRIME_Z;
+    auto corner = [&](int di, int dj, int dk, float offset)
+    {
+        float cx = x0 - di + offset, cy = y0 - dj + offset, cz = z0 - dk + offset;
+        float falloff = 0.6f - cx * cx - cy * cy - cz * cz;
+        if (falloff <= 0.f)
+            return 0.f;
+        falloff *= falloff;
+        uint32_t h = mix(seed ^ (xp + di * PRIME_X) ^ (yp + dj * PRIME_Y) ^ (zp + dk * PRIME_Z));
+        return falloff * falloff * gradient(h, cx, cy, cz);
+    };
+    float n = corner(0, 0, 0, 0.f) + corner(i1, j1, k1, G3)
+            + corner(i2, j2, k2, 2.f * G3) + corner(1, 1, 1, 3.f * G3);
+    return SIMPLEX3_SCALE * n;
+}
+
+float basic3(NoiseSettings::Type type, uint32_t seed, float x, float y, float z)
+{
+    switch (type)
+    {
+        case NoiseSettings::Type::Value:
+            return lattice3<false>(seed, x, y, z);
+        case NoiseSettings::Type::Simplex:
+            return simplex3(seed, x, y, z);
+        default:
+            return lattice3<true>(seed, x, y, z);
+    }
+}
+
+template <bool Gradient>
+void lattice2Scalar(uint32_t seed, const float* xs, const float* ys, float* values, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        values[i] = lattice2<Gradient>(seed, xs[i], ys[i]);
+}
+
+#ifdef LZ_X86_SIMD
+// Vector versions of lattice2, which do the same operations in the same order
+// so that they give the same values
+
+__attribute__((target("sse2")))
+inline __m128i mullo(__m128i a, __m128i b)
+{
+    // SSE2 only multiplies the even lanes, so multiply the odd ones separately
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+__attribute__((target("sse2")))
+inline __m128i mix(__m128i h)
+{
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    h = mullo(h, _mm_set1_epi32(static_cast<int>(MIX_1)));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 12));
+    h = mullo(h, _mm_set1_epi32(static_cast<int>(MIX_2)));
+    return _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+}
+
+__attribute__((target("sse2")))
+inline __m128 fade(__m128 t)
+{
+    __m128 inner = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.f)), _mm_set1_ps(15.f));
+    inner = _mm_add_ps(_mm_mul_ps(t, inner), _mm_set1_ps(10.f));
+    return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+}
+
+__attribute__((target("sse2")))
+inline __m128 lerp(__m128 a, __m128 b, __m128 t)
+{
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+__attribute__((target("sse2")))
+inline __m128 gradient(__m128i h, __m128 x, __m128 y)
+{
+    // Flip the sign of each coordinate with a bit of the hash
+    __m128 signX = _mm_castsi128_ps(_mm_slli_epi32(h, 31));
+    __m128 signY = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(h, 1), 31));
+    return _mm_add_ps(_mm_xor_ps(x, signX), _mm_xor_ps(y, signY));
+}
+
+__attribute__((target("sse2")))
+inline __m128 hashValue(__m128i h)
+{
+    __m128 value = _mm_cvtepi32_ps(_mm_srli_epi32(h, 8));
+    return _mm_sub_ps(_mm_mul_ps(value, _mm_set1_ps(1.f / 8388608.f)), _mm_set1_ps(1.f));
+}
+
+template <bool Gradient>
+__attribute__((target("sse2")))
+void lattice2SSE2(uint32_t seed, const float* xs, const float* ys, float* values, size_t count)
+{
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128i seeds = _mm_set1_epi32(static_cast<int>(seed));
+    const __m128i primeX = _mm_set1_epi32(static_cast<int>(PRIME_X));
+    const __m128i primeY = _mm_set1_epi32(static_cast<int>(PRIME_Y));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+
+        // Floor, by truncating and correcting the negative numbers
+        __m128i ix = _mm_cvttps_epi32(x);
+        __m128i iy = _mm_cvttps_epi32(y);
+        __m128 floorX = _mm_cvtepi32_ps(ix);
+        __m128 floorY = _mm_cvtepi32_ps(iy);
+        __m128 aboveX = _mm_cmpgt_ps(floorX, x);
+        __m128 aboveY = _mm_cmpgt_ps(floorY, y);
+        floorX = _mm_sub_ps(floorX, _mm_and_ps(aboveX, one));
+        floorY = _mm_sub_ps(floorY, _mm_and_ps(aboveY, one));
+        ix = _mm_add_epi32(ix, _mm_castps_si128(aboveX));
+        iy = _mm_add_epi32(iy, _mm_castps_si128(aboveY));
+        __m128 fx = _mm_sub_ps(x, floorX);
+        __m128 fy = _mm_sub_ps(y, floorY);
+
+        __m128i x0 = mullo(ix, primeX), x1 = _mm_add_epi32(x0, primeX);
+        __m128i y0 = mullo(iy, primeY), y1 = _mm_add_epi32(y0, primeY);
+        __m128i h00 = mix(_mm_xor_si128(seeds, _mm_xor_si128(x0, y0)));
+        __m128i h10 = mix(_mm_xor_si128(seeds, _mm_xor_si128(x1, y0)));
+        __m128i h01 = mix(_mm_xor_si128(seeds, _mm_xor_si128(x0, y1)));
+        __m128i h11 = mix(_mm_xor_si128(seeds, _mm_xor_si128(x1, y1)));
+
+        __m128 n00, n10, n01, n11;
+        if (Gradient)
+        {
+            __m128 fx1 = _mm_sub_ps(fx, one);
+            __m128 fy1 = _mm_sub_ps(fy, one);
+            n00 = gradient(h00, fx, fy);
+            n10 = gradient(h10, fx1, fy);
+            n01 = gradient(h01, fx, fy1);
+            n11 = gradient(h11, fx1, fy1);
+        }
+        else
+        {
+            n00 = hashValue(h00);
+            n10 = hashValue(h10);
+            n01 = hashValue(h01);
+            n11 = hashValue(h11);
+        }
+        __m128 u = fade(fx);
+        __m128 v = fade(fy);
+        _mm_storeu_ps(values + i, lerp(lerp(n00, n10, u), lerp(n01, n11, u), v));
+    }
+    lattice2Scalar<Gradient>(seed, xs + i, ys + i, values + i, count - i);
+}
+
+__attribute__((target("avx2")))
+inline __m256i mix(__m256i h)
+{
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(MIX_1)));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 12));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(MIX_2)));
+    return _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+}
+
+__attribute__((target("avx2")))
+inline __m256 fade(__m256 t)
+{
+    __m256 inner = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.f)), _mm256_set1_ps(15.f));
+    inner = _mm256_add_ps(_mm256_mul_ps(t, inner), _mm256_set1_ps(10.f));
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+}
+
+__attribute__((target("avx2")))
+inline __m256 lerp(__m256 a, __m256 b, __m256 t)
+{
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+__attribute__((target("avx2")))
+inline __m256 gradient(__m256i h, __m256 x, __m256 y)
+{
+    __m256 signX = _mm256_castsi256_ps(_mm256_slli_epi32(h, 31));
+    __m256 signY = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_srli_epi32(h, 1), 31));
+    return _mm256_add_ps(_mm256_xor_ps(x, signX), _mm256_xor_ps(y, signY));
+}
+
+__attribute__((target("avx2")))
+inline __m256 hashValue(__m256i h)
+{
+    __m256 value = _mm256_cvtepi32_ps(_mm256_srli_epi32(h, 8));
+    return _mm256_sub_ps(_mm256_mul_ps(value, _mm256_set1_ps(1.f / 8388608.f)), _mm256_set1_ps(1.f));
+}
+
+template <bool Gradient>
+__attribute__((target("avx2")))
+void lattice2AVX2(uint32_t seed, const float* xs, const float* ys, float* values, size_t count)
+{
+    const __m256 one = _mm256_set1_ps(1.f);
+    const __m256i seeds = _mm256_set1_epi32(static_cast<int>(seed));
+    const __m256i primeX = _mm256_set1_epi32(static_cast<int>(PRIME_X));
+    const __m256i primeY = _mm256_set1_epi32(static_cast<int>(PRIME_Y));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 floorX = _mm256_floor_ps(x);
+        __m256 floorY = _mm256_floor_ps(y);
+        __m256i ix = _mm256_cvttps_epi32(floorX);
+        __m256i iy = _mm256_cvttps_epi32(floorY);
+        __m256 fx = _mm256_sub_ps(x, floorX);
+        __m256 fy = _mm256_sub_ps(y, floorY);
+
+        __m256i x0 = _mm256_mullo_epi32(ix, primeX), x1 = _mm256_add_epi32(x0, primeX);
+        __m256i y0 = _mm256_mullo_epi32(iy, primeY), y1 = _mm256_add_epi32(y0, primeY);
+        __m256i h00 = mix(_mm256_xor_si256(seeds, _mm256_xor_si256(x0, y0)));
+        __m256i h10 = mix(_mm256_xor_si256(seeds, _mm256_xor_si256(x1, y0)));
+        __m256i h01 = mix(_mm256_xor_si256(seeds, _mm256_xor_si256(x0, y1)));
+        __m256i h11 = mix(_mm256_xor_si256(seeds, _mm256_xor_si256(x1, y1)));
+
+        __m256 n00, n10, n01, n11;
+        if (Gradient)
+        {
+            __m256 fx1 = _mm256_sub_ps(fx, one);
+            __m256 fy1 = _mm256_sub_ps(fy, one);
+            n00 = gradient(h00, fx, fy);
+            n10 = gradient(h10, fx1, fy);
+            n01 = gradient(h01, fx, fy1);
+            n11 = gradient(h11, fx1, fy1);
+        }
+        else
+        {
+            n00 = hashValue(h00);
+            n10 = hashValue(h10);
+            n01 = hashValue(h01);
+            n11 = hashValue(h11);
+        }
+        __m256 u = fade(fx);
+        __m256 v = fade(fy);
+        _mm256_storeu_ps(values + i, lerp(lerp(n00, n10, u), lerp(n01, n11, u), v));
+    }
+    // Avoid the penalty of mixing AVX and legacy SSE code in the callers
+    _mm256_zeroupper();
+    lattice2SSE2<Gradient>(seed, xs + i, ys + i, values + i, count - i);
+}
+#endif
+
+template <bool Gradient>
+void lattice2(SimdLevel level, uint32_t seed, const float* xs, const float* ys,
+              float* values, size_t count)
+{
+#ifdef LZ_X86_SIMD
+    if (level == SimdLevel::AVX2)
+        return lattice2AVX2<Gradient>(seed, xs, ys, values, count);
+    if (level == SimdLevel::SSE2)
+        return lattice2SSE2<Gradient>(seed, xs, ys, values, count);
+#endif
+    lattice2Scalar<Gradient>(seed, xs, ys, values, count);
+}
+
+// Seeds of each octave, and of the noises that displace the coordinates
+inline uint32_t octaveSeed(uint32_t seed, unsigned octave)
+{
+    return seed + octave * 0x9E3779B9u;
+}
+
+inline uint32_t warpSeed(uint32_t seed, unsigned axis)
+{
+    return mix(seed ^ (0x68E31DA4u + axis));
+}
+}
+
+Noise::Noise(NoiseSettings settings)
+    : Noise(Random::range(0u, std::numeric_limits<unsigned>::max()), settings)
+{
+}
+
+Noise::Noise(unsigned seed, NoiseSettings settings)
+    : seed(seed)
+    , settings(settings)
+    , simdLevel(bestSimdLevel())
+{
+    // The octaves are averaged by their amplitudes, which would be a division by zero
+    if (settings.fractal != NoiseSettings::Fractal::None && settings.octaves == 0)
+        throw __lz::LazarusException("Fractal noises need at least one octave");
+}
+
+void Noise::setSimdLevel(SimdLevel level)
+{
+    simdLevel = std::min(level, bestSimdLevel());
+}
+
+float Noise::get(float x, float y) const
+{
+    float value;
+    fill(&x, &y, &value, 1);
+    return value;
+}
+
+float Noise::get(float x, float y, float z) const
+{
+    x *= settings.frequency;
+    y *= settings.frequency;
+    z *= settings.frequency;
+    if (settings.warp != 0.f)
+    {
+        float dx = basic3(settings.type, warpSeed(seed, 0), x, y, z);
+        float dy = basic3(settings.type, warpSeed(seed, 1), x, y, z);
+        float dz = basic3(settings.type, warpSeed(seed, 2), x, y, z);
+        x += settings.warp * dx;
+        y += settings.warp * dy;
+        z += settings.warp * dz;
+    }
+    if (settings.fractal == NoiseSettings::Fractal::None)
+        return basic3(settings.type, seed, x, y, z);
+
+    float sum = 0.f, amplitude = 1.f, totalAmplitude = 0.f, scale = 1.f;
+    for (unsigned octave = 0; octave < settings.octaves; ++octave)
+    {
+        float value = basic3(settings.type, octaveSeed(seed, octave), x * scale, y * scale, z * scale);
+        if (settings.fractal == NoiseSettings::Fractal::Ridged)
+        {
+            value = 1.f - std::fabs(value);
+            value *= value;
+        }
+        sum += value * amplitude;
+        totalAmplitude += amplitude;
+        amplitude *= settings.gain;
+        scale *= settings.lacunarity;
+    }
+    sum /= totalAmplitude;
+    return settings.fractal == NoiseSettings::Fractal::Ridged ? sum * 2.f - 1.f : sum;
+}
+
+void Noise::fill(const float* xs, const float* ys, float* values, size_t count) const
+{
+    float px[CHUNK_SIZE], py[CHUNK_SIZE];
+    float sx[CHUNK_SIZE], sy[CHUNK_SIZE];
+    float octave[CHUNK_SIZE], sum[CHUNK_SIZE];
+    for (size_t done = 0; done < count; done += CHUNK_SIZE)
+    {
+        size_t n = std::min(CHUNK_SIZE, count - done);
+        float* out = values + done;
+        for (size_t i = 0; i < n; ++i)
+        {
+            px[i] = xs[done + i] * settings.frequency;
+            py[i] = ys[done + i] * settings.frequency;
+        }
+        if (settings.warp != 0.f)
+        {
+            evaluate(px, py, sx, n, warpSeed(seed, 0));
+            evaluate(px, py, sy, n, warpSeed(seed, 1));
+            for (size_t i = 0; i < n; ++i)
+            {
+                px[i] += settings.warp * sx[i];
+                py[i] += settings.warp * sy[i];
+            }
+        }
+        if (settings.fractal == NoiseSettings::Fractal::None)
+        {
+            evaluate(px, py, out, n, seed);
+            continue;
+        }
+
+        bool ridged = settings.fractal == NoiseSettings::Fractal::Ridged;
+        float amplitude = 1.f, totalAmplitude = 0.f, scale = 1.f;
+        std::fill(sum, sum + n, 0.f);
+        for (unsigned o = 0; o < settings.octaves; ++o)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                sx[i] = px[i] * scale;
+                sy[i] = py[i] * scale;
+            }
+            evaluate(sx, sy, octave, n, octaveSeed(seed, o));
+            for (size_t i = 0; i < n; ++i)
+            {
+                float value = octave[i];
+                if (ridged)
+                {
+                    value = 1.f - std::fabs(value);
+                    value *= value;
+                }
+                sum[i] += value * amplitude;
+            }
+            totalAmplitude += amplitude;
+            amplitude *= settings.gain;
+            scale *= settings.lacunarity;
+        }
+        for (size_t i = 0; i < n; ++i)
+            out[i] = ridged ? sum[i] / totalAmplitude * 2.f - 1.f : sum[i] / totalAmplitude;
+    }
+}
+
+void Noise::fillRow(float* values, size_t count, float x, float y, float step) const
+{
+    float xs[CHUNK_SIZE], ys[CHUNK_SIZE];
+    std::fill(ys, ys + CHUNK_SIZE, y);
+    for (size_t done = 0; done < count; done += CHUNK_SIZE)
+    {
+        size_t n = std::min(CHUNK_SIZE, count - done);
+        for (size_t i = 0; i < n; ++i)
+            xs[i] = x + static_cast<float>(done + i) * step;
+        fill(xs, ys, values + done, n);
+    }
+}
+
+void Noise::fillTile(float* values, size_t width, size_t height, float x, float y,
+                     float step, JobSystem* jobs) const
+{
+    auto fillTileRow = [=](size_t row)
+    {
+        fillRow(values + row * width, width, x, y + static_cast<float>(row) * step, step);
+    };
+    if (jobs == nullptr)
+    {
+        for (size_t row = 0; row < height; ++row)
+            fillTileRow(row);
+        return;
+    }
+    size_t rowsPerJob = std::max<size_t>(1, CELLS_PER_JOB / std::max<size_t>(width, 1));
+    jobs->parallelFor(0, height, rowsPerJob, fillTileRow);
+}
+
+void Noise::evaluate(const float* xs, const float* ys, float* values, size_t count,
+                     uint32_t octaveSeed) const
+{
+    switch (settings.type)
+    {
+        case NoiseSettings::Type::Value:
+            lattice2<false>(simdLevel, octaveSeed, xs, ys, values, count);
+            break;
+        case NoiseSettings::Type::Perlin:
+            lattice2<true>(simdLevel, octaveSeed, xs, ys, values, count);
+            break;
+        case NoiseSettings::Type::Simplex:
+            for (size_t i = 0; i < count; ++i)
+                values[i] = simplex2(octaveSeed, xs[i], ys[i]);
+            break;
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <lazarus/Simd.h>
+
+namespace lz
+{
+class JobSystem;
+
+/**
+ * Parameters of a noise function.
+ *
+ * @see Noise
+ */
+struct NoiseSettings
+{
+    /**
+     * The basic noise functions.
+     */
+    enum class Type
+    {
+        Value,      // Interpolated random values on a grid, blocky but cheap
+        Perlin,     // Gradient noise on a square grid
+        Simplex     // Gradient noise on a simplex grid, with fewer artifacts
+    };
+
+    /**
+     * The ways octaves of the noise are combined.
+     */
+    enum class Fractal
+    {
+        None,       // A single octave
+        FBm,        // Fractal brownian motion, the sum of the octaves
+        Ridged      // Sum of the inverted absolute values of the octaves
+    };
+
+    Type type = Type::Perlin;
+    Fractal fractal = Fractal::None;
+    // Number of octaves of the fractals, at least 1
+    unsigned octaves = 4;
+    // Scale of the coordinates of the first octave
+    float frequency = 1.f;
+    // Frequency multiplier between octaves
+    float lacunarity = 2.f;
+    // Amplitude multiplier between octaves
+    float gain = 0.5f;
+    // Distance the coordinates are displaced by another noise, or 0 for no domain warp
+    float warp = 0.f;
+};
+
+/**
+ * Coherent noise, for generating terrain, caves or textures.
+ *
+ * A noise is a function of the coordinates that changes smoothly, and which is
+ * determined by a seed. Its values are roughly in [-1, 1].
+ *
+ * Whole rows and tiles can be generated at once with fill, fillRow and
+ * fillTile, which evaluate several cells at a time with SSE2 or AVX2 for the
+ * 2D value and Perlin noises. Tiles can also be split among the threads of a
+ * JobSystem. The values are the same as those of get for each cell.
+ *
+ * @see NoiseSettings
+ */
+class Noise
+{
+public:
+    /**
+     * Creates a noise with the given settings, seeded with lz::Random.
+     */
+    explicit Noise(NoiseSettings settings=NoiseSettings());
+
+    /**
+     * Creates a noise with the given seed and settings.
+     */
+    Noise(unsigned seed, NoiseSettings settings);
+
+    /**
+     * Returns the seed of the noise.
+     */
+    unsigned getSeed() const { return seed; }
+
+    /**
+     * Returns the settings of the noise.
+     */
+    const NoiseSettings& getSettings() const { return settings; }
+
+    /**
+     * Returns the value of the 2D noise at the given point.
+     */
+    float get(float x, float y) const;
+
+    /**
+     * Returns the value of the 3D noise at the given point.
+     */
+    float get(float x, float y, float z) const;
+
+    /**
+     * Evaluates the 2D noise at count points, given by their coordinates.
+     */
+    void fill(const float* xs, const float* ys, float* values, size_t count) const;
+
+    /**
+     * Evaluates the 2D noise at count points along a row, starting at (x, y)
+     * and separated by the given step.
+     */
+    void fillRow(float* values, size_t count, float x, float y, float step=1.f) const;
+
+    /**
+     * Evaluates the 2D noise on a grid of width by height points, starting at
+     * (x, y) and separated by the given step, and stores it row by row.
+     *
+     * If a job system is given, the rows are split among its threads.
+     */
+    void fillTile(float* values, size_t width, size_t height, float x, float y,
+                  float step=1.f, JobSystem* jobs=nullptr) const;
+
+    /**
+     * Sets the instruction set used to evaluate rows and tiles.
+     *
+     * Instruction sets that the processor does not support fall back to the
+     * best supported one. This is meant for testing and benchmarking, since
+     * the best one is selected by default.
+     */
+    void setSimdLevel(SimdLevel level);
+
+    /**
+     * Returns the instruction set used to evaluate rows and tiles.
+     */
+    SimdLevel getSimdLevel() const { return simdLevel; }
+
+private:
+    // Evaluates a single octave of the basic noise
+    void evaluate(const float* xs, const float* ys, float* values, size_t count,
+                  uint32_t octaveSeed) const;
+
+private:
+    unsigned seed;
+    NoiseSettings settings;
+    SimdLevel simdLevel;
+};
+}  // namespace lz
@@ -0,0 +1,307 @@
+#include <lazarus/PoissonDisk.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <lazarus/Random.h>
+
+using namespace lz;
+
+const unsigned PoissonDisk::DEFAULT_ATTEMPTS;
+
+namespace
+{
+using Point = PoissonDisk::Point;
+
+// Coordinates of the empty cells
+const float FAR_AWAY = -1e9f;
+
+// Bridson's algorithm over a grid of cells small enough to hold a single point
+class Sampler
+{
+public:
+    // Samples a rectangle, or a torus of the given size if wrap is set, so
+    // that the points keep their distances across the edges
+    Sampler(float width, float height, float minRadius, float maxRadius,
+            const PoissonDisk::RadiusFunction& radius, const PoissonDisk::Mask& passable,
+            unsigned attempts, bool wrap, unsigned seed)
+        : width(width)
+        , height(height)
+        , minRadius(minRadius)
+        , maxRadius(maxRadius)
+        , radius(radius)
+        , passable(passable)
+        , attempts(attempts)
+        , wrap(wrap)
+        , engine(seed)
+    {
+        // Any two points in a cell are closer than its diagonal, the minimum radius
+        float cellSize = minRadius / std::sqrt(2.f);
+        gridWidth = static_cast<int>(std::ceil(width / cellSize));
+        gridHeight = static_cast<int>(std::ceil(height / cellSize));
+        // On a torus the cells must divide the size exactly, or the cells
+        // across the edges would be closer than the reach
+        cellWidth = wrap ? width / gridWidth : cellSize;
+        cellHeight = wrap ? height / gridHeight : cellSize;
+        reach = static_cast<int>(std::ceil(maxRadius / std::min(cellWidth, cellHeight)));
+        grid.assign(static_cast<size_t>(gridWidth) * gridHeight, Cell{FAR_AWAY, FAR_AWAY, 0.f});
+    }
+
+    std::vector<Point> run()
+    {
+        // Start from a random point
+        for (unsigned i = 0; i < attempts; ++i)
+        {
+            Point point{uniform() * width, uniform() * height};
+            if (tryAdd(point))
+            {
+                grow();
+                break;
+            }
+        }
+
+        // Seed the passable areas that the growth could not reach, trying a
+        // point in each empty cell, which is enough to find any area bigger
+        // than a couple of cells
+        for (int cy = 0; cy < gridHeight; ++cy)
+            for (int cx = 0; cx < gridWidth; ++cx)
+            {
+                if (grid[cy * gridWidth + cx].radius > 0.f)
+                    continue;
+                Point point{std::min((cx + uniform()) * cellWidth, std::nextafter(width, 0.f)),
+                            std::min((cy + uniform()) * cellHeight, std::nextafter(height, 0.f))};
+                if (tryAdd(point))
+                    grow();
+            }
+        return std::move(points);
+    }
+
+private:
+    // Tries candidates around the active points until none of them has room left
+    void grow()
+    {
+        while (!active.empty())
+        {
+            size_t i = static_cast<size_t>(__lz::boundedRandom(engine, active.size()));
+            const Cell& cell = grid[active[i]];
+            Point center{cell.x, cell.y};
+            float r = cell.radius;
+
+            bool added = false;
+            for (unsigned attempt = 0; attempt < attempts && !added; ++attempt)
+            {
+                // Candidates are uniform in the ring between the radius and
+                // twice the radius, drawn from the square around it
+                float dx, dy, squared;
+                do
+                {
+                    dx = (uniform() * 4.f - 2.f) * r;
+                    dy = (uniform() * 4.f - 2.f) * r;
+                    squared = dx * dx + dy * dy;
+                }
+                while (squared < r * r || squared >= 4.f * r * r);
+                Point candidate{center.x + dx, center.y + dy};
+                if (wrap)
+                    candidate = Point{wrapCoordinate(candidate.x, width), wrapCoordinate(candidate.y, height)};
+                else if (candidate.x < 0.f || candidate.x >= width
+                         || candidate.y < 0.f || candidate.y >= height)
+                    continue;
+                added = tryAdd(candidate);
+            }
+            if (!added)
+            {
+                active[i] = active.back();
+                active.pop_back();
+            }
+        }
+    }
+
+    // Adds the point if it is passable and far enough from the others
+    bool tryAdd(Point point)
+    {
+        if (passable && !passable(static_cast<int>(point.x), static_cast<int>(point.y)))
+            return false;
+        float r = minRadius;
+        if (radius)
+            r = std::min(std::max(radius(point.x, point.y), minRadius), maxRadius);
+        if (!fits(point, r))
+            return false;
+
+        int index = cellY(point.y) * gridWidth + cellX(point.x);
+        points.push_back(point);
+        grid[index] = Cell{point.x, point.y, r};
+        active.push_back(index);
+        return true;
+    }
+
+    bool fits(Point point, float r) const
+    {
+        return wrap ? fitsOn<true>(point, r) : fitsOn<false>(point, r);
+    }
+
+    template <bool Wrap>
+    bool fitsOn(Point point, float r) const
+    {
+        int cx = cellX(point.x), cy = cellY(point.y);
+        // Most candidates that fail land on a cell that is already taken
+        if (grid[static_cast<size_t>(cy) * gridWidth + cx].radius > 0.f)
+            return false;
+
+        int minX = cx - reach, maxX = cx + reach;
+        int minY = cy - reach, maxY = cy + reach;
+        if (!Wrap)
+        {
+            minX = std::max(minX, 0);
+            maxX = std::min(maxX, gridWidth - 1);
+            minY = std::max(minY, 0);
+            maxY = std::min(maxY, gridHeight - 1);
+        }
+
+        // Empty cells are far away from any point, which avoids branching on them
+        bool tooClose = false;
+        for (int y = minY; y <= maxY && !tooClose; ++y)
+        {
+            int row = Wrap ? (y % gridHeight + gridHeight) % gridHeight : y;
+            const Cell* cells = grid.data() + static_cast<size_t>(row) * gridWidth;
+            for (int x = minX; x <= maxX; ++x)
+            {
+                const Cell& other = cells[Wrap ? (x % gridWidth + gridWidth) % gridWidth : x];
+                float dx = std::abs(other.x - point.x);
+                float dy = std::abs(other.y - point.y);
+                if (Wrap)
+                {
+                    dx = std::min(dx, width - dx);
+                    dy = std::min(dy, height - dy);
+                }
+                float limit = std::max(r, other.radius);
+                tooClose |= dx * dx + dy * dy < limit * limit;
+            }
+        }
+        return !tooClose;
+    }
+
+    int cellX(float x) const { return std::min(static_cast<int>(x / cellWidth), gridWidth - 1); }
+    int cellY(float y) const { return std::min(static_cast<int>(y / cellHeight), gridHeight - 1); }
+
+    static float wrapCoordinate(float value, float size)
+    {
+        value -= std::floor(value / size) * size;
+        return value < size ? value : 0.f;
+    }
+
+    // Returns a random float in [0, 1), with the 24 bits of precision of a float
+    float uniform() { return (engine() >> 8) * (1.f / 16777216.f); }
+
+private:
+    float width;
+    float height;
+    float minRadius;
+    float maxRadius;
+    const PoissonDisk::RadiusFunction& radius;
+    const PoissonDisk::Mask& passable;
+    unsigned attempts;
+    bool wrap;
+    Pcg32 engine;
+
+    float cellWidth;
+    float cellHeight;
+    int gridWidth;
+    int gridHeight;
+    // Number of cells around a point that can hold points too close to it
+    int reach;
+    // The point in each cell, with its radius, which is 0 for empty cells
+    struct Cell
+    {
+        float x;
+        float y;
+        float radius;
+    };
+
+    std::vector<Cell> grid;
+    std::vector<Point> points;
+    // Cells of the points that may still have room around them
+    std::vector<int> active;
+};
+
+unsigned randomSeed()
+{
+    return Random::range(0u, std::numeric_limits<unsigned>::max());
+}
+}
+
+PoissonDisk::PoissonDisk(int width, int height, float radius)
+    : PoissonDisk(width, height, radius, radius, RadiusFunction())
+{
+}
+
+PoissonDisk::PoissonDisk(int width, int height, float minRadius, float maxRadius,
+                         RadiusFunction radius)
+    : width(width)
+    , height(height)
+    , minRadius(minRadius)
+    , maxRadius(maxRadius)
+    , radius(std::move(radius))
+{
+    if (width <= 0 || height <= 0)
+        throw __lz::LazarusException("The size of the map must be positive");
+    if (!(minRadius > 0.f) || maxRadius < minRadius)
+        throw __lz::LazarusException("The radii must be positive, and the minimum no greater than the maximum");
+}
+
+void PoissonDisk::setAttempts(unsigned attempts)
+{
+    this->attempts = std::max(attempts, 1u);
+}
+
+std::vector<PoissonDisk::Point> PoissonDisk::generate() const
+{
+    return generate(randomSeed());
+}
+
+std::vector<PoissonDisk::Point> PoissonDisk::generate(unsigned seed) const
+{
+    Sampler sampler(static_cast<float>(width), static_cast<float>(height), minRadius, maxRadius,
+                    radius, passable, attempts, false, seed);
+    return sampler.run();
+}
+
+BlueNoiseTile::BlueNoiseTile(int size, float radius)
+    : BlueNoiseTile(size, radius, randomSeed())
+{
+}
+
+BlueNoiseTile::BlueNoiseTile(int size, float radius, unsigned seed)
+    : size(size)
+    , radius(radius)
+{
+    if (!(radius > 0.f) || size < 2 * radius)
+        throw __lz::LazarusException("The size of a tile must be at least twice its radius");
+
+    Sampler sampler(static_cast<float>(size), static_cast<float>(size), radius, radius,
+                    PoissonDisk::RadiusFunction(), PoissonDisk::Mask(),
+                    PoissonDisk::DEFAULT_ATTEMPTS, true, seed);
+    points = sampler.run();
+}
+
+std::vector<PoissonDisk::Point> BlueNoiseTile::fill(int width, int height,
+                                                    const PoissonDisk::Mask& passable,
+                                                    int offsetX, int offsetY) const
+{
+    offsetX = (offsetX % size + size) % size;
+    offsetY = (offsetY % size + size) % size;
+
+    std::vector<PoissonDisk::Point> placed;
+    for (int tileY = -offsetY; tileY < height; tileY += size)
+        for (int tileX = -offsetX; tileX < width; tileX += size)
+            for (const PoissonDisk::Point& point : points)
+            {
+                PoissonDisk::Point moved{point.x + tileX, point.y + tileY};
+                if (moved.x < 0.f || moved.y < 0.f || moved.x >= width || moved.y >= height)
+                    continue;
+                if (passable && !passable(static_cast<int>(moved.x), static_cast<int>(moved.y)))
+                    continue;
+                placed.push_back(moved);
+            }
+    return placed;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+namespace lz
+{
+/**
+ * Places points on a map so that no two of them are closer than a radius,
+ * for spreading items, monsters or vegetation evenly without clumps.
+ *
+ * The points are generated with Bridson's algorithm, which grows the set from
+ * the points already placed and looks up their neighbours in a grid, so it
+ * takes linear time in the number of points no matter how dense the map is.
+ *
+ * Points can be restricted to the passable cells of the map with a mask, and
+ * the radius can change over the map, for example to make loot scarcer far
+ * from the entrance. Passable areas that are not connected are filled as well.
+ *
+ * For placing many sets of points with the same radius, a BlueNoiseTile is
+ * even cheaper.
+ *
+ * @see BlueNoiseTile
+ */
+class PoissonDisk
+{
+public:
+    /**
+     * A point of the map. The cell of the point is given by the integer part
+     * of its coordinates.
+     */
+    struct Point
+    {
+        float x;
+        float y;
+    };
+
+    /**
+     * Returns whether the given cell of the map can hold points.
+     */
+    using Mask = std::function<bool(int x, int y)>;
+
+    /**
+     * Returns the radius around the given point.
+     */
+    using RadiusFunction = std::function<float(float x, float y)>;
+
+    /**
+     * Number of candidates tried around each point by default.
+     */
+    static const unsigned DEFAULT_ATTEMPTS = 30;
+
+    /**
+     * Creates a sampler for a map of the given size, with a constant radius.
+     */
+    PoissonDisk(int width, int height, float radius);
+
+    /**
+     * Creates a sampler for a map of the given size, where the radius around
+     * each point is given by a function. The values of the function are
+     * clamped to [minRadius, maxRadius], and two points must be as far apart
+     * as the larger of their radii.
+     *
+     * The time taken grows with the ratio between the radii, so they should
+     * not be further apart than needed.
+     */
+    PoissonDisk(int width, int height, float minRadius, float maxRadius, RadiusFunction radius);
+
+    /**
+     * Sets the mask of the cells that can hold points, or an empty function
+     * to allow every cell.
+     */
+    void setMask(Mask passable) { this->passable = std::move(passable); }
+
+    /**
+     * Sets the number of candidates tried around each point before giving up
+     * on it. Fewer attempts are faster, but leave more gaps.
+     */
+    void setAttempts(unsigned attempts);
+
+    /**
+     * Returns the number of candidates tried around each point.
+     */
+    unsigned getAttempts() const { return attempts; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    float getMinRadius() const { return minRadius; }
+    float getMaxRadius() const { return maxRadius; }
+
+    /**
+     * Generates the points, seeded with lz::Random.
+     */
+    std::vector<Point> generate() const;
+
+    /**
+     * Generates the points for the given seed. The same seed gives the same
+     * points on every platform, as long as the mask and radius functions give
+     * the same results.
+     */
+    std::vector<Point> generate(unsigned seed) const;
+
+private:
+    int width;
+    int height;
+    float minRadius;
+    float maxRadius;
+    RadiusFunction radius;
+    Mask passable;
+    unsigned attempts = DEFAULT_ATTEMPTS;
+};
+
+/**
+ * A square tile of points at least a radius apart, also across its edges,
+ * which can be repeated to cover a map of any size.
+ *
+ * Building the tile is as expensive as sampling a PoissonDisk of its size,
+ * but then placing its points on a map only takes a pass over them, so a tile
+ * can be built once and reused for every level. The repetition can be hidden
+ * by placing the tiles with a different offset on each map, and by making the
+ * tile several times bigger than the radius.
+ *
+ * @see PoissonDisk
+ */
+class BlueNoiseTile
+{
+public:
+    /**
+     * Builds a tile of the given size, seeded with lz::Random.
+     */
+    BlueNoiseTile(int size, float radius);
+
+    /**
+     * Builds a tile of the given size for the given seed.
+     */
+    BlueNoiseTile(int size, float radius, unsigned seed);
+
+    int getSize() const { return size; }
+    float getRadius() const { return radius; }
+
+    /**
+     * Returns the points of a single tile, in [0, size).
+     */
+    const std::vector<PoissonDisk::Point>& getPoints() const { return points; }
+
+    /**
+     * Covers a map of the given size with copies of the tile, and returns the
+     * points that fall on passable cells.
+     *
+     * The first tile starts at minus the given offset, which is reduced to the
+     * size of the tile.
+     */
+    std::vector<PoissonDisk::Point> fill(int width, int height,
+                                         const PoissonDisk::Mask& passable=PoissonDisk::Mask(),
+                                         int offsetX=0, int offsetY=0) const;
+
+private:
+    int size;
+    float radius;
+    std::vector<PoissonDisk::Point> points;
+};
+}  // namespace lz
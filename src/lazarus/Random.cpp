@@ -6,51 +6,102 @@
 
 using namespace lz;
 
-std::mt19937 Random::generator;  // Initialize with default seed (5489u)
-
-void Random::seed()
+unsigned __lz::randomSeed()
 {
     try
     {
         // Use a random device if available
         std::random_device randomDevice;
-        generator.seed(randomDevice());
+        return randomDevice();
     }
     catch (const std::exception &e)
     {
         // Random device not available, use a time seed
-        unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-        generator.seed(seed);
+        return std::chrono::system_clock::now().time_since_epoch().count();
     }
 }
 
+Random::Engine Random::engine = Random::Engine::Mt19937;
+RandomGenerator Random::generator;  // Initialize with default seed (5489u)
+BasicRandomGenerator<Xoshiro256StarStar> Random::xoshiroGenerator;
+BasicRandomGenerator<Pcg32> Random::pcgGenerator;
+BasicRandomGenerator<SplitMix64> Random::splitMixGenerator;
+
+void Random::setEngine(Engine engine)
+{
+    unsigned seed = getSeed();
+    Random::engine = engine;
+    Random::seed(seed);
+}
+
+void Random::seed()
+{
+    seed(__lz::randomSeed());
+}
+
 void Random::seed(unsigned seed)
 {
-    generator.seed(seed);
+    visit([seed](auto& generator) { generator.seed(seed); });
+}
+
+unsigned Random::getSeed()
+{
+    return visit([](auto& generator) { return generator.getSeed(); });
+}
+
+static_assert(BasicRandomGenerator<Xoshiro256StarStar>::STATE_SIZE <= RandomGenerator::STATE_SIZE
+              && BasicRandomGenerator<Pcg32>::STATE_SIZE <= RandomGenerator::STATE_SIZE
+              && BasicRandomGenerator<SplitMix64>::STATE_SIZE <= RandomGenerator::STATE_SIZE,
+              "Random::State must fit the state of every engine");
+
+Random::State Random::saveState()
+{
+    State state{};
+    state[0] = static_cast<uint8_t>(engine);
+    visit([&state](auto& generator)
+    {
+        auto generatorState = generator.saveState();
+        std::copy(generatorState.begin(), generatorState.end(), state.begin() + 1);
+    });
+    return state;
+}
+
+void Random::loadState(const State& state)
+{
+    if (state[0] > static_cast<uint8_t>(Engine::SplitMix64))
+        throw __lz::LazarusException("Invalid random state");
+
+    engine = static_cast<Engine>(state[0]);
+    visit([&state](auto& generator)
+    {
+        typename std::remove_reference_t<decltype(generator)>::State generatorState;
+        std::copy(state.begin() + 1, state.begin() + 1 + generatorState.size(),
+                  generatorState.begin());
+        generator.loadState(generatorState);
+    });
+}
+
+void Random::discard(unsigned long long n)
+{
+    visit([n](auto& generator) { generator.discard(n); });
+}
+
+std::vector<size_t> Random::sampleIndices(size_t n, size_t k)
+{
+    return visit([=](auto& generator) { return generator.sampleIndices(n, k); });
 }
 
 ulong Random::roll(unsigned sides, unsigned times)
 {
-    if (sides == 1)
-        return times;
-    if (sides == 0 || times == 0)
-        return 0;
-    std::uniform_int_distribution<unsigned> dist(1, sides);
-    ulong total = 0;
-    for (unsigned t = 0; t < times; ++t)
-        total += dist(generator);
-    return total;
+    return visit([=](auto& generator) { return generator.roll(sides, times); });
 }
 
 bool Random::oneIn(unsigned n)
 {
-    if (n < 2)
-        return true;
-    return Random::range(static_cast<unsigned>(1), n) == 1;
+    return visit([n](auto& generator) { return generator.oneIn(n); });
 }
 
 double Random::normal(double mean, double stdev)
 {
-    std::normal_distribution<double> dist(mean, stdev);
-    return dist(generator);
+    return visit([=](auto& generator) { return generator.normal(mean, stdev); });
 }
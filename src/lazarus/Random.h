@@ -1,30 +1,644 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <sstream>
 #include <stdexcept>
 #include <random>
 #include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <lazarus/common.h>
+#include <lazarus/RandomEngines.h>
+
+namespace __lz  // Meant for internal use only
+{
+// Finalizer of the SplitMix64 generator, which scrambles the bits of a 64 bit value
+inline uint64_t mix64(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// Returns a seed from a hardware random device if available, or from the current time
+unsigned randomSeed();
+
+// Saves and loads the state of an engine, for the engines of RandomEngines.h
+template <typename Engine>
+struct EngineState
+{
+    static const size_t SIZE = Engine::STATE_SIZE;
+
+    static void save(const Engine& engine, uint8_t* data) { engine.saveState(data); }
+    static void load(Engine& engine, const uint8_t* data) { engine.loadState(data); }
+};
+
+// The state of std::mt19937 is only accessible through its text representation,
+// which holds the 624 words of the state, followed by the position in them with
+// some standard libraries
+template <>
+struct EngineState<std::mt19937>
+{
+    static const size_t WORDS = std::mt19937::state_size + 1;
+    static const size_t SIZE = WORDS * 4;
+    // Marks the absence of the position
+    static const uint32_t NONE = 0xFFFFFFFF;
+
+    static void save(const std::mt19937& engine, uint8_t* data)
+    {
+        std::stringstream stream;
+        stream << engine;
+        for (size_t i = 0; i < WORDS; ++i)
+        {
+            uint32_t word = NONE;
+            stream >> word;
+            storeLittleEndian(data + 4 * i, word);
+        }
+    }
+
+    static void load(std::mt19937& engine, const uint8_t* data)
+    {
+        std::stringstream stream;
+        for (size_t i = 0; i < WORDS; ++i)
+        {
+            uint32_t word = loadLittleEndian<uint32_t>(data + 4 * i);
+            if (i < WORDS - 1 || word != NONE)
+                stream << word << ' ';
+        }
+        stream >> engine;
+    }
+};
+
+// Advances the iterator by count items, or up to last if there are fewer,
+// in constant time for random access iterators
+template <typename It>
+void advanceAtMost(It& it, It last, uint64_t count, std::input_iterator_tag)
+{
+    for (; count > 0 && it != last; --count)
+        ++it;
+}
+
+template <typename It>
+void advanceAtMost(It& it, It last, uint64_t count, std::random_access_iterator_tag)
+{
+    it += static_cast<typename std::iterator_traits<It>::difference_type>(
+        std::min<uint64_t>(count, static_cast<uint64_t>(last - it)));
+}
+
+template <typename It>
+void advanceAtMost(It& it, It last, uint64_t count)
+{
+    advanceAtMost(it, last, count, typename std::iterator_traits<It>::iterator_category());
+}
+
+// Returns a random integer in [0, bound), for a bound greater than 0.
+// Uses Lemire's multiply and shift, which only needs a division in the rare
+// cases where the result could be biased. Engines that do not give 32 random
+// bits, and bounds above 2^32, go through the standard distribution instead
+template <typename Engine>
+uint64_t boundedRandom(Engine& engine, uint64_t bound)
+{
+    const bool fullWords = Engine::min() == 0 && Engine::max() >= 0xFFFFFFFFu;
+    if (!fullWords || bound > (uint64_t(1) << 32))
+        return std::uniform_int_distribution<uint64_t>(0, bound - 1)(engine);
+
+    uint64_t product = static_cast<uint32_t>(engine()) * bound;
+    if (static_cast<uint32_t>(product) < bound)
+    {
+        // Words below the threshold would make some results more likely than others
+        uint32_t threshold = static_cast<uint32_t>((uint64_t(1) << 32) % bound);
+        while (static_cast<uint32_t>(product) < threshold)
+            product = static_cast<uint32_t>(engine()) * bound;
+    }
+    return product >> 32;
+}
+
+template <typename T, typename U>
+using EnableIfIntegral = std::enable_if_t<
+    (std::is_integral<T>::value || std::is_unsigned<T>::value)
+    && (std::is_integral<U>::value || std::is_unsigned<U>::value)>;
+
+template <typename T, typename U>
+using EnableIfFloating = std::enable_if_t<
+    std::is_floating_point<T>::value || std::is_floating_point<U>::value>;
+}
 
 namespace lz
 {
+/**
+ * A random number generator with its own state.
+ *
+ * Each generator object is an independent stream of random numbers, which
+ * provides the same functionality as the static methods of lz::Random.
+ * Unlike those, separate generators can be used from different threads, and
+ * do not interfere with each other's sequences.
+ *
+ * A generator can be split into child generators, each identified by a stream
+ * number. The seed of a child is derived from the seed of its parent and the
+ * stream number, so a whole tree of generators can be reproduced from a single
+ * master seed.
+ *
+ * The engine that produces the random bits is given as a template parameter,
+ * and can be any standard engine or one of the engines in RandomEngines.h.
+ * The small engines, such as Xoshiro256StarStar, are much cheaper to seed and
+ * to copy than the default std::mt19937, which makes them more suitable for
+ * keeping a generator per entity or per job.
+ *
+ * The state of a generator can be saved to a fixed-size State and restored
+ * later, for save games, replays or trying moves ahead in an AI. The saved
+ * bytes do not depend on the platform, except for std::mt19937 whose state is
+ * only compatible between builds with the same standard library. Saving and
+ * loading the state of std::mt19937 goes through its text representation and
+ * takes a fraction of a millisecond, while it only takes tens of nanoseconds with
+ * the engines of RandomEngines.h, so those are better for frequent snapshots.
+ *
+ * @see RandomGenerator
+ * @see Random
+ */
+template <typename Engine>
+class BasicRandomGenerator
+{
+public:
+    using engine_type = Engine;
+
+    /**
+     * Size in bytes of the saved state of the generator.
+     */
+    static const size_t STATE_SIZE = 4 + __lz::EngineState<Engine>::SIZE;
+
+    /**
+     * The saved state of a generator, which includes its seed.
+     */
+    using State = std::array<uint8_t, STATE_SIZE>;
+
+    /**
+     * Creates a generator with the given seed.
+     */
+    explicit BasicRandomGenerator(unsigned seed=static_cast<unsigned>(Engine::default_seed));
+
+    /**
+     * Creates a generator that draws from a copy of the given engine, which
+     * was seeded with the given seed.
+     */
+    BasicRandomGenerator(const Engine& engine, unsigned seed);
+
+    /**
+     * Sets a new seed for the generator using a hardware random device if
+     * available, or a seed using the current time.
+     */
+    void seed();
+
+    /**
+     * Sets the generator to use the given seed.
+     *
+     * Note that using the same seed will produce the same sequences of random
+     * numbers in different executions.
+     */
+    void seed(unsigned seed);
+
+    /**
+     * Returns the last seed used for the generator.
+     */
+    unsigned getSeed() const { return lastSeed; }
+
+    /**
+     * Returns a new generator for the given stream, seeded from the seed of this one.
+     *
+     * Splitting a generator does not advance it, and splitting generators with
+     * the same seed with the same stream number gives the same child.
+     */
+    BasicRandomGenerator split(uint64_t stream) const;
+
+    /**
+     * Returns the current state of the generator.
+     *
+     * Loading the state later makes the generator produce the same numbers
+     * again from that point.
+     */
+    State saveState() const;
+
+    /**
+     * Restores a state previously returned by saveState.
+     */
+    void loadState(const State& state);
+
+    /**
+     * Advances the generator as if n values of its engine had been drawn.
+     *
+     * This takes logarithmic or constant time with Pcg32, SplitMix64 and
+     * Philox4x32, and linear time with the other engines.
+     */
+    void discard(unsigned long long n) { engine.discard(n); }
+
+    /**
+     * Return a random integral between the two given numbers with equal probability.
+     *
+     * @see Random::range
+     */
+    template <typename T, typename U, __lz::EnableIfIntegral<T, U>* = nullptr>
+    typename std::common_type<T, U>::type range(T a, U b);
+
+    /**
+     * Return a random floating point number between the two given numbers
+     * with equal probability.
+     *
+     * @see Random::range
+     */
+    template <typename T, typename U, __lz::EnableIfFloating<T, U>* = nullptr>
+    typename std::common_type<T, U>::type range(T a, U b);
+
+    /**
+     * Rolls a dice with the specified number of sides a certain number of times
+     * and returns the total result.
+     */
+    ulong roll(unsigned sides=6, unsigned times=1);
+
+    /**
+     * Return true with a 1 in n probability.
+     */
+    bool oneIn(unsigned n);
+
+    /**
+     * Return a random number generated from a normal distribution with the
+     * given mean and standard deviation.
+     */
+    double normal(double mean, double stdev);
+
+    /**
+     * Return a reference to a random item from a container.
+     *
+     * @see Random::choice
+     */
+    template <typename C, typename T = typename C::value_type>
+    T& choice(C& container);
+
+    /**
+     * Shuffles the elements in the range, with every permutation equally likely.
+     *
+     * @see Random::shuffle
+     */
+    template <typename RandomIt>
+    void shuffle(RandomIt first, RandomIt last);
+
+    template <typename C>
+    void shuffle(C& container) { shuffle(std::begin(container), std::end(container)); }
+
+    /**
+     * Returns k distinct random indices in [0, n).
+     *
+     * @see Random::sampleIndices
+     */
+    std::vector<size_t> sampleIndices(size_t n, size_t k);
+
+    /**
+     * Returns copies of k distinct random items of a container.
+     *
+     * @see Random::sample
+     */
+    template <typename C, typename T = typename C::value_type>
+    std::vector<T> sample(const C& container, size_t k);
+
+    /**
+     * Returns copies of k random items of a sequence of unknown length.
+     *
+     * @see Random::sample
+     */
+    template <typename InputIt,
+              typename T = typename std::iterator_traits<InputIt>::value_type>
+    std::vector<T> sample(InputIt first, InputIt last, size_t k);
+
+    /**
+     * Returns the underlying engine, for use with other distributions.
+     */
+    Engine& getEngine() { return engine; }
+
+private:
+    Engine engine;
+    unsigned lastSeed;
+};
+
+/**
+ * Random generator based on std::mt19937, which is the engine used by lz::Random
+ * by default.
+ */
+using RandomGenerator = BasicRandomGenerator<std::mt19937>;
+
+template <typename Engine>
+BasicRandomGenerator<Engine>::BasicRandomGenerator(unsigned seed)
+    : engine(seed)
+    , lastSeed(seed)
+{
+}
+
+template <typename Engine>
+BasicRandomGenerator<Engine>::BasicRandomGenerator(const Engine& engine, unsigned seed)
+    : engine(engine)
+    , lastSeed(seed)
+{
+}
+
+template <typename Engine>
+void BasicRandomGenerator<Engine>::seed()
+{
+    seed(__lz::randomSeed());
+}
+
+template <typename Engine>
+void BasicRandomGenerator<Engine>::seed(unsigned seed)
+{
+    engine.seed(seed);
+    lastSeed = seed;
+}
+
+template <typename Engine>
+BasicRandomGenerator<Engine> BasicRandomGenerator<Engine>::split(uint64_t stream) const
+{
+    // Mix the stream before combining it, so that neighbouring seeds and
+    // streams give unrelated children
+    uint64_t childSeed = __lz::mix64(lastSeed ^ __lz::mix64(stream + 0x9E3779B97F4A7C15ull));
+    return BasicRandomGenerator(static_cast<unsigned>(childSeed ^ (childSeed >> 32)));
+}
+
+template <typename Engine>
+const size_t BasicRandomGenerator<Engine>::STATE_SIZE;
+
+template <typename Engine>
+typename BasicRandomGenerator<Engine>::State BasicRandomGenerator<Engine>::saveState() const
+{
+    State state;
+    __lz::storeLittleEndian(state.data(), static_cast<uint32_t>(lastSeed));
+    __lz::EngineState<Engine>::save(engine, state.data() + 4);
+    return state;
+}
+
+template <typename Engine>
+void BasicRandomGenerator<Engine>::loadState(const State& state)
+{
+    lastSeed = __lz::loadLittleEndian<uint32_t>(state.data());
+    __lz::EngineState<Engine>::load(engine, state.data() + 4);
+}
+
+template <typename Engine>
+template <typename T, typename U, __lz::EnableIfIntegral<T, U>*>
+typename std::common_type<T, U>::type BasicRandomGenerator<Engine>::range(T a, U b)
+{
+    typedef typename std::common_type<T, U>::type common_type;
+    auto _a = static_cast<common_type>(a);
+    auto _b = static_cast<common_type>(b);
+    if (_a > _b)
+        std::swap(_a, _b);
+    return std::uniform_int_distribution<common_type>(_a, _b)(engine);
+}
+
+template <typename Engine>
+template <typename T, typename U, __lz::EnableIfFloating<T, U>*>
+typename std::common_type<T, U>::type BasicRandomGenerator<Engine>::range(T a, U b)
+{
+    typedef typename std::common_type<T, U>::type common_type;
+    auto _a = static_cast<common_type>(a);
+    auto _b = static_cast<common_type>(b);
+    if (_a > _b)
+        std::swap(_a, _b);
+    return std::uniform_real_distribution<common_type>(_a, _b)(engine);
+}
+
+template <typename Engine>
+ulong BasicRandomGenerator<Engine>::roll(unsigned sides, unsigned times)
+{
+    if (sides == 1)
+        return times;
+    if (sides == 0 || times == 0)
+        return 0;
+    std::uniform_int_distribution<unsigned> dist(1, sides);
+    ulong total = 0;
+    for (unsigned t = 0; t < times; ++t)
+        total += dist(engine);
+    return total;
+}
+
+template <typename Engine>
+bool BasicRandomGenerator<Engine>::oneIn(unsigned n)
+{
+    if (n < 2)
+        return true;
+    return range(static_cast<unsigned>(1), n) == 1;
+}
+
+template <typename Engine>
+double BasicRandomGenerator<Engine>::normal(double mean, double stdev)
+{
+    std::normal_distribution<double> dist(mean, stdev);
+    return dist(engine);
+}
+
+template <typename Engine>
+template <typename C, typename T>
+T& BasicRandomGenerator<Engine>::choice(C& container)
+{
+    // Use size() instead of empty() to make conditions less restrictive
+    size_t size = container.size();
+    if (size == 0)
+        throw __lz::LazarusException("Container is empty");
+
+    size_t idx = range(0, size - 1);
+    return container[idx];
+}
+
+template <typename Engine>
+template <typename RandomIt>
+void BasicRandomGenerator<Engine>::shuffle(RandomIt first, RandomIt last)
+{
+    // Fisher-Yates, swapping each element with one of those not placed yet
+    auto size = last - first;
+    for (decltype(size) i = size - 1; i > 0; --i)
+    {
+        auto j = static_cast<decltype(size)>(__lz::boundedRandom(engine, i + 1));
+        using std::swap;
+        swap(first[i], first[j]);
+    }
+}
+
+template <typename Engine>
+std::vector<size_t> BasicRandomGenerator<Engine>::sampleIndices(size_t n, size_t k)
+{
+    if (k > n)
+        throw __lz::LazarusException("Cannot sample more items than there are");
+
+    // Floyd's algorithm: for each of the last k indices, pick an index up to
+    // it, and take the index itself if the picked one was already taken
+    std::vector<size_t> indices;
+    indices.reserve(k);
+    // Small samples are faster to search in place, and samples that are not
+    // too sparse are faster to mark in a bitmap than to hash
+    const size_t SEARCH_THRESHOLD = 32;
+    const size_t BITMAP_DENSITY = 256;
+    bool search = k <= SEARCH_THRESHOLD;
+    bool bitmap = !search && n / BITMAP_DENSITY <= k;
+    std::vector<bool> marked;
+    std::unordered_set<size_t> hashed;
+    if (bitmap)
+        marked.resize(n);
+    else if (!search)
+        hashed.reserve(k);
+
+    for (size_t j = n - k; j < n; ++j)
+    {
+        auto t = static_cast<size_t>(__lz::boundedRandom(engine, j + 1));
+        bool taken;
+        if (search)
+            taken = std::find(indices.begin(), indices.end(), t) != indices.end();
+        else if (bitmap)
+            taken = marked[t];
+        else
+            taken = hashed.count(t) > 0;
+
+        size_t index = taken ? j : t;
+        indices.push_back(index);
+        if (bitmap)
+            marked[index] = true;
+        else if (!search)
+            hashed.insert(index);
+    }
+    return indices;
+}
+
+template <typename Engine>
+template <typename C, typename T>
+std::vector<T> BasicRandomGenerator<Engine>::sample(const C& container, size_t k)
+{
+    std::vector<T> items;
+    items.reserve(k);
+    for (size_t index : sampleIndices(container.size(), k))
+        items.push_back(container[index]);
+    return items;
+}
+
+template <typename Engine>
+template <typename InputIt, typename T>
+std::vector<T> BasicRandomGenerator<Engine>::sample(InputIt first, InputIt last, size_t k)
+{
+    // Reservoir sampling with Algorithm L: instead of drawing for every item
+    // whether it enters the sample, draw how many items are skipped before the
+    // next one that does, which takes about k log(n / k) draws instead of n
+    std::vector<T> reservoir;
+    reservoir.reserve(k);
+    for (; first != last && reservoir.size() < k; ++first)
+        reservoir.push_back(*first);
+    if (k == 0)
+        return reservoir;
+
+    std::uniform_real_distribution<double> unit(std::nextafter(0., 1.), 1.);
+    double w = std::exp(std::log(unit(engine)) / k);
+    while (first != last)
+    {
+        double skip = std::floor(std::log(unit(engine)) / std::log1p(-w));
+        // Once w underflows, no other item would ever enter the sample
+        if (!(skip < 1e18))
+            break;
+        __lz::advanceAtMost(first, last, static_cast<uint64_t>(skip));
+        if (first == last)
+            break;
+        reservoir[__lz::boundedRandom(engine, k)] = *first;
+        ++first;
+        w *= std::exp(std::log(unit(engine)) / k);
+    }
+    return reservoir;
+}
+
+/**
+ * Random generator based on the counter-based Philox4x32 engine.
+ *
+ * @see counterRandom
+ */
+using CounterRandomGenerator = BasicRandomGenerator<Philox4x32>;
+
+/**
+ * Returns a generator whose values are a pure function of the given keys.
+ *
+ * Two generators created with the same keys produce the same sequence, no
+ * matter when or on which thread they are created, which makes them suitable
+ * for parallel systems that must be deterministic. For example, a system that
+ * rolls dice for each entity from several threads can use
+ * counterRandom(seed, entity->getId(), tick) and get the same rolls with any
+ * number of threads.
+ *
+ * The stream distinguishes independent uses of the same entity on the same
+ * tick, such as rolling for an attack and for the loot it drops.
+ * Each generator can produce 2^34 values before it repeats, and the keys must
+ * fit in 32 bits for the sequences to be distinct, except for the entity and
+ * the tick whose upper halves are combined.
+ */
+inline CounterRandomGenerator counterRandom(unsigned worldSeed, uint64_t entity,
+                                            uint64_t tick, uint32_t stream=0)
+{
+    Philox4x32 engine(static_cast<uint64_t>(stream) << 32 | worldSeed,
+                      static_cast<uint32_t>(tick),
+                      static_cast<uint32_t>(entity),
+                      static_cast<uint32_t>((entity >> 32) ^ (tick >> 32)));
+    return CounterRandomGenerator(engine, worldSeed);
+}
+
 /**
  * The Random class provides a simple interface for commonly used RNG functionality.
- * 
+ *
  * It is meant to be available from everywhere by providing static methods, but
  * encapsulating the generation logic inside of it.
- * 
+ *
  * It is important that the user calls `lz::Random::seed()` at the beginning of
  * their program to correctly seed the generator used with a pseudo-random number.
  * After that, the user can call the methods from anywhere in their program, without
  * having to ever instantiate a Random object, by just calling the methods within the
  * namespace provided.
- * 
+ *
  * For example, `lz::Random::range(1, 5)` will produce a random integer between 1 and 5.
+ *
+ * The static methods share a single default generator, so they must not be
+ * called from several threads at the same time. Code that runs on worker
+ * threads, or that needs its own reproducible sequence, should use a
+ * RandomGenerator instead, such as the streams of the ECS engine.
+ *
+ * The engine behind the static methods can be chosen at runtime with setEngine.
+ * It is std::mt19937 by default.
+ *
+ * The state of the engine in use can be saved and restored with saveState and
+ * loadState, for example to store it in a save game.
+ *
+ * @see RandomGenerator
  */
 class Random
 {
 public:
+    /**
+     * The engines that can be used by the static methods.
+     *
+     * @see RandomEngines.h
+     */
+    enum class Engine
+    {
+        Mt19937,
+        Xoshiro256StarStar,
+        Pcg32,
+        SplitMix64
+    };
+
+    /**
+     * Sets the engine used by the static methods.
+     *
+     * The new engine is seeded with the last seed used, so the sequence it
+     * produces is reproducible as well.
+     */
+    static void setEngine(Engine engine);
+
+    /**
+     * Returns the engine used by the static methods.
+     */
+    static Engine getEngine() { return engine; }
+
     /**
      * Sets a new seed for the random generator using a hardware random device if
      * available, or a seed using the current time.
@@ -33,63 +647,79 @@ public:
 
     /**
      * Sets the random generator to use the given seed.
-     * 
+     *
      * Note that using the same seed will produce the same sequences of random
      * numbers in different executions.
      * This can be useful, for example, for testing.
      */
     static void seed(unsigned seed);
 
+    /**
+     * Returns the last seed used for the random generator.
+     *
+     * This is useful to be able to reproduce a session that was seeded
+     * randomly, for example when recording events.
+     */
+    static unsigned getSeed();
+
+    /**
+     * The saved state of the static generator: the engine in use followed by
+     * the state of its generator. It is big enough for any engine.
+     */
+    using State = std::array<uint8_t, 1 + RandomGenerator::STATE_SIZE>;
+
+    /**
+     * Returns the current state of the static generator.
+     */
+    static State saveState();
+
+    /**
+     * Restores a state previously returned by saveState, including its engine.
+     *
+     * An exception is thrown if the state does not belong to a known engine.
+     */
+    static void loadState(const State& state);
+
+    /**
+     * Advances the static generator as if n values of its engine had been drawn.
+     *
+     * @see BasicRandomGenerator::discard
+     */
+    static void discard(unsigned long long n);
+
     /**
     * Return a random integral between the two given numbers with equal probability.
-    * 
+    *
     * If a < b, then it will return an integral in [a, b].
     * Otherwise, it will be in [b, a].
-    * 
+    *
     * Type is automatically detected, and the return type will be the most
     * appropriate type depending on the argument types.
     * For example, range(int, unsigned) will return an unsigned, and
     * range(short, long) will return a long.
     */
-    template <typename T, typename U,
-              typename std::enable_if_t<
-                (std::is_integral<T>::value || std::is_unsigned<T>::value)
-                && (std::is_integral<U>::value || std::is_unsigned<U>::value)
-                >* = nullptr>
+    template <typename T, typename U, __lz::EnableIfIntegral<T, U>* = nullptr>
     static typename std::common_type<T, U>::type range(T a, U b)
     {
-        typedef typename std::common_type<T, U>::type common_type;
-        auto _a = static_cast<common_type>(a);
-        auto _b = static_cast<common_type>(b);
-        if (_a > _b)
-            std::swap(_a, _b);
-        return std::uniform_int_distribution<common_type>(_a, _b)(generator);
+        return visit([&](auto& generator) { return generator.range(a, b); });
     }
 
     /**
     * Return a random floating point number between the two given numbers
     * with equal probability.
-    * 
+    *
     * If a < b, then it will return an integral in [a, b).
     * Otherwise, it will be in [b, a).
-    * 
+    *
     * Type is automatically detected, and the return type will be the most
     * appropriate type depending on the argument types.
     * For example, range(float, double) will return a double, and
     * range(int, float) will return a float.
     */
-    template <typename T, typename U,
-              typename std::enable_if_t<
-                std::is_floating_point<T>::value || std::is_floating_point<U>::value
-                >* = nullptr>
+    template <typename T, typename U, __lz::EnableIfFloating<T, U>* = nullptr>
     static typename std::common_type<T, U>::type range(T a, U b)
     {
-        typedef typename std::common_type<T, U>::type common_type;
-        auto _a = static_cast<common_type>(a);
-        auto _b = static_cast<common_type>(b);
-        if (_a > _b)
-            std::swap(_a, _b);
-        return std::uniform_real_distribution<common_type>(_a, _b)(generator);
+        return visit([&](auto& generator) { return generator.range(a, b); });
     }
 
     /**
@@ -105,10 +735,10 @@ public:
 
     /**
      * Return a random number generated from a normal distribution.
-     * 
+     *
      * The normal (or Gaussian) distribution will use the given mean and
      * standard deviation.
-     * 
+     *
      * @param mean The mean of the distribution.
      * @param stdev The standard deviation of the distribution.
      */
@@ -116,28 +746,96 @@ public:
 
     /**
      * Return a reference to a random item from a container.
-     * 
+     *
      * The container must support the size() method, and the
      * operator [] to get an element from the container.
      * If the container is empty, an exception will be thrown.
      */
     template <typename C, typename T = typename C::value_type>
-    static T& choice(C& container);
+    static T& choice(C& container)
+    {
+        return visit([&](auto& generator) -> T& { return generator.choice(container); });
+    }
 
-private:
-    static std::mt19937 generator;
-};
+    /**
+     * Shuffles the elements in the range, or in a container, with every
+     * permutation equally likely.
+     *
+     * The iterators must be random access iterators.
+     */
+    template <typename RandomIt>
+    static void shuffle(RandomIt first, RandomIt last)
+    {
+        visit([&](auto& generator) { generator.shuffle(first, last); });
+    }
 
-template <typename C, typename T>
-T& Random::choice(C& container)
-{
-    // Use size() instead of empty() to make conditions less restrictive
-    size_t size = container.size();
-    if (size == 0)
-        throw __lz::LazarusException("Container is empty");
-    
-    size_t idx = Random::range(0, size - 1);
-    return container[idx];
-}
+    template <typename C>
+    static void shuffle(C& container)
+    {
+        visit([&](auto& generator) { generator.shuffle(container); });
+    }
 
+    /**
+     * Returns k distinct random indices in [0, n), in no particular order.
+     *
+     * This takes time proportional to k, not to n, so it is suitable for
+     * picking a few items from a large population. If k is greater than n,
+     * an exception will be thrown.
+     */
+    static std::vector<size_t> sampleIndices(size_t n, size_t k);
+
+    /**
+     * Returns copies of k distinct random items of a container, in no
+     * particular order.
+     *
+     * The container must support the size() method and the operator [].
+     * If it has fewer than k items, an exception will be thrown.
+     */
+    template <typename C, typename T = typename C::value_type>
+    static std::vector<T> sample(const C& container, size_t k)
+    {
+        return visit([&](auto& generator) { return generator.sample(container, k); });
+    }
+
+    /**
+     * Returns copies of k random items of the sequence given by the input
+     * iterators, reading it only once, with every item equally likely to be picked.
+     *
+     * The length of the sequence does not need to be known, so it can come
+     * from a stream. If it has fewer than k items, all of them are returned.
+     * It takes about k log(n / k) random numbers for n items, and skips the
+     * items that are not picked in constant time with random access iterators.
+     */
+    template <typename InputIt,
+              typename T = typename std::iterator_traits<InputIt>::value_type>
+    static std::vector<T> sample(InputIt first, InputIt last, size_t k)
+    {
+        return visit([&](auto& generator) { return generator.sample(first, last, k); });
+    }
+
+private:
+    // Calls func with the generator of the current engine
+    template <typename Func>
+    static auto visit(Func func) -> decltype(func(std::declval<RandomGenerator&>()))
+    {
+        switch (engine)
+        {
+            case Engine::Xoshiro256StarStar:
+                return func(xoshiroGenerator);
+            case Engine::Pcg32:
+                return func(pcgGenerator);
+            case Engine::SplitMix64:
+                return func(splitMixGenerator);
+            default:
+                return func(generator);
+        }
+    }
+
+private:
+    static Engine engine;
+    static RandomGenerator generator;
+    static BasicRandomGenerator<Xoshiro256StarStar> xoshiroGenerator;
+    static BasicRandomGenerator<Pcg32> pcgGenerator;
+    static BasicRandomGenerator<SplitMix64> splitMixGenerator;
+};
 }  // namespace lz
@@ -0,0 +1,412 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace __lz  // Meant for internal use only
+{
+// Writes the value to the data in little endian order, so that saved states
+// can be loaded on any platform
+template <typename T>
+inline void storeLittleEndian(uint8_t* data, T value)
+{
+    for (size_t i = 0; i < sizeof(T); ++i)
+        data[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+template <typename T>
+inline T loadLittleEndian(const uint8_t* data)
+{
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+        value |= static_cast<T>(data[i]) << (8 * i);
+    return value;
+}
+}
+
+namespace lz
+{
+/**
+ * The SplitMix64 random number engine.
+ *
+ * It has a single 64 bit word of state, and each output is a scrambled
+ * value of a counter that is increased by a fixed odd constant. It is very
+ * fast, and is mostly used to expand seeds for other engines.
+ *
+ * Like all the engines in this file, it meets the requirements of the standard
+ * uniform random bit generators, so it can be used with the distributions of
+ * the standard library and as the engine of a BasicRandomGenerator. Their
+ * states can be saved to and loaded from STATE_SIZE bytes, in a format that
+ * doesn't depend on the platform.
+ */
+class SplitMix64
+{
+public:
+    using result_type = uint64_t;
+
+    static constexpr result_type default_seed = 0;
+
+    explicit SplitMix64(uint64_t seed=default_seed)
+        : state(seed)
+    {
+    }
+
+    void seed(uint64_t seed) { state = seed; }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    void discard(unsigned long long n) { state += 0x9E3779B97F4A7C15ull * n; }
+
+    static const size_t STATE_SIZE = 8;
+
+    void saveState(uint8_t* data) const { __lz::storeLittleEndian(data, state); }
+    void loadState(const uint8_t* data) { state = __lz::loadLittleEndian<uint64_t>(data); }
+
+private:
+    uint64_t state;
+};
+
+/**
+ * The xoshiro256** random number engine by Blackman and Vigna.
+ *
+ * It has 256 bits of state and a period of 2^256 - 1, and is one of the
+ * fastest generators with good statistical quality. Seeds are expanded into
+ * the full state with SplitMix64.
+ *
+ * Skipping values one by one with discard takes linear time, but the engine
+ * can jump ahead by 2^128 or 2^192 values in constant time, which splits its
+ * period into non-overlapping streams.
+ */
+class Xoshiro256StarStar
+{
+public:
+    using result_type = uint64_t;
+
+    static constexpr result_type default_seed = 0;
+
+    explicit Xoshiro256StarStar(uint64_t seed=default_seed)
+    {
+        this->seed(seed);
+    }
+
+    /**
+     * Creates an engine with the given state, which must not be all zeros.
+     */
+    Xoshiro256StarStar(uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3)
+        : state{s0, s1, s2, s3}
+    {
+    }
+
+    void seed(uint64_t seed)
+    {
+        SplitMix64 expander(seed);
+        for (auto& word : state)
+            word = expander();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    void discard(unsigned long long n)
+    {
+        for (; n > 0; --n)
+            (*this)();
+    }
+
+    /**
+     * Advances the engine by 2^128 values.
+     */
+    void jump()
+    {
+        static const uint64_t polynomial[] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+                                              0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+        jump(polynomial);
+    }
+
+    /**
+     * Advances the engine by 2^192 values.
+     */
+    void longJump()
+    {
+        static const uint64_t polynomial[] = {0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull,
+                                              0x77710069854EE241ull, 0x39109BB02ACBE635ull};
+        jump(polynomial);
+    }
+
+    static const size_t STATE_SIZE = 32;
+
+    void saveState(uint8_t* data) const
+    {
+        for (int i = 0; i < 4; ++i)
+            __lz::storeLittleEndian(data + 8 * i, state[i]);
+    }
+
+    void loadState(const uint8_t* data)
+    {
+        for (int i = 0; i < 4; ++i)
+            state[i] = __lz::loadLittleEndian<uint64_t>(data + 8 * i);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // Sets the state to the one reached after the number of steps given by
+    // the characteristic polynomial
+    void jump(const uint64_t* polynomial)
+    {
+        uint64_t jumped[4] = {0, 0, 0, 0};
+        for (int word = 0; word < 4; ++word)
+            for (int bit = 0; bit < 64; ++bit)
+            {
+                if (polynomial[word] & (uint64_t(1) << bit))
+                    for (int i = 0; i < 4; ++i)
+                        jumped[i] ^= state[i];
+                (*this)();
+            }
+        for (int i = 0; i < 4; ++i)
+            state[i] = jumped[i];
+    }
+
+private:
+    uint64_t state[4];
+};
+
+/**
+ * The PCG32 random number engine by O'Neill (PCG XSH RR 64/32).
+ *
+ * It has a 64 bit linear congruential state whose output is permuted into a
+ * 32 bit result, and supports 2^63 independent streams selected by the
+ * increment of the generator. It can skip any number of values in logarithmic time.
+ */
+class Pcg32
+{
+public:
+    using result_type = uint32_t;
+
+    static constexpr result_type default_seed = 0;
+
+    explicit Pcg32(uint64_t seed=default_seed, uint64_t stream=0xDA3E39CB94B95BDBull)
+    {
+        this->seed(seed, stream);
+    }
+
+    void seed(uint64_t seed) { this->seed(seed, increment >> 1); }
+
+    /**
+     * Seeds the engine, selecting one of its streams.
+     */
+    void seed(uint64_t seed, uint64_t stream)
+    {
+        state = 0;
+        increment = (stream << 1) | 1;
+        (*this)();
+        state += seed;
+        (*this)();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        uint64_t old = state;
+        state = old * MULTIPLIER + increment;
+        uint32_t xorShifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rotation = static_cast<uint32_t>(old >> 59);
+        return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+
+    void discard(unsigned long long n)
+    {
+        // Compose the affine steps of the generator by repeated squaring
+        uint64_t multiplier = 1, offset = 0;
+        uint64_t stepMultiplier = MULTIPLIER, stepOffset = increment;
+        for (; n > 0; n >>= 1)
+        {
+            if (n & 1)
+            {
+                multiplier *= stepMultiplier;
+                offset = offset * stepMultiplier + stepOffset;
+            }
+            stepOffset = (stepMultiplier + 1) * stepOffset;
+            stepMultiplier *= stepMultiplier;
+        }
+        state = multiplier * state + offset;
+    }
+
+    static const size_t STATE_SIZE = 16;
+
+    void saveState(uint8_t* data) const
+    {
+        __lz::storeLittleEndian(data, state);
+        __lz::storeLittleEndian(data + 8, increment);
+    }
+
+    void loadState(const uint8_t* data)
+    {
+        state = __lz::loadLittleEndian<uint64_t>(data);
+        increment = __lz::loadLittleEndian<uint64_t>(data + 8);
+    }
+
+private:
+    static const uint64_t MULTIPLIER = 6364136223846793005ull;
+
+    uint64_t state;
+    uint64_t increment = 0xDA3E39CB94B95BDBull << 1 | 1;
+};
+
+/**
+ * The Philox4x32-10 counter-based random number engine by Salmon et al.
+ *
+ * Instead of advancing a state, Philox computes each block of four 32 bit
+ * outputs as a pure function of a 128 bit counter and a 64 bit key, with ten
+ * rounds of multiplications and exclusive ors. Any block can be computed in
+ * isolation, so values keyed by, for example, an entity and a tick are the
+ * same no matter which thread computes them or in which order.
+ *
+ * As an engine, the first word of the counter is the index of the current
+ * block, and the other three words select the sequence along with the key.
+ *
+ * @see counterRandom
+ */
+class Philox4x32
+{
+public:
+    using result_type = uint32_t;
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    static constexpr result_type default_seed = 0;
+
+    /**
+     * Creates an engine with the key given by the seed and the sequence
+     * selected by the upper three words of the counter.
+     */
+    explicit Philox4x32(uint64_t seed=default_seed, uint32_t c1=0, uint32_t c2=0, uint32_t c3=0)
+        : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}
+        , counter{0, c1, c2, c3}
+    {
+    }
+
+    /**
+     * Sets the key, and restarts the current sequence.
+     */
+    void seed(uint64_t seed)
+    {
+        key = Key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+        counter[0] = 0;
+        index = 4;
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        if (index == 4)
+        {
+            output = block(counter, key);
+            ++counter[0];
+            index = 0;
+        }
+        return output[index++];
+    }
+
+    void discard(unsigned long long n)
+    {
+        // Skip whole blocks without computing them
+        unsigned long long position = (index == 4 ? 4ull * counter[0] : 4ull * (counter[0] - 1) + index) + n;
+        counter[0] = static_cast<uint32_t>(position / 4);
+        index = 4;
+        unsigned remainder = position % 4;
+        if (remainder != 0)
+        {
+            (*this)();
+            index = remainder;
+        }
+    }
+
+    static const size_t STATE_SIZE = 25;
+
+    void saveState(uint8_t* data) const
+    {
+        for (int i = 0; i < 2; ++i)
+            __lz::storeLittleEndian(data + 4 * i, key[i]);
+        for (int i = 0; i < 4; ++i)
+            __lz::storeLittleEndian(data + 8 + 4 * i, counter[i]);
+        data[24] = static_cast<uint8_t>(index);
+    }
+
+    void loadState(const uint8_t* data)
+    {
+        for (int i = 0; i < 2; ++i)
+            key[i] = __lz::loadLittleEndian<uint32_t>(data + 4 * i);
+        for (int i = 0; i < 4; ++i)
+            counter[i] = __lz::loadLittleEndian<uint32_t>(data + 8 + 4 * i);
+        index = data[24] > 4 ? 4 : data[24];
+        if (index < 4)
+        {
+            // Recompute the block being read, which is the one before the counter
+            Counter current = counter;
+            --current[0];
+            output = block(current, key);
+        }
+    }
+
+    /**
+     * Computes the block of four outputs for the given counter and key.
+     */
+    static Counter block(Counter counter, Key key)
+    {
+        for (int round = 0; round < 10; ++round)
+        {
+            if (round > 0)
+            {
+                key[0] += 0x9E3779B9u;
+                key[1] += 0xBB67AE85u;
+            }
+            uint64_t product0 = static_cast<uint64_t>(0xD2511F53u) * counter[0];
+            uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57u) * counter[2];
+            counter = Counter{
+                static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                static_cast<uint32_t>(product1),
+                static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                static_cast<uint32_t>(product0)};
+        }
+        return counter;
+    }
+
+private:
+    Key key;
+    Counter counter;
+    Counter output{};
+    unsigned index = 4;
+};
+}  // namespace lz
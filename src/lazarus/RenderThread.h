@@ -0,0 +1,310 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <lazarus/CellBuffer.h>
+#include <lazarus/ECS/Interpolated.h>
+#include <lazarus/ECS/SystemTiming.h>
+#include <lazarus/TripleBuffer.h>
+
+namespace lz
+{
+/**
+ * An entity drawn over the grid of cells, at any position.
+ */
+struct Sprite
+{
+    // Transforms at the previous and current steps of the simulation, in
+    // pixels from the top left of the grid
+    Interpolated transform;
+    uint32_t glyph;
+    Color color;
+};
+
+/**
+ * What the simulation shows at a given time, as drawn by the render thread.
+ */
+struct RenderSnapshot
+{
+    using Clock = std::chrono::steady_clock;
+
+    CellBuffer cells;
+    std::vector<Sprite> sprites;
+    // Number of inputs given to RenderThread::receiveInput that the
+    // simulation handled before taking the snapshot
+    uint64_t inputs = 0;
+    // Time at which the step shown by the snapshot was due, and seconds
+    // between the steps of the simulation
+    Clock::time_point stepTime;
+    double stepDuration = 0.;
+
+    /**
+     * Returns the fraction of a step that passed since the step shown by the
+     * snapshot, at the given time, for drawing interpolated transforms. It is
+     * 1 for snapshots without a step duration, which draw the current ones.
+     */
+    float getAlpha(Clock::time_point now) const
+    {
+        if (stepDuration <= 0.)
+            return 1.f;
+        double alpha = std::chrono::duration<double>(now - stepTime).count() / stepDuration;
+        return static_cast<float>(std::min(std::max(alpha, 0.), 1.));
+    }
+};
+
+/**
+ * Draws the snapshots published by the simulation on a thread of its own.
+ *
+ * The simulation fills the snapshot returned by getSnapshot and publishes it,
+ * which hands it over to the render thread through a TripleBuffer, so a slow
+ * simulation step does not make the render thread miss frames, and a slow
+ * frame does not delay the simulation. The render thread calls the draw
+ * function with the latest snapshot, and only with snapshots that are
+ * complete, so the draw function can read them without any lock.
+ *
+ * By default the render thread sleeps until a new snapshot is published. A
+ * continuous render thread draws again as soon as the draw function returns,
+ * which suits draw functions that wait for the vertical sync or that
+ * interpolate between snapshots.
+ *
+ * The time from an input to the first frame that shows its effects is
+ * measured by giving each input to receiveInput as soon as it is received,
+ * and having the simulation count the inputs it handled in its snapshots.
+ *
+ * Snapshot types can add fields to RenderSnapshot, as long as they keep an
+ * inputs field.
+ *
+ * @see TripleBuffer
+ */
+template <typename Snapshot=RenderSnapshot>
+class RenderThread
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Draws a snapshot, and tells whether it changed since the previous frame.
+     */
+    using DrawFunction = std::function<void(const Snapshot& snapshot, bool changed)>;
+
+    /**
+     * Number of inputs whose time of reception is kept. If more inputs are
+     * received between two frames, only the latest ones are measured.
+     */
+    static const size_t INPUT_HISTORY = 256;
+
+    /**
+     * Starts the render thread, which waits for the first snapshot unless it
+     * is continuous, in which case it starts drawing the initial snapshot.
+     */
+    explicit RenderThread(DrawFunction draw, bool continuous=false, const Snapshot& initial=Snapshot())
+        : draw(std::move(draw))
+        , continuous(continuous)
+        , buffers(initial)
+    {
+        thread = std::thread(&RenderThread::run, this);
+    }
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    /**
+     * Stops the render thread, ignoring the errors of the draw function.
+     */
+    ~RenderThread()
+    {
+        try
+        {
+            stop();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    /**
+     * Returns the snapshot to fill before publishing it.
+     *
+     * It holds an older snapshot, which must be fully rewritten. It must only
+     * be used by the thread that publishes the snapshots.
+     */
+    Snapshot& getSnapshot() { return buffers.getWriteBuffer(); }
+
+    /**
+     * Hands the snapshot over to the render thread, without waiting for it.
+     *
+     * If the render thread has not drawn the previously published snapshot
+     * yet, it is replaced by this one.
+     */
+    void publish()
+    {
+        buffers.publish();
+
+        // Only wake the render thread up when it is asleep, in which case it
+        // is not drawing and holds the mutex only until it starts waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            wakeUp.notify_one();
+        }
+    }
+
+    /**
+     * Records the time an input was received, and returns the number of
+     * inputs received so far, which is the value of the inputs field of the
+     * first snapshot that handles it. It must only be called by one thread.
+     */
+    uint64_t receiveInput()
+    {
+        uint64_t index = receivedInputs.load(std::memory_order_relaxed);
+        inputTimes[index % INPUT_HISTORY].store(Clock::now().time_since_epoch().count(),
+                                                std::memory_order_relaxed);
+        receivedInputs.store(index + 1, std::memory_order_release);
+        return index + 1;
+    }
+
+    /**
+     * Stops the render thread once it finishes its current frame.
+     *
+     * If the draw function threw an exception, the render thread stopped and
+     * the exception is thrown again here.
+     */
+    void stop()
+    {
+        if (thread.joinable())
+        {
+            stopping.store(true);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                wakeUp.notify_one();
+            }
+            thread.join();
+        }
+        if (error)
+        {
+            std::exception_ptr thrown = error;
+            error = nullptr;
+            std::rethrow_exception(thrown);
+        }
+    }
+
+    /**
+     * Returns whether the render thread is drawing, which is false once it
+     * was stopped or the draw function threw an exception.
+     */
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    /**
+     * Returns the number of frames drawn so far.
+     */
+    uint64_t getFrameCount() const { return frames.load(std::memory_order_acquire); }
+
+    /**
+     * Returns the time from receiving inputs to the end of the first frame
+     * that shows their effects, over the recent inputs.
+     */
+    SystemTiming getInputLatency() const
+    {
+        SystemTiming timing;
+        timing.name = "input latency";
+        std::lock_guard<std::mutex> lock(latencyMutex);
+        latency.summarize(timing);
+        return timing;
+    }
+
+private:
+    void run()
+    {
+        try
+        {
+            while (!stopping.load(std::memory_order_relaxed))
+            {
+                bool changed = buffers.update();
+                if (!changed && !continuous)
+                {
+                    waitForSnapshot();
+                    continue;
+                }
+
+                const Snapshot& snapshot = buffers.getReadBuffer();
+                draw(snapshot, changed);
+                frames.fetch_add(1, std::memory_order_release);
+                if (changed)
+                    measureLatency(snapshot.inputs);
+            }
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        running.store(false, std::memory_order_release);
+    }
+
+    void waitForSnapshot()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!buffers.hasUpdate() && !stopping.load())
+            wakeUp.wait(lock);
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    // Measures the latency of the inputs handled for the first time by the
+    // snapshot that was just drawn
+    void measureLatency(uint64_t handled)
+    {
+        if (handled <= presentedInputs)
+            return;
+
+        const int64_t now = Clock::now().time_since_epoch().count();
+        const uint64_t received = receivedInputs.load(std::memory_order_acquire);
+        const uint64_t first = std::max(presentedInputs, received > INPUT_HISTORY ? received - INPUT_HISTORY : 0);
+        std::lock_guard<std::mutex> lock(latencyMutex);
+        for (uint64_t input = first; input < std::min(handled, received); ++input)
+        {
+            int64_t time = inputTimes[input % INPUT_HISTORY].load(std::memory_order_relaxed);
+            latency.add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::duration(now - time)));
+        }
+        presentedInputs = handled;
+    }
+
+private:
+    DrawFunction draw;
+    const bool continuous;
+    TripleBuffer<Snapshot> buffers;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> frames{0};
+
+    // Lets the render thread sleep until a snapshot is published
+    std::atomic<bool> sleeping{false};
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+
+    // Times at which the inputs were received, as ticks of the clock
+    std::array<std::atomic<int64_t>, INPUT_HISTORY> inputTimes{};
+    std::atomic<uint64_t> receivedInputs{0};
+    // Number of inputs handled by the snapshots drawn so far, for the render thread only
+    uint64_t presentedInputs = 0;
+    mutable std::mutex latencyMutex;
+    __lz::TimingHistory latency;
+
+    std::exception_ptr error;
+    std::thread thread;
+};
+
+template <typename Snapshot>
+const size_t RenderThread<Snapshot>::INPUT_HISTORY;
+}  // namespace lz
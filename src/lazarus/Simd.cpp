@@ -0,0 +1,14 @@
+#include <lazarus/Simd.h>
+
+using namespace lz;
+
+SimdLevel lz::bestSimdLevel()
+{
+#ifdef LZ_X86_SIMD
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SimdLevel::SSE2;
+#endif
+    return SimdLevel::Scalar;
+}
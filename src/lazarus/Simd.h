@@ -0,0 +1,26 @@
+#pragma once
+
+// The vector kernels are compiled for x86 with GCC and Clang, using function
+// attributes so that they don't require special compiler flags, and are
+// selected at runtime depending on the processor
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define LZ_X86_SIMD
+#endif
+
+namespace lz
+{
+/**
+ * The instruction sets used by the vectorized kernels of the library.
+ */
+enum class SimdLevel
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+/**
+ * Returns the best instruction set supported by the processor.
+ */
+SimdLevel bestSimdLevel();
+}  // namespace lz
@@ -0,0 +1,156 @@
+#include <lazarus/SoftwareRenderer.h>
+
+#include <algorithm>
+
+#include <lazarus/common.h>
+
+using namespace lz;
+
+namespace
+{
+// Multiplies two channels, as if they were in [0, 1]
+inline uint8_t multiply(uint8_t a, uint8_t b)
+{
+    return static_cast<uint8_t>((a * b + 127) / 255);
+}
+
+// Draws src over dst with the blending SFML uses by default
+inline Color blend(Color dst, Color src)
+{
+    if (src.a == 255)
+        return src;
+    if (src.a == 0)
+        return dst;
+    const unsigned a = src.a, rest = 255 - a;
+    return Color(static_cast<uint8_t>((src.r * a + dst.r * rest + 127) / 255),
+                 static_cast<uint8_t>((src.g * a + dst.g * rest + 127) / 255),
+                 static_cast<uint8_t>((src.b * a + dst.b * rest + 127) / 255),
+                 static_cast<uint8_t>(a + (dst.a * rest + 127) / 255));
+}
+}
+
+SoftwareRenderer::SoftwareRenderer(const Framebuffer& atlas, size_t tileWidth, size_t tileHeight)
+    : atlas(&atlas)
+    , tileWidth(tileWidth)
+    , tileHeight(tileHeight)
+{
+    if (tileWidth == 0 || tileHeight == 0)
+        throw __lz::LazarusException("The size of the tiles must be positive");
+
+    atlasColumns = atlas.getWidth() / tileWidth;
+    glyphCount = atlasColumns * (atlas.getHeight() / tileHeight);
+    if (glyphCount == 0)
+        throw __lz::LazarusException("The atlas is smaller than a tile");
+}
+
+SoftwareRenderer::SoftwareRenderer(const Framebuffer& page, const GlyphTable& glyphs,
+                                   size_t tileWidth, size_t tileHeight)
+    : atlas(&page)
+    , glyphs(&glyphs)
+    , tileWidth(tileWidth)
+    , tileHeight(tileHeight)
+    , sourceColumns(tileWidth)
+{
+    if (tileWidth == 0 || tileHeight == 0)
+        throw __lz::LazarusException("The size of the tiles must be positive");
+    if (glyphs.getPageCount() > 1)
+        throw __lz::LazarusException("The atlas must have a single page");
+}
+
+void SoftwareRenderer::setClearColor(Color color)
+{
+    clearColor = color;
+    redraw = true;
+}
+
+bool SoftwareRenderer::update(CellBuffer& cells)
+{
+    drawnCells = 0;
+    if (redraw || cells.getWidth() != width || cells.getHeight() != height)
+    {
+        width = cells.getWidth();
+        height = cells.getHeight();
+        framebuffer.create(width * tileWidth, height * tileHeight, clearColor);
+        redraw = false;
+        cells.markDirty();
+    }
+    if (!cells.isDirty())
+        return false;
+
+    for (size_t y = 0; y < height; ++y)
+    {
+        auto columns = cells.getDirtyColumns(y);
+        const Cell* row = cells.getRow(y);
+        for (size_t x = columns.first; x < columns.second; ++x)
+            drawCell(x, y, row[x]);
+        if (columns.first < columns.second)
+            drawnCells += columns.second - columns.first;
+    }
+
+    cells.clearDirty();
+    return true;
+}
+
+bool SoftwareRenderer::findGlyph(uint32_t glyph, AtlasRect& rect) const
+{
+    if (!glyphs)
+    {
+        // Glyphs that are not in a grid atlas are drawn as the first one
+        size_t index = glyph < glyphCount ? glyph : 0;
+        rect = AtlasRect{0, static_cast<uint32_t>((index % atlasColumns) * tileWidth),
+                         static_cast<uint32_t>((index / atlasColumns) * tileHeight),
+                         static_cast<uint32_t>(tileWidth), static_cast<uint32_t>(tileHeight)};
+        return true;
+    }
+
+    const AtlasRect* found = glyphs->find(glyph);
+    if (!found || found->x + found->width > atlas->getWidth() || found->y + found->height > atlas->getHeight())
+        return false;
+    rect = *found;
+    return true;
+}
+
+void SoftwareRenderer::drawCell(size_t x, size_t y, const Cell& cell)
+{
+    const size_t left = x * tileWidth, top = y * tileHeight;
+    const Color background = blend(clearColor, cell.background);
+    for (size_t row = 0; row < tileHeight; ++row)
+    {
+        Color* pixels = framebuffer.getRow(top + row) + left;
+        std::fill(pixels, pixels + tileWidth, background);
+    }
+
+    AtlasRect rect;
+    if (cell.foreground.a == 0 || !findGlyph(cell.glyph, rect))
+        return;
+
+    // Glyphs of the size of the tiles are copied, others are stretched by
+    // picking the nearest texel
+    const bool stretched = rect.width != tileWidth || rect.height != tileHeight;
+    if (stretched)
+        for (size_t column = 0; column < tileWidth; ++column)
+            sourceColumns[column] = rect.x + column * rect.width / tileWidth;
+
+    // Atlases have few distinct colors, mostly white, so the last tinted
+    // texel is kept instead of tinting every one of them
+    const Color tint = cell.foreground;
+    Color lastTexel = Color::White, tinted = tint;
+    for (size_t row = 0; row < tileHeight; ++row)
+    {
+        const Color* texels = atlas->getRow(rect.y + row * rect.height / tileHeight);
+        Color* pixels = framebuffer.getRow(top + row) + left;
+        for (size_t column = 0; column < tileWidth; ++column)
+        {
+            const Color texel = texels[stretched ? sourceColumns[column] : rect.x + column];
+            if (texel.a == 0)
+                continue;
+            if (texel != lastTexel)
+            {
+                lastTexel = texel;
+                tinted = Color(multiply(texel.r, tint.r), multiply(texel.g, tint.g),
+                               multiply(texel.b, tint.b), multiply(texel.a, tint.a));
+            }
+            pixels[column] = blend(pixels[column], tinted);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <lazarus/AtlasPacker.h>
+#include <lazarus/CellRenderer.h>
+#include <lazarus/Framebuffer.h>
+
+namespace lz
+{
+/**
+ * Draws a CellBuffer into a Framebuffer on the CPU, without a window or a
+ * graphics card.
+ *
+ * It draws the cells the same way as the TileRenderer: the background of each
+ * cell fills its tile, and the glyph is drawn over it from an atlas, with its
+ * color multiplied by the foreground color and blended by its alpha. This
+ * makes it a reference to compare frames against in tests, and a way to
+ * measure the cost of rendering on machines without a display.
+ *
+ * Like the TileRenderer, it only draws the cells that the buffer marked as
+ * dirty, so the framebuffer always holds the whole frame.
+ *
+ * @see CellBuffer
+ * @see TileRenderer
+ */
+class SoftwareRenderer : public CellRenderer
+{
+public:
+    /**
+     * Creates a renderer that draws glyphs from an atlas made of tiles of the
+     * given size, in the layout described by TileRenderer.
+     *
+     * The atlas is not copied, so it must outlive the renderer.
+     */
+    SoftwareRenderer(const Framebuffer& atlas, size_t tileWidth, size_t tileHeight);
+
+    /**
+     * Creates a renderer that draws glyphs from a packed atlas, each stretched
+     * to a tile of the given size. Glyphs that are not in the atlas are not
+     * drawn.
+     *
+     * The glyphs must all be in the given page, and neither the page nor the
+     * table are copied, so they must outlive the renderer.
+     */
+    SoftwareRenderer(const Framebuffer& page, const GlyphTable& glyphs, size_t tileWidth,
+                     size_t tileHeight);
+
+    bool update(CellBuffer& cells) override;
+
+    /**
+     * Returns the frame drawn so far, which is as large as the grid of tiles.
+     */
+    const Framebuffer& getFramebuffer() const { return framebuffer; }
+
+    /**
+     * Sets the color the tiles are cleared to before their background is
+     * drawn, which shows through transparent backgrounds. The whole grid is
+     * drawn again by the next update.
+     */
+    void setClearColor(Color color);
+
+    /**
+     * Returns the number of cells drawn by the last update.
+     */
+    size_t getDrawnCells() const { return drawnCells; }
+
+    size_t getTileWidth() const { return tileWidth; }
+    size_t getTileHeight() const { return tileHeight; }
+
+private:
+    // Finds the rectangle of a glyph in the atlas, or returns false if it is not in it
+    bool findGlyph(uint32_t glyph, AtlasRect& rect) const;
+
+    // Draws a cell into its tile of the framebuffer
+    void drawCell(size_t x, size_t y, const Cell& cell);
+
+private:
+    const Framebuffer* atlas;
+    const GlyphTable* glyphs = nullptr;
+    size_t tileWidth;
+    size_t tileHeight;
+    // Number of glyphs in each row of a grid atlas, and in total
+    size_t atlasColumns = 0;
+    size_t glyphCount = 0;
+    Color clearColor = Color::Black;
+    Framebuffer framebuffer;
+    size_t width = 0;
+    size_t height = 0;
+    bool redraw = true;
+    size_t drawnCells = 0;
+    // Column of the atlas read for each column of a tile, for stretched glyphs
+    std::vector<size_t> sourceColumns;
+};
+}  // namespace lz
@@ -0,0 +1,189 @@
+#include <lazarus/TileRenderer.h>
+
+#include <lazarus/common.h>
+
+using namespace lz;
+
+const unsigned TileRenderer::DRAW_CALLS;
+
+namespace
+{
+sf::Color toSfml(Color color)
+{
+    return sf::Color(color.r, color.g, color.b, color.a);
+}
+}
+
+TileRenderer::TileRenderer(const sf::Texture& atlas, sf::Vector2u tileSize)
+    : atlas(&atlas)
+    , tileSize(tileSize)
+    , useBuffers(sf::VertexBuffer::isAvailable())
+    , backgroundBuffer(sf::Quads, sf::VertexBuffer::Dynamic)
+    , foregroundBuffer(sf::Quads, sf::VertexBuffer::Dynamic)
+{
+    if (tileSize.x == 0 || tileSize.y == 0)
+        throw __lz::LazarusException("The size of the tiles must be positive");
+
+    sf::Vector2u atlasSize = atlas.getSize();
+    atlasColumns = atlasSize.x / tileSize.x;
+    glyphCount = atlasColumns * (atlasSize.y / tileSize.y);
+    if (glyphCount == 0)
+        throw __lz::LazarusException("The atlas is smaller than a tile");
+}
+
+TileRenderer::TileRenderer(const Atlas& atlas, sf::Vector2u tileSize)
+    : tileSize(tileSize)
+    , glyphs(&atlas.getGlyphs())
+    , useBuffers(sf::VertexBuffer::isAvailable())
+    , backgroundBuffer(sf::Quads, sf::VertexBuffer::Dynamic)
+    , foregroundBuffer(sf::Quads, sf::VertexBuffer::Dynamic)
+{
+    if (tileSize.x == 0 || tileSize.y == 0)
+        throw __lz::LazarusException("The size of the tiles must be positive");
+    if (atlas.getPageCount() != 1)
+        throw __lz::LazarusException("The atlas must have exactly one page");
+    this->atlas = &atlas.getPage(0);
+}
+
+bool TileRenderer::update(CellBuffer& cells)
+{
+    uploadedVertices = 0;
+    if (cells.getWidth() != width || cells.getHeight() != height)
+    {
+        resize(cells.getWidth(), cells.getHeight());
+        cells.markDirty();
+    }
+    if (!cells.isDirty())
+        return false;
+
+    // Consecutive dirty rows are uploaded together, including the clean cells
+    // between their dirty columns, which is cheaper than several uploads
+    size_t runBegin = 0, runEnd = 0;
+    for (size_t y = 0; y < height; ++y)
+    {
+        auto columns = cells.getDirtyColumns(y);
+        if (columns.first >= columns.second)
+        {
+            upload(runBegin, runEnd);
+            runBegin = runEnd = 0;
+            continue;
+        }
+
+        const Cell* row = cells.getRow(y);
+        for (size_t x = columns.first; x < columns.second; ++x)
+            setCell(y * width + x, row[x]);
+        if (runBegin == runEnd)
+            runBegin = y * width + columns.first;
+        runEnd = y * width + columns.second;
+    }
+    upload(runBegin, runEnd);
+
+    cells.clearDirty();
+    return true;
+}
+
+void TileRenderer::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    states.transform *= getTransform();
+
+    states.texture = nullptr;
+    if (useBuffers)
+        target.draw(backgroundBuffer, states);
+    else
+        target.draw(background.data(), background.size(), sf::Quads, states);
+
+    states.texture = atlas;
+    if (useBuffers)
+        target.draw(foregroundBuffer, states);
+    else
+        target.draw(foreground.data(), foreground.size(), sf::Quads, states);
+}
+
+void TileRenderer::resize(size_t width, size_t height)
+{
+    this->width = width;
+    this->height = height;
+    background.resize(width * height * 4);
+    foreground.resize(width * height * 4);
+    if (useBuffers)
+    {
+        backgroundBuffer.create(background.size());
+        foregroundBuffer.create(foreground.size());
+    }
+
+    // The corners of each quad, clockwise from the top left
+    const float w = static_cast<float>(tileSize.x), h = static_cast<float>(tileSize.y);
+    for (size_t y = 0; y < height; ++y)
+        for (size_t x = 0; x < width; ++x)
+        {
+            size_t vertex = (y * width + x) * 4;
+            sf::Vector2f corner(x * w, y * h);
+            sf::Vector2f corners[] = {corner, sf::Vector2f(corner.x + w, corner.y),
+                                      sf::Vector2f(corner.x + w, corner.y + h),
+                                      sf::Vector2f(corner.x, corner.y + h)};
+            for (int i = 0; i < 4; ++i)
+            {
+                background[vertex + i].position = corners[i];
+                foreground[vertex + i].position = corners[i];
+            }
+        }
+}
+
+void TileRenderer::setCell(size_t index, const Cell& cell)
+{
+    float u, v, w, h;
+    sf::Color frontColor = toSfml(cell.foreground);
+    if (glyphs)
+    {
+        // Glyphs that are not in a packed atlas are transparent
+        const AtlasRect* rect = glyphs->find(cell.glyph);
+        if (rect)
+        {
+            u = static_cast<float>(rect->x);
+            v = static_cast<float>(rect->y);
+            w = static_cast<float>(rect->width);
+            h = static_cast<float>(rect->height);
+        }
+        else
+        {
+            u = v = w = h = 0.f;
+            frontColor = sf::Color::Transparent;
+        }
+    }
+    else
+    {
+        // Glyphs that are not in a grid atlas are drawn as the first one
+        unsigned glyph = cell.glyph < glyphCount ? cell.glyph : 0;
+        w = static_cast<float>(tileSize.x);
+        h = static_cast<float>(tileSize.y);
+        u = (glyph % atlasColumns) * w;
+        v = (glyph / atlasColumns) * h;
+    }
+
+    sf::Vertex* back = background.data() + index * 4;
+    sf::Vertex* front = foreground.data() + index * 4;
+    const sf::Color backColor = toSfml(cell.background);
+    for (int i = 0; i < 4; ++i)
+    {
+        back[i].color = backColor;
+        front[i].color = frontColor;
+    }
+    front[0].texCoords = sf::Vector2f(u, v);
+    front[1].texCoords = sf::Vector2f(u + w, v);
+    front[2].texCoords = sf::Vector2f(u + w, v + h);
+    front[3].texCoords = sf::Vector2f(u, v + h);
+}
+
+void TileRenderer::upload(size_t first, size_t last)
+{
+    if (first >= last)
+        return;
+    uploadedVertices += (last - first) * 4;
+    if (!useBuffers)
+        return;
+
+    size_t count = (last - first) * 4;
+    unsigned offset = static_cast<unsigned>(first * 4);
+    backgroundBuffer.update(background.data() + first * 4, count, offset);
+    foregroundBuffer.update(foreground.data() + first * 4, count, offset);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include <lazarus/Atlas.h>
+#include <lazarus/CellBuffer.h>
+#include <lazarus/CellRenderer.h>
+
+namespace lz
+{
+/**
+ * Draws a CellBuffer as a grid of tiles, with a constant number of draw calls.
+ *
+ * Each layer of the grid, the backgrounds and the glyphs, is a single buffer
+ * of quads, so the whole grid takes two draw calls no matter how many cells it
+ * has. The positions of the quads only change when the size of the grid does.
+ *
+ * Updates are incremental: only the cells that the buffer marked as dirty are
+ * rewritten, and each run of dirty rows is uploaded to a vertex buffer that
+ * stays on the graphics card, with a single partial update. When nothing
+ * changed, update returns false and the frame does not need to be drawn
+ * again. If the graphics card does not support vertex buffers, the vertices
+ * are sent with every draw instead.
+ *
+ * The glyphs come from a texture atlas made of tiles of the same size, with
+ * glyph 0 at the top left and the next ones from left to right and from top to
+ * bottom, which is the usual layout of CP437 bitmap fonts, or from an Atlas
+ * built by an AtlasBuilder, which can mix fonts and tiles of any size.
+ *
+ * The renderer is transformable, so the grid can be moved or scaled like any
+ * other SFML entity.
+ *
+ * @see CellBuffer
+ * @see AtlasBuilder
+ * @see SoftwareRenderer
+ */
+class TileRenderer : public CellRenderer, public sf::Drawable, public sf::Transformable
+{
+public:
+    /**
+     * Number of draw calls issued to draw the grid.
+     */
+    static const unsigned DRAW_CALLS = 2;
+
+    /**
+     * Creates a renderer that draws glyphs from the given atlas, whose tiles
+     * have the given size in pixels.
+     *
+     * The atlas is not copied, so it must outlive the renderer.
+     */
+    TileRenderer(const sf::Texture& atlas, sf::Vector2u tileSize);
+
+    /**
+     * Creates a renderer that draws glyphs from a packed atlas, each stretched
+     * to a tile of the given size in pixels. Glyphs that are not in the atlas
+     * are not drawn.
+     *
+     * The atlas must fit in a single page, since the glyphs are drawn with a
+     * single texture. It is not copied, so it must outlive the renderer.
+     */
+    TileRenderer(const Atlas& atlas, sf::Vector2u tileSize);
+
+    /**
+     * Copies the dirty cells into the vertex buffers, and marks them as clean.
+     *
+     * Returns whether any cell changed, so that frames where none did can skip
+     * redrawing the grid. The whole grid is updated if the size of the buffer
+     * changed.
+     */
+    bool update(CellBuffer& cells) override;
+
+    /**
+     * Returns the number of vertices uploaded by the last update.
+     */
+    size_t getUploadedVertices() const { return uploadedVertices; }
+
+    /**
+     * Returns the size of the tiles, in pixels.
+     */
+    sf::Vector2u getTileSize() const { return tileSize; }
+
+    /**
+     * Returns the size of the grid, in cells.
+     */
+    sf::Vector2u getGridSize() const
+    {
+        return sf::Vector2u(static_cast<unsigned>(width), static_cast<unsigned>(height));
+    }
+
+private:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    // Sets the size of the grid and the positions of its quads
+    void resize(size_t width, size_t height);
+
+    // Sets the colors and texture coordinates of the quads of a cell
+    void setCell(size_t index, const Cell& cell);
+
+    // Uploads the quads of the cells in [first, last) to the vertex buffers
+    void upload(size_t first, size_t last);
+
+private:
+    const sf::Texture* atlas;
+    sf::Vector2u tileSize;
+    // Number of glyphs in each row of the atlas, and in total
+    unsigned atlasColumns = 0;
+    unsigned glyphCount = 0;
+    // Rectangles of the glyphs of a packed atlas, instead of a grid
+    const GlyphTable* glyphs = nullptr;
+    size_t width = 0;
+    size_t height = 0;
+    // Quads of the backgrounds, which are not textured, and of the glyphs
+    std::vector<sf::Vertex> background;
+    std::vector<sf::Vertex> foreground;
+    // Copies of the quads on the graphics card, if it supports them
+    bool useBuffers;
+    sf::VertexBuffer backgroundBuffer;
+    sf::VertexBuffer foregroundBuffer;
+    size_t uploadedVertices = 0;
+};
+}  // namespace lz
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace lz
+{
+/**
+ * Hands values over from one writer thread to one reader thread, without locks.
+ *
+ * The buffer holds three values: the writer fills the back one, the reader
+ * uses the front one, and the middle one holds the latest published value.
+ * Publishing swaps the back and middle values, and the reader takes the
+ * middle value when it is newer than the front one, so neither thread ever
+ * waits for the other, and the reader always gets the latest complete value.
+ * Values that are published while the reader is busy are replaced by the next
+ * ones without being read.
+ *
+ * After publish, the writer gets back an old value, which must be fully
+ * rewritten before being published again.
+ *
+ * @see RenderThread
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    /**
+     * Creates a buffer whose three values are copies of the given one.
+     */
+    explicit TripleBuffer(const T& value) : buffers{{value, value, value}} {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /**
+     * Returns the value being written, for the writer thread only.
+     */
+    T& getWriteBuffer() { return buffers[back]; }
+
+    /**
+     * Publishes the value being written, for the writer thread only.
+     *
+     * Returns true if the previously published value was replaced before the
+     * reader could take it.
+     */
+    bool publish()
+    {
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel);
+        back = previous & INDEX;
+        return (previous & FRESH) != 0;
+    }
+
+    /**
+     * Takes the latest published value if it was not taken yet, for the
+     * reader thread only. Returns whether the value read changed.
+     */
+    bool update()
+    {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /**
+     * Returns whether a value was published since the reader last took one.
+     */
+    bool hasUpdate() const { return (middle.load(std::memory_order_relaxed) & FRESH) != 0; }
+
+    /**
+     * Returns the value being read, for the reader thread only.
+     */
+    const T& getReadBuffer() const { return buffers[front]; }
+
+private:
+    // The middle index is stored with a flag telling whether it was published
+    // since the reader last took it
+    static const uint8_t INDEX = 3;
+    static const uint8_t FRESH = 4;
+
+    std::array<T, 3> buffers;
+    uint8_t back = 0;
+    uint8_t front = 1;
+    std::atomic<uint8_t> middle{2};
+};
+
+template <typename T>
+const uint8_t TripleBuffer<T>::INDEX;
+
+template <typename T>
+const uint8_t TripleBuffer<T>::FRESH;
+}  // namespace lz
@@ -0,0 +1,203 @@
+#include <lazarus/WeightedSampler.h>
+
+#include <algorithm>
+#include <sstream>
+
+using namespace lz;
+
+const int DynamicWeightedSampler::MAX_ATTEMPTS;
+
+namespace
+{
+void checkWeight(double weight)
+{
+    if (!(weight >= 0.))
+    {
+        std::stringstream msg;
+        msg << "Invalid weight " << weight << ", weights must not be negative";
+        throw __lz::LazarusException(msg.str());
+    }
+}
+}
+
+AliasTable::AliasTable(const std::vector<double>& weights)
+    : weights(weights)
+{
+    for (double weight : weights)
+    {
+        checkWeight(weight);
+        totalWeight += weight;
+    }
+    if (totalWeight <= 0.)
+        throw __lz::LazarusException("At least one weight must be positive");
+
+    // Vose's method: scale the weights so that their mean is 1, then fill each
+    // column that is below 1 with the excess of a column that is above it
+    size_t n = weights.size();
+    probabilities.resize(n);
+    aliases.resize(n);
+    std::vector<size_t> small, large;
+    for (size_t i = 0; i < n; ++i)
+    {
+        probabilities[i] = weights[i] * n / totalWeight;
+        aliases[i] = i;
+        (probabilities[i] < 1. ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty())
+    {
+        size_t less = small.back();
+        size_t more = large.back();
+        small.pop_back();
+        aliases[less] = more;
+        probabilities[more] -= 1. - probabilities[less];
+        if (probabilities[more] < 1.)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // What is left is 1 up to rounding errors
+    for (size_t i : small)
+        probabilities[i] = 1.;
+    for (size_t i : large)
+        probabilities[i] = 1.;
+}
+
+double AliasTable::getProbability(size_t index) const
+{
+    return weights.at(index) / totalWeight;
+}
+
+size_t AliasTable::pick(double value) const
+{
+    if (probabilities.empty())
+        throw __lz::LazarusException("Cannot sample an empty table");
+
+    size_t column = static_cast<size_t>(value);
+    if (column >= probabilities.size())  // Rounding up to the size
+        column = probabilities.size() - 1;
+    return value - column < probabilities[column] ? column : aliases[column];
+}
+
+DynamicWeightedSampler::DynamicWeightedSampler(const std::vector<double>& weights)
+    : weights(weights)
+{
+    for (double weight : weights)
+    {
+        checkWeight(weight);
+        if (weight > 0.)
+            ++positive;
+    }
+    rebuild();
+}
+
+size_t DynamicWeightedSampler::add(double weight)
+{
+    checkWeight(weight);
+    weights.push_back(weight);
+    if (weight > 0.)
+        ++positive;
+    // The new node covers the range of indices below it that its parent doesn't
+    size_t node = weights.size();
+    double sum = weight;
+    for (size_t child = node - 1; child > node - (node & -node); child -= child & -child)
+        sum += tree[child];
+    tree.push_back(sum);
+    return weights.size() - 1;
+}
+
+void DynamicWeightedSampler::setWeight(size_t index, double weight)
+{
+    checkWeight(weight);
+    double difference = weight - weights.at(index);
+    positive += (weight > 0.) - (weights[index] > 0.);
+    weights[index] = weight;
+    // Without positive weights, rebuilding sets the tree back to exact zeros
+    if (++updates > weights.size() || positive == 0)
+        rebuild();
+    else
+        update(index, difference);
+}
+
+double DynamicWeightedSampler::getWeight(size_t index) const
+{
+    return weights.at(index);
+}
+
+double DynamicWeightedSampler::getTotalWeight() const
+{
+    double total = 0.;
+    for (size_t node = weights.size(); node > 0; node -= node & -node)
+        total += tree[node];
+    // Rounding errors may take the sum of positive weights below zero
+    return std::max(total, 0.);
+}
+
+void DynamicWeightedSampler::update(size_t index, double difference)
+{
+    for (size_t node = index + 1; node < tree.size(); node += node & -node)
+        tree[node] += difference;
+}
+
+size_t DynamicWeightedSampler::find(double value) const
+{
+    // Descend the tree, skipping the subtrees whose weights are all below the value
+    size_t node = 0;
+    size_t step = 1;
+    while (step * 2 < tree.size())
+        step *= 2;
+    for (; step > 0; step /= 2)
+    {
+        size_t next = node + step;
+        if (next < tree.size() && tree[next] <= value)
+        {
+            node = next;
+            value -= tree[next];
+        }
+    }
+    // Rounding errors may go past the last weight
+    return std::min(node, weights.size() - 1);
+}
+
+size_t DynamicWeightedSampler::findLinear(double value) const
+{
+    size_t last = 0;
+    for (size_t index = 0; index < weights.size(); ++index)
+    {
+        if (weights[index] <= 0.)
+            continue;
+        if (value < weights[index])
+            return index;
+        value -= weights[index];
+        last = index;
+    }
+    return last;
+}
+
+double DynamicWeightedSampler::sumWeights() const
+{
+    double total = 0.;
+    for (double weight : weights)
+        total += weight;
+    return total;
+}
+
+void DynamicWeightedSampler::rebuild()
+{
+    // Build the tree in linear time, adding each node to its parent
+    tree.assign(weights.size() + 1, 0.);
+    for (size_t node = 1; node < tree.size(); ++node)
+    {
+        tree[node] += weights[node - 1];
+        size_t parent = node + (node & -node);
+        if (parent < tree.size())
+            tree[parent] += tree[node];
+    }
+    updates = 0;
+}
+
+void DynamicWeightedSampler::checkSample() const
+{
+    if (positive == 0)
+        throw __lz::LazarusException("Cannot sample without positive weights");
+}
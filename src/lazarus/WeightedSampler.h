@@ -0,0 +1,229 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <lazarus/Random.h>
+
+namespace lz
+{
+/**
+ * Samples indices with probabilities proportional to fixed weights.
+ *
+ * The table is built once with Vose's alias method, in linear time, and
+ * then each sample takes constant time regardless of the number of weights,
+ * which makes it suitable for big loot or spawn tables that are rolled often.
+ *
+ * Samples can be drawn from any RandomGenerator, or from lz::Random.
+ *
+ * @see DynamicWeightedSampler
+ * @see WeightedTable
+ */
+class AliasTable
+{
+public:
+    /**
+     * Creates an empty table, which cannot be sampled.
+     */
+    AliasTable() = default;
+
+    /**
+     * Builds the table for the given weights.
+     *
+     * Weights must not be negative, and at least one must be positive.
+     */
+    explicit AliasTable(const std::vector<double>& weights);
+
+    /**
+     * Returns the number of weights of the table.
+     */
+    size_t size() const { return probabilities.size(); }
+
+    /**
+     * Returns the probability of sampling the given index.
+     */
+    double getProbability(size_t index) const;
+
+    /**
+     * Returns a random index, with probability proportional to its weight.
+     */
+    template <typename Generator>
+    size_t sample(Generator& generator) const
+    {
+        return pick(generator.range(0., static_cast<double>(size())));
+    }
+
+    /**
+     * Returns a random index using lz::Random.
+     */
+    size_t sample() const
+    {
+        return pick(Random::range(0., static_cast<double>(size())));
+    }
+
+private:
+    // Chooses an index from a uniform number in [0, size), whose integer part
+    // selects a column and its fractional part chooses between the column and
+    // its alias
+    size_t pick(double value) const;
+
+private:
+    std::vector<double> weights;
+    double totalWeight = 0.;
+    // Probability of keeping each column instead of taking its alias
+    std::vector<double> probabilities;
+    std::vector<size_t> aliases;
+};
+
+/**
+ * Samples indices with probabilities proportional to weights that may change.
+ *
+ * The weights are kept in a Fenwick tree, so both changing a weight and
+ * drawing a sample take logarithmic time. Use it instead of an AliasTable for
+ * tables whose weights change between samples, such as spawn tables that
+ * depend on the monsters already on the level.
+ *
+ * @see AliasTable
+ */
+class DynamicWeightedSampler
+{
+public:
+    DynamicWeightedSampler() = default;
+
+    /**
+     * Creates a sampler with the given weights.
+     */
+    explicit DynamicWeightedSampler(const std::vector<double>& weights);
+
+    /**
+     * Returns the number of weights of the sampler.
+     */
+    size_t size() const { return weights.size(); }
+
+    /**
+     * Adds a weight at the end, and returns its index.
+     */
+    size_t add(double weight);
+
+    /**
+     * Changes the weight of the given index.
+     *
+     * A weight of zero keeps the index, but it will not be sampled.
+     */
+    void setWeight(size_t index, double weight);
+
+    /**
+     * Returns the weight of the given index.
+     */
+    double getWeight(size_t index) const;
+
+    /**
+     * Returns the sum of all the weights.
+     */
+    double getTotalWeight() const;
+
+    /**
+     * Returns a random index, with probability proportional to its weight.
+     */
+    template <typename Generator>
+    size_t sample(Generator& generator) const
+    {
+        return draw([&generator](double total) { return generator.range(0., total); });
+    }
+
+    /**
+     * Returns a random index using lz::Random.
+     */
+    size_t sample() const
+    {
+        return draw([](double total) { return Random::range(0., total); });
+    }
+
+private:
+    // Samples an index with a function that returns a number in [0, total)
+    template <typename Draw>
+    size_t draw(Draw uniform) const
+    {
+        checkSample();
+        // Rounding errors may land on empty weights, which is rare enough to
+        // retry a few times before searching the weights themselves
+        for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt)
+        {
+            size_t index = find(uniform(getTotalWeight()));
+            if (weights[index] > 0.)
+                return index;
+        }
+        return findLinear(uniform(sumWeights()));
+    }
+
+    // Adds the difference to the weight of the index in the tree
+    void update(size_t index, double difference);
+    // Returns the index whose range of cumulative weights contains the value
+    size_t find(double value) const;
+    // Same as find, summing the weights one by one instead of using the tree
+    size_t findLinear(double value) const;
+    double sumWeights() const;
+    void rebuild();
+    void checkSample() const;
+
+private:
+    static const int MAX_ATTEMPTS = 16;
+
+    std::vector<double> weights;
+    // Number of positive weights, which unlike the tree has no rounding errors
+    size_t positive = 0;
+    // Fenwick tree of the weights, indexed from 1
+    std::vector<double> tree{0.};
+    // Updates since the tree was built, to bound the rounding errors
+    size_t updates = 0;
+};
+
+/**
+ * A table of items that are sampled with probabilities proportional to their weights.
+ *
+ * For example, a loot table can be built with
+ * `WeightedTable<std::string> loot({{"gold", 50.}, {"potion", 10.}, {"sword", 1.}})`
+ * and rolled with `loot.sample()`.
+ *
+ * @see AliasTable
+ */
+template <typename T>
+class WeightedTable
+{
+public:
+    /**
+     * Creates a table with the given items and weights.
+     */
+    explicit WeightedTable(std::vector<std::pair<T, double>> entries)
+    {
+        std::vector<double> weights;
+        for (auto& entry : entries)
+        {
+            items.push_back(std::move(entry.first));
+            weights.push_back(entry.second);
+        }
+        table = AliasTable(weights);
+    }
+
+    /**
+     * Returns the number of items in the table.
+     */
+    size_t size() const { return items.size(); }
+
+    /**
+     * Returns a random item, with probability proportional to its weight.
+     */
+    template <typename Generator>
+    const T& sample(Generator& generator) const { return items[table.sample(generator)]; }
+
+    /**
+     * Returns a random item using lz::Random.
+     */
+    const T& sample() const { return items[table.sample()]; }
+
+private:
+    std::vector<T> items;
+    AliasTable table;
+};
+}  // namespace lz
@@ -1,14 +1,69 @@
 #include <lazarus/graphics.h>
 
+#include <algorithm>
 #include <functional>
 #include <cstdlib>
 #include <cmath>
 
+#include <lazarus/ECS/Interpolated.h>
 #include <lazarus/Random.h>
+#include <lazarus/RenderThread.h>
 
 using namespace lz;
 
-void Graphics::WindowLoop()
+namespace
+{
+// Returns the fraction of the budget taken by the duration, clamped to [0, 1]
+float budgetFraction(std::chrono::nanoseconds duration, sf::Time budget)
+{
+    float fraction = static_cast<float>(duration.count()) / 1000.f / budget.asMicroseconds();
+    return std::min(std::max(fraction, 0.f), 1.f);
+}
+
+// What the window shows after a step of the simulation
+struct Frame : RenderSnapshot
+{
+    bool showTimings = false;
+    std::vector<SystemTiming> timings;
+};
+}
+
+void Graphics::drawTimingOverlay(sf::RenderTarget& target,
+                                 const std::vector<lz::SystemTiming>& timings,
+                                 sf::Time budget)
+{
+    const float x = 8.f, y = 8.f;
+    const float width = 200.f, rowHeight = 8.f, spacing = 3.f;
+
+    sf::RectangleShape background(sf::Vector2f(width + 2 * spacing,
+                                               timings.size() * (rowHeight + spacing) + spacing));
+    background.setPosition(x - spacing, y - spacing);
+    background.setFillColor(sf::Color(0, 0, 0, 160));
+    target.draw(background);
+
+    sf::RectangleShape bar, mark(sf::Vector2f(2.f, rowHeight));
+    for (size_t i = 0; i < timings.size(); ++i)
+    {
+        const lz::SystemTiming& timing = timings[i];
+        const float rowY = y + i * (rowHeight + spacing);
+        const float p95 = budgetFraction(timing.p95, budget);
+
+        // Color the median bar by how much of the budget the 95th percentile takes
+        bar.setSize(sf::Vector2f(width * budgetFraction(timing.p50, budget), rowHeight));
+        bar.setPosition(x, rowY);
+        bar.setFillColor(p95 < 0.5f ? sf::Color::Green : (p95 < 1.f ? sf::Color::Yellow : sf::Color::Red));
+        target.draw(bar);
+
+        mark.setPosition(x + width * p95 - 1.f, rowY);
+        mark.setFillColor(sf::Color::White);
+        target.draw(mark);
+        mark.setPosition(x + width * budgetFraction(timing.max, budget) - 1.f, rowY);
+        mark.setFillColor(sf::Color::Red);
+        target.draw(mark);
+    }
+}
+
+void Graphics::WindowLoop(ECSEngine* engine)
 {
     const int window_width = 800;
     const int window_height = 600;
@@ -20,35 +75,71 @@ void Graphics::WindowLoop()
 
     sf::Vector2f direction(Random::range(10., 25), Random::range(10., 25));
     const float velocity = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+    // Drawn between its positions at the last two steps
+    Interpolated position(Transform{window_width / 2.f, window_height / 2.f});
 
     sf::CircleShape ball(ball_radius - 4);
     ball.setOutlineThickness(4);
     ball.setOutlineColor(sf::Color::Black);
-    ball.setFillColor(sf::Color::Yellow);
     ball.setOrigin(ball.getRadius(), ball.getRadius());
-    ball.setPosition(window_width / 2, window_height / 2);
+
+    const sf::Time update_ms = sf::seconds(1.f / 30.f);
+
+    // The window is drawn by the render thread, paced by the vertical sync,
+    // while this thread handles the events and runs the simulation, so its
+    // OpenGL context is handed over to the render thread
+    window.setActive(false);
+    bool active = false;
+    RenderThread<Frame> renderer([&](const Frame& frame, bool)
+    {
+        if (!active)
+            active = window.setActive(true);
+
+        const float alpha = frame.getAlpha(RenderSnapshot::Clock::now());
+        window.clear(sf::Color(30, 30, 120));
+        for (const Sprite& sprite : frame.sprites)
+        {
+            const Transform transform = sprite.transform.at(alpha);
+            ball.setPosition(transform.x, transform.y);
+            ball.setFillColor(sf::Color(sprite.color.r, sprite.color.g, sprite.color.b, sprite.color.a));
+            window.draw(ball);
+        }
+        if (frame.showTimings)
+            drawTimingOverlay(window, frame.timings, update_ms);
+        window.display();
+    }, true);
 
     sf::Clock clock;
     sf::Time elapsed = clock.restart();
-    const sf::Time update_ms = sf::seconds(1.f / 30.f);
-    while (window.isOpen())
+    bool showTimings = false;
+    uint64_t inputs = 0;
+    while (window.isOpen() && renderer.isRunning())
     {
         sf::Event event;
         while (window.pollEvent(event))
         {
+            if (event.type == sf::Event::KeyPressed || event.type == sf::Event::MouseButtonPressed)
+                inputs = renderer.receiveInput();
+
             if ((event.type == sf::Event::Closed) ||
                 ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::Escape)))
             {
+                renderer.stop();
                 window.close();
                 break;
             }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3)
+                showTimings = !showTimings;
         }
+        if (!window.isOpen())
+            break;
 
         elapsed += clock.restart();
+        bool stepped = false;
         while (elapsed >= update_ms)
         {
-            const auto pos = ball.getPosition();
             const auto delta = update_ms.asSeconds() * velocity;
+            const Transform& pos = position.current;
             sf::Vector2f new_pos(pos.x + direction.x * delta, pos.y + direction.y * delta);
 
             if (new_pos.x - ball_radius < 0)
@@ -71,13 +162,41 @@ void Graphics::WindowLoop()
                 direction.y *= -1;
                 new_pos.y = window_height - ball_radius;
             }
-            ball.setPosition(new_pos);
+            position.previous = position.current;
+            position.current.x = new_pos.x;
+            position.current.y = new_pos.y;
+
+            if (engine != nullptr)
+                engine->update(update_ms.asSeconds());
 
             elapsed -= update_ms;
+            stepped = true;
         }
 
-        window.clear(sf::Color(30, 30, 120));
-        window.draw(ball);
-        window.display();
+        if (stepped)
+        {
+            // The time left in the accumulator has passed since the last step
+            Frame& frame = renderer.getSnapshot();
+            frame.sprites.assign(1, Sprite{position, 'o', Color(255, 255, 0)});
+            frame.inputs = inputs;
+            frame.stepTime = RenderSnapshot::Clock::now()
+                             - std::chrono::microseconds(elapsed.asMicroseconds());
+            frame.stepDuration = update_ms.asSeconds();
+            frame.showTimings = showTimings;
+            frame.timings.clear();
+            if (showTimings)
+            {
+                if (engine != nullptr)
+                    frame.timings = engine->getSystemTimings();
+                frame.timings.push_back(renderer.getInputLatency());
+            }
+            renderer.publish();
+        }
+
+        // Events are polled often, so that inputs wait little before the next step
+        sf::sleep(std::min(update_ms - elapsed, sf::milliseconds(1)));
     }
-}
\ No newline at end of file
+
+    // Throws the errors of the render thread, if any
+    renderer.stop();
+}
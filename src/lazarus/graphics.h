@@ -1,7 +1,23 @@
+#pragma once
+
+#include <vector>
+
 #include <SFML/Graphics.hpp>
 
+#include <lazarus/ECS/ECSEngine.h>
+
 namespace Graphics
 {
     // Mock function to test that SFML links correctly
-    void WindowLoop();
+    // If an engine is given, it is updated on every fixed step, and F3 toggles
+    // an overlay with the timings of its updateables and the input latency
+    // The window is drawn by a render thread, from snapshots published after
+    // each step of the simulation, with the ball interpolated between steps
+    void WindowLoop(lz::ECSEngine* engine=nullptr);
+
+    // Draws one bar per updateable with its median update time, and marks for
+    // its 95th percentile and maximum, scaled so the full width is the budget
+    void drawTimingOverlay(sf::RenderTarget& target,
+                           const std::vector<lz::SystemTiming>& timings,
+                           sf::Time budget);
 }
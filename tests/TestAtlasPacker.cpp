@@ -0,0 +1,112 @@
+#include "catch/catch.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include <lazarus/AtlasPacker.h>
+#include <lazarus/Random.h>
+
+using namespace lz;
+
+namespace
+{
+struct PackedRect
+{
+    uint32_t x, y, width, height;
+};
+
+bool overlap(const PackedRect& a, const PackedRect& b)
+{
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+}
+
+TEST_CASE("skyline packing", "[atlas]")
+{
+    SECTION("rectangles do not overlap and stay inside the area")
+    {
+        RandomGenerator random(12345);
+        std::vector<std::pair<uint32_t, uint32_t>> sizes;
+        for (int i = 0; i < 300; ++i)
+            sizes.emplace_back(random.range(4u, 40u), random.range(4u, 40u));
+        std::sort(sizes.begin(), sizes.end(),
+                  [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b)
+                  { return a.second > b.second; });
+
+        SkylinePacker packer(512, 512);
+        std::vector<PackedRect> placed;
+        for (const auto& size : sizes)
+        {
+            PackedRect rect{0, 0, size.first, size.second};
+            REQUIRE(packer.insert(rect.width, rect.height, rect.x, rect.y));
+            REQUIRE(rect.x + rect.width <= 512);
+            REQUIRE(rect.y + rect.height <= 512);
+            for (const PackedRect& other : placed)
+                REQUIRE(!overlap(rect, other));
+            placed.push_back(rect);
+        }
+        REQUIRE(packer.getOccupancy() > 0.75);
+        REQUIRE(packer.getUsedHeight() < 512);
+    }
+    SECTION("tiles of the same size fill the area exactly")
+    {
+        SkylinePacker packer(128, 128);
+        uint32_t x, y;
+        for (int i = 0; i < 256; ++i)
+            REQUIRE(packer.insert(8, 8, x, y));
+        REQUIRE(packer.getOccupancy() == 1.);
+        REQUIRE(!packer.insert(8, 8, x, y));
+        REQUIRE(!packer.insert(1, 1, x, y));
+
+        packer.clear();
+        REQUIRE(packer.getUsedHeight() == 0);
+        REQUIRE(packer.insert(128, 128, x, y));
+        REQUIRE(!SkylinePacker(16, 16).insert(17, 1, x, y));
+    }
+}
+
+TEST_CASE("glyph tables", "[atlas]")
+{
+    GlyphTable table;
+    table.set('A', AtlasRect{0, 8, 0, 8, 12});
+    table.set(0x2588, AtlasRect{0, 16, 0, 8, 12});
+    table.set(0x1F600, AtlasRect{1, 0, 0, 16, 16});
+    REQUIRE(table.size() == 3);
+    REQUIRE(table.getPageCount() == 2);
+
+    SECTION("lookups")
+    {
+        REQUIRE(table.find('A')->x == 8);
+        REQUIRE(table.find(0x2588)->x == 16);
+        REQUIRE(table.find(0x1F600)->page == 1);
+        REQUIRE(table.find('B') == nullptr);
+        REQUIRE(table.find(0x1F601) == nullptr);
+        REQUIRE(table.find(0x100000) == nullptr);
+
+        table.set('A', AtlasRect{0, 24, 0, 8, 12});
+        table.set(0x1F600, AtlasRect{1, 16, 0, 16, 16});
+        REQUIRE(table.size() == 3);
+        REQUIRE(table.find('A')->x == 24);
+        REQUIRE(table.find(0x1F600)->x == 16);
+        REQUIRE_THROWS(table.set('C', AtlasRect{0, 0, 0, 0, 12}));
+    }
+    SECTION("saving and loading")
+    {
+        std::stringstream stream;
+        table.save(stream);
+        GlyphTable loaded;
+        REQUIRE(loaded.load(stream));
+        REQUIRE(loaded.size() == 3);
+        REQUIRE(loaded.getPageCount() == 2);
+        REQUIRE(loaded.find('A')->height == 12);
+        REQUIRE(loaded.find(0x1F600)->width == 16);
+
+        std::string truncated = stream.str().substr(0, stream.str().size() - 4);
+        std::stringstream bad(truncated);
+        REQUIRE(!loaded.load(bad));
+        REQUIRE(loaded.size() == 0);
+        std::stringstream garbage("not a table");
+        REQUIRE(!loaded.load(garbage));
+    }
+}
@@ -0,0 +1,132 @@
+#include "catch/catch.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include <lazarus/BatchRandom.h>
+#include <lazarus/Random.h>
+
+using namespace lz;
+
+namespace
+{
+std::vector<uint32_t> bitsWith(BatchRandom::Kernel kernel, size_t count)
+{
+    BatchRandom generator(12345, 3);
+    generator.setKernel(kernel);
+    std::vector<uint32_t> bits(count);
+    generator.fillBits(bits.data(), bits.size());
+    return bits;
+}
+}
+
+TEST_CASE("batch random stream", "[random]")
+{
+    SECTION("the stream is the Philox stream of the seed")
+    {
+        BatchRandom generator(12345, 3);
+        std::vector<uint32_t> bits(8);
+        generator.fillBits(bits.data(), bits.size());
+        for (uint32_t block = 0; block < 2; ++block)
+        {
+            Philox4x32::Counter expected = Philox4x32::block({block, 0, 0, BatchRandom::DOMAIN_TAG}, {12345, 3});
+            for (int word = 0; word < 4; ++word)
+                REQUIRE(bits[4 * block + word] == expected[word]);
+        }
+    }
+    SECTION("all kernels produce the same stream")
+    {
+        // An odd number of words exercises the partial blocks
+        std::vector<uint32_t> scalar = bitsWith(BatchRandom::Kernel::Scalar, 1003);
+        REQUIRE(bitsWith(BatchRandom::Kernel::SSE2, 1003) == scalar);
+        REQUIRE(bitsWith(BatchRandom::Kernel::AVX2, 1003) == scalar);
+    }
+    SECTION("splitting a fill between calls gives the same values")
+    {
+        BatchRandom generator(12345, 3);
+        std::vector<uint32_t> bits(1003);
+        generator.fillBits(bits.data(), 5);
+        generator.fillBits(bits.data() + 5, 90);
+        generator.fillBits(bits.data() + 95, bits.size() - 95);
+        REQUIRE(bits == bitsWith(BatchRandom::Kernel::Scalar, 1003));
+    }
+    SECTION("streams are independent")
+    {
+        BatchRandom first(12345, 0), second(12345, 1);
+        uint32_t a, b;
+        first.fillBits(&a, 1);
+        second.fillBits(&b, 1);
+        REQUIRE(a != b);
+
+        // Counter generators with the same seed and stream get other numbers
+        CounterRandomGenerator counter = counterRandom(12345, 0, 0, 1);
+        std::vector<uint32_t> batch(8), counted(8);
+        second.seed(12345, 1);
+        second.fillBits(batch.data(), batch.size());
+        for (uint32_t& word : counted)
+            word = counter.getEngine()();
+        REQUIRE(batch != counted);
+    }
+}
+
+TEST_CASE("batch random distributions", "[random]")
+{
+    BatchRandom generator(42);
+
+    SECTION("integer ranges")
+    {
+        std::vector<int> values(10000);
+        generator.fillRange(values, 5, -2);
+        std::vector<int> counts(8, 0);
+        for (int value : values)
+        {
+            REQUIRE((value >= -2 && value <= 5));
+            ++counts[value + 2];
+        }
+        for (int count : counts)
+            REQUIRE(count > 1000);
+
+        generator.fillRange(values, 3, 3);
+        for (int value : values)
+            REQUIRE(value == 3);
+    }
+    SECTION("the full integer range")
+    {
+        std::vector<int> values(100);
+        generator.fillRange(values, INT32_MIN, INT32_MAX);
+        REQUIRE(values[0] != values[1]);
+    }
+    SECTION("uniform floats")
+    {
+        std::vector<float> values(10000);
+        generator.fillUniform(values, 2.f, 4.f);
+        double sum = 0.;
+        for (float value : values)
+        {
+            REQUIRE((value >= 2.f && value < 4.f));
+            sum += value;
+        }
+        REQUIRE(sum / values.size() == Approx(3.).epsilon(0.01));
+
+        // Ranges much smaller than their bounds round the largest values up to b
+        generator.fillUniform(values, 1e8f, 1e8f + 8.f);
+        for (float value : values)
+            REQUIRE((value >= 1e8f && value < 1e8f + 8.f));
+    }
+    SECTION("normal floats")
+    {
+        std::vector<float> values(10001);
+        generator.fillNormal(values, 10.f, 2.f);
+        double sum = 0., squares = 0.;
+        for (float value : values)
+        {
+            REQUIRE(std::isfinite(value));
+            sum += value;
+            squares += value * value;
+        }
+        double mean = sum / values.size();
+        double stdev = std::sqrt(squares / values.size() - mean * mean);
+        REQUIRE(mean == Approx(10.).epsilon(0.01));
+        REQUIRE(stdev == Approx(2.).epsilon(0.05));
+    }
+}
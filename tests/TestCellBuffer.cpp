@@ -0,0 +1,128 @@
+#include "catch/catch.hpp"
+
+#include <utility>
+
+#include <lazarus/CellBuffer.h>
+
+using namespace lz;
+
+TEST_CASE("cell buffers", "[graphics]")
+{
+    CellBuffer buffer(10, 4);
+    REQUIRE(buffer.getWidth() == 10);
+    REQUIRE(buffer.getHeight() == 4);
+    REQUIRE(buffer.getCells().size() == 40);
+    REQUIRE(buffer(9, 3) == Cell());
+
+    SECTION("setting cells")
+    {
+        buffer.set(2, 1, '@', Color(255, 255, 0), Color::Black);
+        REQUIRE(buffer.at(2, 1).glyph == '@');
+        REQUIRE(buffer.at(2, 1).foreground == Color(255, 255, 0));
+        REQUIRE(buffer.getRow(1)[2].glyph == '@');
+
+        // Out of bounds writes are ignored, and checked reads throw
+        buffer.set(10, 0, '#', Color::White, Color::Black);
+        buffer.set(0, 4, '#', Color::White, Color::Black);
+        REQUIRE_THROWS(buffer.at(10, 0));
+        REQUIRE_THROWS(buffer.at(0, 4));
+
+        Cell wall;
+        wall.glyph = '#';
+        buffer.fill(wall);
+        for (const Cell& cell : buffer.getCells())
+            REQUIRE(cell == wall);
+    }
+    SECTION("printing text")
+    {
+        REQUIRE(buffer.print(1, 2, "Hello", Color::White, Color::Transparent) == 5);
+        REQUIRE(buffer(1, 2).glyph == 'H');
+        REQUIRE(buffer(5, 2).glyph == 'o');
+        REQUIRE(buffer(5, 2).background == Color::Transparent);
+        REQUIRE(buffer(6, 2).glyph == ' ');
+
+        // Clipped at the right edge, and bytes above 127 are kept as glyphs
+        REQUIRE(buffer.print(7, 0, "abc\xDB\xDB") == 3);
+        REQUIRE(buffer(9, 0).glyph == 'c');
+        REQUIRE(buffer.print(0, 3, "\xDB") == 1);
+        REQUIRE(buffer(0, 3).glyph == 0xDB);
+        REQUIRE(buffer.print(0, 4, "x") == 0);
+    }
+    SECTION("resizing keeps the overlapping cells")
+    {
+        buffer.print(0, 0, "0123456789");
+        buffer.print(0, 3, "last");
+        Cell blank;
+        blank.glyph = '.';
+        buffer.resize(5, 6, blank);
+        REQUIRE(buffer.getCells().size() == 30);
+        REQUIRE(buffer(4, 0).glyph == '4');
+        REQUIRE(buffer(3, 3).glyph == 't');
+        REQUIRE(buffer(0, 5).glyph == '.');
+    }
+}
+
+TEST_CASE("dirty cells", "[graphics]")
+{
+    CellBuffer buffer(10, 4);
+    REQUIRE(buffer.isDirty());
+    REQUIRE(buffer.getDirtyColumns(3) == std::make_pair<size_t, size_t>(0, 10));
+
+    buffer.clearDirty();
+    REQUIRE(!buffer.isDirty());
+    for (size_t y = 0; y < 4; ++y)
+    {
+        auto columns = buffer.getDirtyColumns(y);
+        REQUIRE(columns.first >= columns.second);
+    }
+
+    SECTION("writes mark the range of columns of their rows")
+    {
+        buffer.set(7, 1, '@', Color::White, Color::Black);
+        buffer(2, 1).glyph = 'k';
+        buffer.print(3, 2, "ab");
+        REQUIRE(buffer.isDirty());
+        REQUIRE(buffer.getDirtyColumns(1) == std::make_pair<size_t, size_t>(2, 8));
+        REQUIRE(buffer.getDirtyColumns(2) == std::make_pair<size_t, size_t>(3, 5));
+        auto clean = buffer.getDirtyColumns(0);
+        REQUIRE(clean.first >= clean.second);
+    }
+    SECTION("reads and ignored writes keep the buffer clean")
+    {
+        const CellBuffer& constant = buffer;
+        REQUIRE(constant(1, 1).glyph == ' ');
+        REQUIRE(constant.at(2, 2).glyph == ' ');
+        buffer.set(20, 1, '@', Color::White, Color::Black);
+        REQUIRE(buffer.print(0, 9, "out") == 0);
+        REQUIRE(!buffer.isDirty());
+    }
+    SECTION("whole buffer changes mark every row")
+    {
+        buffer.fill();
+        REQUIRE(buffer.getDirtyColumns(2) == std::make_pair<size_t, size_t>(0, 10));
+        buffer.clearDirty();
+        buffer.resize(12, 2);
+        REQUIRE(buffer.getDirtyColumns(1) == std::make_pair<size_t, size_t>(0, 12));
+    }
+    SECTION("copies only mark the cells that differ")
+    {
+        CellBuffer copy(buffer);
+        copy.set(3, 1, '@', Color::White, Color::Black);
+        copy.set(6, 1, '@', Color::White, Color::Black);
+        buffer.assign(copy);
+        REQUIRE(buffer(3, 1).glyph == '@');
+        REQUIRE(buffer.getDirtyColumns(1) == std::make_pair<size_t, size_t>(3, 7));
+        auto clean = buffer.getDirtyColumns(2);
+        REQUIRE(clean.first >= clean.second);
+
+        buffer.clearDirty();
+        buffer.assign(copy);
+        REQUIRE(!buffer.isDirty());
+
+        copy.resize(5, 5);
+        buffer.assign(copy);
+        REQUIRE(buffer.getWidth() == 5);
+        REQUIRE(buffer.getDirtyColumns(4) == std::make_pair<size_t, size_t>(0, 5));
+        REQUIRE(buffer.getCells() == copy.getCells());
+    }
+}
@@ -0,0 +1,124 @@
+#include "catch/catch.hpp"
+
+#include <string>
+#include <vector>
+
+#include <lazarus/Dice.h>
+
+using namespace lz;
+
+TEST_CASE("dice expressions", "[random]")
+{
+    RandomGenerator generator(12345);
+
+    SECTION("bounds and mean")
+    {
+        Dice dice("3d6+2");
+        REQUIRE(dice.getMin() == 5);
+        REQUIRE(dice.getMax() == 20);
+        REQUIRE(dice.getMean() == Approx(12.5));
+
+        Dice complex(" (1d4 + 1) * 10 - d% ");
+        REQUIRE(complex.getMin() == -80);
+        REQUIRE(complex.getMax() == 49);
+        REQUIRE(complex.getMean() == Approx(35. - 50.5));
+
+        REQUIRE(Dice("-2d4").getMax() == -2);
+        REQUIRE(Dice("7").getMean() == 7.);
+    }
+    SECTION("rolls stay within the bounds")
+    {
+        for (auto expression : {"3d6+2", "d20", "2D8-1", "(1d4+1)*10-d%", "100d6", "-2d4*3"})
+        {
+            Dice dice(expression);
+            for (int i = 0; i < 1000; ++i)
+            {
+                long value = dice.roll(generator);
+                REQUIRE(value >= dice.getMin());
+                REQUIRE(value <= dice.getMax());
+            }
+        }
+    }
+    SECTION("small rolls match rolling each die")
+    {
+        RandomGenerator reference(12345);
+        Dice dice("3d6+2");
+        for (int i = 0; i < 10; ++i)
+            REQUIRE(dice.roll(generator) == static_cast<long>(reference.roll(6, 3)) + 2);
+    }
+    SECTION("big rolls follow the distribution of the sum")
+    {
+        Dice dice("100d6");
+        const int samples = 20000;
+        double sum = 0., squares = 0.;
+        for (int i = 0; i < samples; ++i)
+        {
+            double value = static_cast<double>(dice.roll(generator));
+            sum += value;
+            squares += value * value;
+        }
+        double mean = sum / samples;
+        // The variance of a d6 is 35 / 12
+        REQUIRE(mean == Approx(350.).epsilon(0.005));
+        REQUIRE(squares / samples - mean * mean == Approx(100. * 35. / 12.).epsilon(0.05));
+    }
+    SECTION("rolls too big for their distribution are approximated")
+    {
+        Dice dice("1000d100");
+        REQUIRE(dice.getMin() == 1000);
+        REQUIRE(dice.getMax() == 100000);
+        const int samples = 20000;
+        double sum = 0., squares = 0.;
+        for (int i = 0; i < samples; ++i)
+        {
+            long value = dice.roll(generator);
+            REQUIRE(value >= dice.getMin());
+            REQUIRE(value <= dice.getMax());
+            sum += value;
+            squares += static_cast<double>(value) * value;
+        }
+        double mean = sum / samples;
+        REQUIRE(mean == Approx(50500.).epsilon(0.005));
+        REQUIRE(squares / samples - mean * mean == Approx(1000. * 9999. / 12.).epsilon(0.05));
+
+        // Few dice with many sides are rolled one by one, and the distribution
+        // of many dice with few sides is not computed when it is too costly
+        for (auto expression : {"8d100000", "65535d2"})
+        {
+            Dice big(expression);
+            long value = big.roll(generator);
+            REQUIRE(value >= big.getMin());
+            REQUIRE(value <= big.getMax());
+        }
+    }
+    SECTION("rolls using lz::Random")
+    {
+        Random::seed(1);
+        long value = Dice("2d6").roll();
+        REQUIRE((value >= 2 && value <= 12));
+    }
+    SECTION("invalid expressions")
+    {
+        for (auto expression : {"", "3d", "d0", "2d6+", "(1d4", "1d4)", "x", "3d6 2", "99999999999", "4294967296"})
+            REQUIRE_THROWS_AS(Dice(expression), __lz::LazarusException);
+        // Nesting is limited, so data files cannot overflow the stack of the parser
+        REQUIRE_THROWS_AS(Dice(std::string(100000, '(') + "1" + std::string(100000, ')')), __lz::LazarusException);
+        REQUIRE_THROWS_AS(Dice(std::string(100000, '-') + "1"), __lz::LazarusException);
+        REQUIRE(Dice(std::string(64, '(') + "1" + std::string(64, ')')).getMax() == 1);
+        // Values that do not fit in a long
+        for (auto expression : {"99999999*99999999*99999999", "100000d1000000*100000d1000000*d1000000"})
+            REQUIRE_THROWS_AS(Dice(expression), __lz::LazarusException);
+    }
+    SECTION("big constants")
+    {
+        REQUIRE(Dice("500000000").getMax() == 500000000);
+        REQUIRE(Dice("1d6+999999999").getMin() == 1000000000);
+    }
+    SECTION("the registry compiles each expression once")
+    {
+        const Dice& first = Dice::get("4d6");
+        const Dice& second = Dice::get("4d6");
+        REQUIRE(&first == &second);
+        REQUIRE(first.getExpression() == "4d6");
+    }
+}
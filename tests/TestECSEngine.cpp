@@ -1,5 +1,9 @@
 #include "catch/catch.hpp"
 
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
 #include <lazarus/ECS/ECSEngine.h>
 #include <lazarus/common.h>
 
@@ -196,6 +200,105 @@ TEST_CASE("event management")
     }
 }
 
+// Appends its tag to a shared log when receiving an event, and optionally cancels it
+class OrderedListener : public EventListener<TestEvent>
+{
+public:
+    OrderedListener(std::vector<int>& log, int tag, bool cancels=false)
+        : log(log)
+        , tag(tag)
+        , cancels(cancels)
+    {
+    }
+
+    virtual void receive(ECSEngine& engine, const TestEvent& event)
+    {
+        log.push_back(tag);
+        if (cancels)
+            engine.cancelEvent();
+    }
+
+private:
+    std::vector<int>& log;
+    int tag;
+    bool cancels;
+};
+
+TEST_CASE("event priorities and cancellation")
+{
+    ECSEngine engine;
+    std::vector<int> log;
+    OrderedListener low(log, 1), normal(log, 2), high(log, 3), otherNormal(log, 4);
+    engine.subscribe<TestEvent>(&low, -5);
+    engine.subscribe<TestEvent>(&normal);
+    engine.subscribe<TestEvent>(&high, 10);
+    engine.subscribe<TestEvent>(&otherNormal);
+    SECTION("listeners receive events by priority")
+    {
+        REQUIRE(engine.emit(TestEvent{0}));
+        REQUIRE(log == std::vector<int>{3, 2, 4, 1});
+    }
+    SECTION("cancelled events do not reach lower priorities")
+    {
+        OrderedListener shield(log, 5, true);
+        engine.subscribe<TestEvent>(&shield, 1);
+        REQUIRE_FALSE(engine.emit(TestEvent{0}));
+        REQUIRE(log == std::vector<int>{3, 5});
+        // Cancellation only affects the event it was called for
+        log.clear();
+        engine.unsubscribe<TestEvent>(&shield);
+        REQUIRE(engine.emit(TestEvent{0}));
+        REQUIRE(log.size() == 4);
+    }
+    SECTION("listeners that throw do not leave the event cancelled")
+    {
+        struct Failing : EventListener<TestEvent>
+        {
+            void receive(ECSEngine& engine, const TestEvent&) override
+            {
+                engine.cancelEvent();
+                throw std::runtime_error("failed");
+            }
+        } failing;
+        engine.subscribe<TestEvent>(&failing, 20);
+        REQUIRE_THROWS_AS(engine.emit(TestEvent{0}), std::runtime_error);
+        engine.unsubscribe<TestEvent>(&failing);
+        REQUIRE(engine.emit(TestEvent{0}));
+        REQUIRE(log == std::vector<int>{3, 2, 4, 1});
+
+        // Nor the outer event, when the failing dispatch was nested in it
+        struct Relay : EventListener<TestEvent>, EventListener<TestComponent>
+        {
+            void receive(ECSEngine& engine, const TestEvent&) override
+            {
+                try
+                {
+                    engine.emit(TestComponent(0));
+                }
+                catch (const std::runtime_error&)
+                {
+                }
+            }
+            void receive(ECSEngine& engine, const TestComponent&) override
+            {
+                engine.cancelEvent();
+                throw std::runtime_error("failed");
+            }
+        } relay;
+        engine.subscribe<TestEvent>(&relay, 20);
+        engine.subscribe<TestComponent>(&relay);
+        log.clear();
+        REQUIRE(engine.emit(TestEvent{0}));
+        REQUIRE(log == std::vector<int>{3, 2, 4, 1});
+    }
+    SECTION("unsubscribed listeners stop receiving events")
+    {
+        engine.unsubscribe<TestEvent>(&normal);
+        engine.emit(TestEvent{0});
+        REQUIRE(log == std::vector<int>{3, 4, 1});
+    }
+}
+
 TEST_CASE("updateable management")
 {
     ECSEngine engine;
@@ -232,3 +335,185 @@ TEST_CASE("garbage collector")
     engine.update();
     REQUIRE(engine.getEntity(id) == nullptr);
 }
+
+TEST_CASE("engine statistics")
+{
+    ECSEngine engine;
+    TestSystem system, other;
+    engine.subscribe<TestEvent>(&system);
+    engine.subscribe<TestEvent>(&other);
+    Entity* entity = engine.addEntity();
+    entity->addComponent<TestComponent>(0);
+    entity->addComponent<TestComponent2>(0);
+    engine.addEntity()->addComponent<TestComponent>(0);
+    engine.addEntity()->markForDeletion();
+    SECTION("event counters")
+    {
+        engine.emit(TestEvent{1});
+        engine.emit(TestEvent{2});
+        engine.emit(TestComponent(0));  // Event without listeners
+        EngineStats stats = engine.stats();
+        REQUIRE(stats.events.size() == 2);
+        auto found = std::find_if(stats.events.begin(), stats.events.end(),
+                                  [](const EventStats& s) { return s.name == typeid(TestEvent).name(); });
+        REQUIRE(found != stats.events.end());
+        REQUIRE(found->emitted == 2);
+        REQUIRE(found->delivered == 4);
+        REQUIRE(found->listenerTime.count() >= 0);
+    }
+    SECTION("query counters")
+    {
+        engine.entitiesWithComponents<TestComponent>();
+        engine.entitiesWithComponents<TestComponent>();
+        engine.entitiesWithComponents<TestComponent, TestComponent2>();
+        EngineStats stats = engine.stats();
+        REQUIRE(stats.queries.size() == 2);
+        for (const auto& query : stats.queries)
+        {
+            if (query.name == typeid(TestComponent).name())
+            {
+                REQUIRE(query.calls == 2);
+                REQUIRE(query.visited == 6);
+                REQUIRE(query.matched == 4);
+            }
+            else
+            {
+                REQUIRE(query.calls == 1);
+                REQUIRE(query.visited == 3);
+                REQUIRE(query.matched == 1);
+            }
+        }
+    }
+    SECTION("garbage collector counters")
+    {
+        engine.update();
+        engine.update();
+        EngineStats stats = engine.stats();
+        REQUIRE(stats.garbage.passes == 2);
+        REQUIRE(stats.garbage.collected == 1);
+        REQUIRE(stats.garbage.lastCollected == 0);
+    }
+    SECTION("nested events are timed once")
+    {
+        // Emits a slow event when receiving a test event
+        struct Relay : EventListener<TestEvent>, EventListener<TestComponent>
+        {
+            void receive(ECSEngine& engine, const TestEvent&) override { engine.emit(TestComponent(0)); }
+            void receive(ECSEngine&, const TestComponent&) override
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            }
+        } relay;
+        engine.subscribe<TestEvent>(&relay);
+        engine.subscribe<TestComponent>(&relay);
+        engine.emit(TestEvent{1});
+
+        EngineStats stats = engine.stats();
+        REQUIRE(stats.events.size() == 2);
+        for (const auto& event : stats.events)
+        {
+            if (event.name == typeid(TestComponent).name())
+                REQUIRE(event.listenerTime >= std::chrono::milliseconds(30));
+            else
+                REQUIRE(event.listenerTime < std::chrono::milliseconds(30));
+        }
+    }
+    SECTION("resetting counters")
+    {
+        engine.emit(TestEvent{1});
+        engine.update();
+        engine.resetStats();
+        EngineStats stats = engine.stats();
+        REQUIRE(stats.events.empty());
+        REQUIRE(stats.queries.empty());
+        REQUIRE(stats.garbage.passes == 0);
+    }
+}
+
+TEST_CASE("engine random streams")
+{
+    ECSEngine engine, other;
+    engine.setWorkerCount(2);
+    other.setWorkerCount(2);
+    engine.seedRandom(42);
+    other.seedRandom(42);
+
+    SECTION("engines with the same seed produce the same streams")
+    {
+        for (int i = 0; i < 10; ++i)
+            REQUIRE(engine.getRandom().range(0, 1000) == other.getRandom().range(0, 1000));
+    }
+    SECTION("the main thread gets the main generator")
+    {
+        REQUIRE(&engine.getThreadRandom() == &engine.getRandom());
+    }
+    SECTION("each worker gets its own generator")
+    {
+        std::mutex mutex;
+        std::vector<RandomGenerator*> generators;
+        engine.getJobSystem().parallelFor(0, 64, 1, [&](size_t)
+        {
+            RandomGenerator& generator = engine.getThreadRandom();
+            generator.range(0, 100);
+            std::lock_guard<std::mutex> lock(mutex);
+            generators.push_back(&generator);
+        });
+        REQUIRE(generators.size() == 64);
+        for (auto generator : generators)
+        {
+            bool isMain = generator == &engine.getRandom();
+            REQUIRE((isMain || generator->getSeed() != engine.getRandom().getSeed()));
+        }
+    }
+    SECTION("generators cannot be seeded during an update")
+    {
+        struct Reseeder : Updateable
+        {
+            void update(ECSEngine& engine) override
+            {
+                try
+                {
+                    engine.seedRandom(7);
+                }
+                catch (const __lz::LazarusException&)
+                {
+                    rejected = true;
+                }
+            }
+
+            bool rejected = false;
+        } reseeder;
+        engine.registerUpdateable(&reseeder);
+        engine.update();
+        REQUIRE(reseeder.rejected);
+        REQUIRE_NOTHROW(engine.seedRandom(7));
+    }
+}
+
+TEST_CASE("entity random generators")
+{
+    // Rolls for each entity, with the entities split among the workers
+    auto rollAll = [](unsigned workers)
+    {
+        ECSEngine engine;
+        engine.setWorkerCount(workers);
+        engine.seedRandom(7);
+        engine.update();
+        std::vector<ulong> rolls(200);
+        engine.getJobSystem().parallelFor(0, rolls.size(), 8, [&](size_t i)
+        {
+            rolls[i] = engine.getEntityRandom(i).roll(20, 3);
+        });
+        return rolls;
+    };
+
+    std::vector<ulong> serial = rollAll(0);
+    REQUIRE(rollAll(1) == serial);
+    REQUIRE(rollAll(3) == serial);
+
+    ECSEngine engine;
+    engine.seedRandom(7);
+    auto before = engine.getEntityRandom(1).range(0, 1000000);
+    engine.update();
+    REQUIRE(engine.getEntityRandom(1).range(0, 1000000) != before);
+}
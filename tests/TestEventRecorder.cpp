@@ -0,0 +1,242 @@
+#include "catch/catch.hpp"
+
+#include <sstream>
+#include <vector>
+
+#include <lazarus/ECS.h>
+#include <lazarus/Random.h>
+#include <lazarus/common.h>
+
+using namespace lz;
+
+struct MoveEvent
+{
+    int dx;
+    int dy;
+};
+
+struct AttackEvent
+{
+    Identifier target;
+    float damage;
+};
+
+// Logs every received event, and re-emits a move as an attack when updated
+class RecordingSystem : public Updateable,
+                        public EventListener<MoveEvent>,
+                        public EventListener<AttackEvent>
+{
+public:
+    virtual void update(ECSEngine& engine)
+    {
+        log.push_back("tick");
+        engine.emit(AttackEvent{1, 0.5f});
+    }
+
+    virtual void receive(ECSEngine& engine, const MoveEvent& event)
+    {
+        std::stringstream entry;
+        entry << "move " << event.dx << " " << event.dy;
+        log.push_back(entry.str());
+    }
+
+    virtual void receive(ECSEngine& engine, const AttackEvent& event)
+    {
+        std::stringstream entry;
+        entry << "attack " << event.target;
+        log.push_back(entry.str());
+    }
+
+    std::vector<std::string> log;
+};
+
+static void setUp(ECSEngine& engine, RecordingSystem& system)
+{
+    engine.subscribe<MoveEvent>(&system);
+    engine.subscribe<AttackEvent>(&system);
+    engine.registerUpdateable(&system);
+}
+
+TEST_CASE("recording and replaying events")
+{
+    std::stringstream log(std::ios::in | std::ios::out | std::ios::binary);
+    ECSEngine engine;
+    RecordingSystem system;
+    setUp(engine, system);
+
+    EventRecorder recorder(log);
+    recorder.registerEvent<MoveEvent>("MoveEvent");
+    recorder.registerEvent<AttackEvent>("AttackEvent");
+    recorder.begin(1234);
+    engine.setEventRecorder(&recorder);
+
+    engine.emit(MoveEvent{1, 0});
+    engine.emit(AttackEvent{7, 2.f});
+    engine.update(0.5);
+    engine.emit(MoveEvent{0, -1});
+    engine.update();
+    engine.update();
+    recorder.end();
+
+    SECTION("replaying reproduces the session")
+    {
+        ECSEngine other;
+        RecordingSystem otherSystem;
+        setUp(other, otherSystem);
+
+        EventReplayer replayer(log);
+        replayer.registerEvent<MoveEvent>("MoveEvent");
+        replayer.registerEvent<AttackEvent>("AttackEvent");
+        Random::seed(1);
+        REQUIRE(replayer.begin() == 1234);
+        REQUIRE(Random::getSeed() == 1234);
+        // Events emitted during updates are not recorded, so they are not duplicated
+        REQUIRE(replayer.replay(other) == 3);
+        REQUIRE(otherSystem.log == system.log);
+        REQUIRE(other.getTime() == Approx(0.5));
+    }
+    SECTION("replaying tick by tick")
+    {
+        ECSEngine other;
+        RecordingSystem otherSystem;
+        setUp(other, otherSystem);
+
+        EventReplayer replayer(log);
+        replayer.registerEvent<MoveEvent>("MoveEvent");
+        replayer.registerEvent<AttackEvent>("AttackEvent");
+        replayer.begin();
+        REQUIRE(replayer.step(other));
+        REQUIRE(otherSystem.log.size() == 4);
+        REQUIRE(otherSystem.log[0] == "move 1 0");
+        REQUIRE(otherSystem.log[1] == "attack 7");
+        REQUIRE(otherSystem.log[2] == "tick");
+        REQUIRE(replayer.step(other));
+        REQUIRE(replayer.step(other));
+        REQUIRE_FALSE(replayer.step(other));
+    }
+    SECTION("replaying requires the recorded types")
+    {
+        ECSEngine other;
+        EventReplayer replayer(log);
+        replayer.registerEvent<MoveEvent>("MoveEvent");
+        REQUIRE_THROWS_AS(replayer.begin(), __lz::LazarusException);
+    }
+    SECTION("replaying requires matching type sizes")
+    {
+        EventReplayer replayer(log);
+        replayer.registerEvent<MoveEvent>("MoveEvent");
+        replayer.registerEvent<MoveEvent>("AttackEvent");
+        REQUIRE_THROWS_AS(replayer.begin(), __lz::LazarusException);
+    }
+}
+
+TEST_CASE("recorder edge cases")
+{
+    std::stringstream log(std::ios::in | std::ios::out | std::ios::binary);
+    EventRecorder recorder(log);
+    recorder.registerEvent<MoveEvent>("MoveEvent");
+    SECTION("unregistered events are not recorded")
+    {
+        recorder.begin(0);
+        recorder.record(AttackEvent{1, 1.f});
+        recorder.record(MoveEvent{2, 3});
+        recorder.end();
+
+        ECSEngine engine;
+        RecordingSystem system;
+        engine.subscribe<MoveEvent>(&system);
+        EventReplayer replayer(log);
+        replayer.registerEvent<MoveEvent>("MoveEvent");
+        replayer.begin();
+        REQUIRE_FALSE(replayer.step(engine));
+        REQUIRE(system.log.size() == 1);
+        REQUIRE(system.log[0] == "move 2 3");
+    }
+    SECTION("types cannot be registered after beginning")
+    {
+        recorder.begin(0);
+        REQUIRE_THROWS_AS(recorder.registerEvent<AttackEvent>("AttackEvent"),
+                          __lz::LazarusException);
+    }
+    SECTION("types and names can only be registered once")
+    {
+        REQUIRE_THROWS_AS(recorder.registerEvent<MoveEvent>("OtherMove"), __lz::LazarusException);
+        REQUIRE_THROWS_AS(recorder.registerEvent<AttackEvent>("MoveEvent"), __lz::LazarusException);
+        recorder.registerEvent<AttackEvent>("AttackEvent");
+
+        // The IDs stay contiguous, so the replayer finds both types
+        recorder.begin(0);
+        recorder.record(MoveEvent{2, 3});
+        recorder.record(AttackEvent{4, 1.f});
+        recorder.end();
+
+        ECSEngine engine;
+        RecordingSystem system;
+        setUp(engine, system);
+        EventReplayer replayer(log);
+        replayer.registerEvent<MoveEvent>("MoveEvent");
+        replayer.registerEvent<AttackEvent>("AttackEvent");
+        replayer.begin();
+        replayer.replay(engine);
+        REQUIRE(system.log == std::vector<std::string>{"move 2 3", "attack 4"});
+    }
+    SECTION("truncated logs end at the last complete record")
+    {
+        recorder.begin(0);
+        recorder.record(MoveEvent{2, 3});
+        recorder.tick();
+
+        ECSEngine engine;
+        EventReplayer replayer(log);
+        replayer.registerEvent<MoveEvent>("MoveEvent");
+        replayer.begin();
+        REQUIRE(replayer.replay(engine) == 1);
+    }
+    SECTION("streams without a log are rejected")
+    {
+        std::stringstream garbage("not a log");
+        EventReplayer replayer(garbage);
+        REQUIRE_THROWS_AS(replayer.begin(), __lz::LazarusException);
+    }
+}
+
+TEST_CASE("replaying seeds the engine generators")
+{
+    // Draws from the generator of the engine on every move
+    struct RollingSystem : EventListener<MoveEvent>
+    {
+        void receive(ECSEngine& engine, const MoveEvent&) override
+        {
+            rolls.push_back(engine.getRandom().range(0, 1000000));
+        }
+
+        std::vector<int> rolls;
+    };
+
+    std::stringstream log(std::ios::in | std::ios::out | std::ios::binary);
+    ECSEngine engine;
+    RollingSystem system;
+    engine.subscribe<MoveEvent>(&system);
+    engine.seedRandom(4321);
+
+    EventRecorder recorder(log);
+    recorder.registerEvent<MoveEvent>("MoveEvent");
+    recorder.begin(4321);
+    engine.setEventRecorder(&recorder);
+    for (int i = 0; i < 5; ++i)
+    {
+        engine.emit(MoveEvent{i, 0});
+        engine.update();
+    }
+    recorder.end();
+
+    ECSEngine other;
+    other.seedRandom(1);
+    RollingSystem otherSystem;
+    other.subscribe<MoveEvent>(&otherSystem);
+    EventReplayer replayer(log);
+    replayer.registerEvent<MoveEvent>("MoveEvent");
+    REQUIRE(replayer.begin(other) == 4321);
+    REQUIRE(replayer.replay(other) == 5);
+    REQUIRE(otherSystem.rolls == system.rolls);
+}
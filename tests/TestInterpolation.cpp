@@ -0,0 +1,88 @@
+#include "catch/catch.hpp"
+
+#include <chrono>
+
+#include <lazarus/ECS/ECSEngine.h>
+#include <lazarus/ECS/Interpolated.h>
+#include <lazarus/ECS/InterpolationSystem.h>
+#include <lazarus/RenderThread.h>
+
+using namespace lz;
+
+namespace
+{
+// Moves every interpolated entity to the right on each update
+class DriftSystem : public Updateable
+{
+public:
+    virtual void update(ECSEngine& engine)
+    {
+        engine.applyToEach<Interpolated>([](Entity*, Interpolated* transform)
+        {
+            transform->current.x += 10.f;
+        });
+    }
+
+    virtual SystemAccess getAccess() const
+    {
+        return SystemAccess().writes<Interpolated>();
+    }
+};
+}
+
+TEST_CASE("interpolating transforms", "[graphics]")
+{
+    Transform from{0.f, 10.f, 350.f, 1.f};
+    Transform to{20.f, 30.f, 10.f, 3.f};
+
+    Transform half = interpolate(from, to, 0.5f);
+    REQUIRE(half.x == Approx(10.f));
+    REQUIRE(half.y == Approx(20.f));
+    REQUIRE(half.scale == Approx(2.f));
+    // Rotations turn the shortest way, here through 0 degrees
+    REQUIRE(half.rotation == Approx(360.f));
+    REQUIRE(interpolate(to, from, 0.5f).rotation == Approx(0.f));
+    REQUIRE(interpolate(from, to, 0.f).x == Approx(0.f));
+    REQUIRE(interpolate(from, to, 1.f).y == Approx(30.f));
+
+    Interpolated component(from);
+    component.current = to;
+    REQUIRE(component.at(0.25f).x == Approx(5.f));
+    component.teleport(from);
+    REQUIRE(component.at(0.75f).x == Approx(0.f));
+}
+
+TEST_CASE("interpolation system", "[graphics]")
+{
+    ECSEngine engine;
+    InterpolationSystem interpolation;
+    DriftSystem drift;
+    engine.registerUpdateable(&interpolation);
+    engine.registerUpdateable(&drift);
+
+    Entity* entity = engine.addEntity();
+    entity->addComponent<Interpolated>(Transform{5.f, 0.f});
+    Interpolated* transform = entity->get<Interpolated>();
+
+    // The previous transform is kept before the entity moves
+    engine.update(1. / 30.);
+    REQUIRE(transform->previous.x == Approx(5.f));
+    REQUIRE(transform->current.x == Approx(15.f));
+    engine.update(1. / 30.);
+    REQUIRE(transform->previous.x == Approx(15.f));
+    REQUIRE(transform->at(0.5f).x == Approx(20.f));
+    REQUIRE(interpolation.getName() == "InterpolationSystem");
+}
+
+TEST_CASE("interpolation alpha of snapshots", "[graphics]")
+{
+    RenderSnapshot snapshot;
+    const auto now = RenderSnapshot::Clock::now();
+    REQUIRE(snapshot.getAlpha(now) == 1.f);
+
+    snapshot.stepDuration = 0.1;
+    snapshot.stepTime = now - std::chrono::milliseconds(25);
+    REQUIRE(snapshot.getAlpha(now) == Approx(0.25f));
+    REQUIRE(snapshot.getAlpha(now + std::chrono::seconds(1)) == 1.f);
+    REQUIRE(snapshot.getAlpha(now - std::chrono::seconds(1)) == 0.f);
+}
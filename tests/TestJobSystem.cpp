@@ -0,0 +1,143 @@
+#include "catch/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <lazarus/ECS/ECSEngine.h>
+#include <lazarus/JobSystem.h>
+#include <lazarus/common.h>
+
+using namespace lz;
+
+TEST_CASE("spawning and waiting for jobs")
+{
+    // Without workers, jobs run on the waiting thread
+    unsigned workers = GENERATE(0, 1, 3);
+    JobSystem jobs(workers);
+    REQUIRE(jobs.getWorkerCount() == workers);
+    REQUIRE(jobs.currentWorker() == 0);
+    SECTION("all jobs of a group run")
+    {
+        std::atomic<int> total{0};
+        JobCounter counter;
+        for (int i = 1; i <= 100; ++i)
+            jobs.spawn([i, &total] { total += i; }, &counter);
+        jobs.wait(counter);
+        REQUIRE(counter.isDone());
+        REQUIRE(total == 5050);
+    }
+    SECTION("jobs can spawn and wait for other jobs")
+    {
+        std::atomic<int> total{0};
+        JobCounter outer;
+        for (int i = 0; i < 8; ++i)
+        {
+            jobs.spawn([&jobs, &total]
+            {
+                JobCounter inner;
+                for (int j = 0; j < 8; ++j)
+                    jobs.spawn([&total] { ++total; }, &inner);
+                jobs.wait(inner);
+            }, &outer);
+        }
+        jobs.wait(outer);
+        REQUIRE(total == 64);
+    }
+    SECTION("dependencies")
+    {
+        std::vector<int> order;
+        std::mutex mutex;
+        auto log = [&](int step)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(step);
+        };
+        JobCounter first, second, done;
+        jobs.spawn([&] { log(1); }, &first);
+        jobs.spawn([&] { log(1); }, &first);
+        jobs.spawnAfter(first, [&] { log(2); }, &second);
+        jobs.spawnAfter(second, [&] { log(3); }, &done);
+        jobs.wait(done);
+        REQUIRE(order == std::vector<int>{1, 1, 2, 3});
+        // Dependencies that are already done do not delay the job
+        jobs.spawnAfter(first, [&] { log(4); }, &done);
+        jobs.wait(done);
+        REQUIRE(order.back() == 4);
+    }
+    SECTION("exceptions are rethrown by wait")
+    {
+        JobCounter counter;
+        jobs.spawn([] { throw std::runtime_error("job failed"); }, &counter);
+        jobs.spawn([] {}, &counter);
+        REQUIRE_THROWS_AS(jobs.wait(counter), std::runtime_error);
+        // The error is only reported once
+        jobs.spawn([] {}, &counter);
+        REQUIRE_NOTHROW(jobs.wait(counter));
+    }
+    SECTION("parallel for")
+    {
+        std::vector<int> values(1000, 0);
+        jobs.parallelFor(0, values.size(), 64, [&values](size_t i) { values[i] = static_cast<int>(i); });
+        REQUIRE(std::accumulate(values.begin(), values.end(), 0) == 499500);
+        // Empty ranges do nothing
+        jobs.parallelFor(5, 5, 1, [&values](size_t i) { values[i] = -1; });
+        REQUIRE(values[5] == 5);
+    }
+}
+
+TEST_CASE("worker threads")
+{
+    JobSystem jobs(2);
+    std::vector<unsigned> workerIds(64, 99);
+    jobs.parallelFor(0, workerIds.size(), 1, [&](size_t i) { workerIds[i] = jobs.currentWorker(); });
+    for (auto id : workerIds)
+        REQUIRE(id <= 2);
+}
+
+TEST_CASE("destroying a job system runs its queued jobs")
+{
+    for (unsigned workers : {0u, 2u})
+    {
+        std::atomic<int> runs{0};
+        JobCounter counter;
+        JobCounter released;
+        {
+            JobSystem jobs(workers);
+            for (int i = 0; i < 16; ++i)
+            {
+                jobs.spawn([&runs]
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    ++runs;
+                }, &counter);
+            }
+            jobs.spawnAfter(counter, [&runs] { ++runs; }, &released);
+        }
+        REQUIRE(counter.isDone());
+        REQUIRE(released.isDone());
+        REQUIRE(runs == 17);
+    }
+}
+
+TEST_CASE("engine job system")
+{
+    ECSEngine engine;
+    engine.setWorkerCount(2);
+    REQUIRE(engine.getJobSystem().getWorkerCount() == 2);
+    engine.setWorkerCount(0);
+    REQUIRE(engine.getJobSystem().getWorkerCount() == 0);
+
+    // Jobs of the current update or event may still run on the job system
+    struct Resizer : EventListener<int>
+    {
+        void receive(ECSEngine& engine, const int&) override { engine.setWorkerCount(1); }
+    } resizer;
+    engine.subscribe<int>(&resizer);
+    REQUIRE_THROWS_AS(engine.emit(1), __lz::LazarusException);
+    REQUIRE(engine.getJobSystem().getWorkerCount() == 0);
+}
@@ -0,0 +1,119 @@
+#include "catch/catch.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include <lazarus/JobSystem.h>
+#include <lazarus/Noise.h>
+#include <lazarus/common.h>
+
+using namespace lz;
+
+namespace
+{
+NoiseSettings settingsFor(NoiseSettings::Type type, NoiseSettings::Fractal fractal=NoiseSettings::Fractal::None)
+{
+    NoiseSettings settings;
+    settings.type = type;
+    settings.fractal = fractal;
+    settings.frequency = 0.05f;
+    return settings;
+}
+}
+
+TEST_CASE("noise values", "[noise]")
+{
+    const NoiseSettings::Type types[] = {NoiseSettings::Type::Value, NoiseSettings::Type::Perlin,
+                                         NoiseSettings::Type::Simplex};
+
+    SECTION("values are in range and depend on the seed")
+    {
+        for (auto type : types)
+        {
+            Noise noise(12345, settingsFor(type)), other(54321, settingsFor(type));
+            int different = 0;
+            for (int i = 0; i < 1000; ++i)
+            {
+                float x = i * 0.37f - 100.f, y = i * 0.71f - 200.f;
+                float value = noise.get(x, y);
+                REQUIRE(std::fabs(value) <= 1.f);
+                REQUIRE(std::fabs(noise.get(x, y, i * 0.13f)) <= 1.f);
+                REQUIRE(value == noise.get(x, y));
+                different += value != other.get(x, y);
+            }
+            REQUIRE(different > 900);
+        }
+    }
+    SECTION("noise is continuous")
+    {
+        for (auto type : types)
+        {
+            Noise noise(12345, settingsFor(type));
+            for (int i = 0; i < 1000; ++i)
+            {
+                float x = i * 0.37f - 100.f, y = i * 0.71f - 200.f;
+                REQUIRE(std::fabs(noise.get(x, y) - noise.get(x + 0.01f, y)) < 0.05f);
+            }
+        }
+    }
+    SECTION("gradient noise is zero on the grid")
+    {
+        NoiseSettings settings = settingsFor(NoiseSettings::Type::Perlin);
+        settings.frequency = 1.f;
+        Noise noise(12345, settings);
+        REQUIRE(noise.get(3.f, -7.f) == 0.f);
+        REQUIRE(noise.get(3.f, -7.f, 2.f) == 0.f);
+    }
+    SECTION("fractals and warping stay in range")
+    {
+        for (auto fractal : {NoiseSettings::Fractal::FBm, NoiseSettings::Fractal::Ridged})
+        {
+            NoiseSettings settings = settingsFor(NoiseSettings::Type::Simplex, fractal);
+            settings.warp = 4.f;
+            Noise noise(12345, settings);
+            for (int i = 0; i < 1000; ++i)
+            {
+                REQUIRE(std::fabs(noise.get(i * 0.37f, i * 0.71f)) <= 1.f);
+                REQUIRE(std::fabs(noise.get(i * 0.37f, i * 0.71f, i * 0.5f)) <= 1.f);
+            }
+
+            settings.octaves = 0;
+            REQUIRE_THROWS_AS(Noise(12345, settings), __lz::LazarusException);
+        }
+        NoiseSettings single = settingsFor(NoiseSettings::Type::Simplex, NoiseSettings::Fractal::None);
+        single.octaves = 0;
+        REQUIRE_NOTHROW(Noise(12345, single));
+    }
+}
+
+TEST_CASE("noise rows and tiles", "[noise]")
+{
+    const size_t width = 67, height = 31;
+
+    SECTION("all instruction sets give the values of get")
+    {
+        for (auto type : {NoiseSettings::Type::Value, NoiseSettings::Type::Perlin})
+        {
+            NoiseSettings settings = settingsFor(type, NoiseSettings::Fractal::FBm);
+            Noise noise(12345, settings);
+            for (auto level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2})
+            {
+                noise.setSimdLevel(level);
+                std::vector<float> row(width);
+                noise.fillRow(row.data(), row.size(), -10.5f, 3.25f, 0.75f);
+                for (size_t i = 0; i < width; ++i)
+                    REQUIRE(row[i] == Approx(noise.get(-10.5f + i * 0.75f, 3.25f)).margin(1e-6));
+            }
+        }
+    }
+    SECTION("parallel tiles are the same as serial tiles")
+    {
+        Noise noise(12345, settingsFor(NoiseSettings::Type::Perlin, NoiseSettings::Fractal::Ridged));
+        std::vector<float> serial(width * height), parallel(width * height);
+        noise.fillTile(serial.data(), width, height, 5.f, -5.f, 0.5f);
+        JobSystem jobs(3);
+        noise.fillTile(parallel.data(), width, height, 5.f, -5.f, 0.5f, &jobs);
+        REQUIRE(parallel == serial);
+        REQUIRE(serial[width * 2 + 3] == noise.get(5.f + 3 * 0.5f, -5.f + 2 * 0.5f));
+    }
+}
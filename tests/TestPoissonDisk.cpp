@@ -0,0 +1,164 @@
+#include "catch/catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <lazarus/PoissonDisk.h>
+#include <lazarus/Random.h>
+
+using namespace lz;
+
+namespace
+{
+using Point = PoissonDisk::Point;
+
+float distance(Point a, Point b)
+{
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+// Returns the smallest distance between two points
+float minDistance(const std::vector<Point>& points)
+{
+    float closest = INFINITY;
+    for (size_t i = 0; i < points.size(); ++i)
+        for (size_t j = i + 1; j < points.size(); ++j)
+            closest = std::min(closest, distance(points[i], points[j]));
+    return closest;
+}
+
+// Returns the largest distance from the center of a cell to its closest point
+float largestGap(const std::vector<Point>& points, int width, int height,
+                 const PoissonDisk::Mask& passable=PoissonDisk::Mask())
+{
+    float gap = 0.f;
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+        {
+            if (passable && !passable(x, y))
+                continue;
+            float closest = INFINITY;
+            for (const Point& point : points)
+                closest = std::min(closest, distance(point, Point{x + 0.5f, y + 0.5f}));
+            gap = std::max(gap, closest);
+        }
+    return gap;
+}
+}
+
+TEST_CASE("poisson disk sampling", "[poisson]")
+{
+    SECTION("points keep the radius and cover the map")
+    {
+        PoissonDisk sampler(64, 48, 3.f);
+        auto points = sampler.generate(12345);
+        REQUIRE(points.size() > 100);
+        REQUIRE(minDistance(points) >= 3.f);
+        for (const Point& point : points)
+            REQUIRE((point.x >= 0.f && point.x < 64.f && point.y >= 0.f && point.y < 48.f));
+        // Bridson's algorithm leaves no hole where another point would fit
+        REQUIRE(largestGap(points, 64, 48) < 2 * 3.f + 1.f);
+    }
+    SECTION("the same seed gives the same points")
+    {
+        PoissonDisk sampler(50, 50, 2.5f);
+        auto first = sampler.generate(7), second = sampler.generate(7), other = sampler.generate(8);
+        REQUIRE(first.size() == second.size());
+        for (size_t i = 0; i < first.size(); ++i)
+            REQUIRE((first[i].x == second[i].x && first[i].y == second[i].y));
+        REQUIRE((other.size() != first.size() || other[0].x != first[0].x));
+
+        Random::seed(12345);
+        auto fromRandom = sampler.generate();
+        Random::seed(12345);
+        REQUIRE(sampler.generate().size() == fromRandom.size());
+    }
+    SECTION("points stay on passable cells, in every area")
+    {
+        // Two rooms separated by a wall wider than twice the radius
+        auto passable = [](int x, int y) { return x < 20 || x >= 40; };
+        PoissonDisk sampler(60, 30, 2.f);
+        sampler.setMask(passable);
+        auto points = sampler.generate(12345);
+        int left = 0, right = 0;
+        for (const Point& point : points)
+        {
+            REQUIRE(passable(static_cast<int>(point.x), static_cast<int>(point.y)));
+            (point.x < 20 ? left : right)++;
+        }
+        REQUIRE(left > 20);
+        REQUIRE(right > 20);
+        REQUIRE(minDistance(points) >= 2.f);
+        REQUIRE(largestGap(points, 60, 30, passable) < 2 * 2.f + 1.f);
+
+        PoissonDisk blocked(10, 10, 2.f);
+        blocked.setMask([](int, int) { return false; });
+        REQUIRE(blocked.generate(1).empty());
+    }
+    SECTION("radii can change over the map")
+    {
+        // Sparse on the right, dense on the left
+        auto radius = [](float x, float) { return x < 40.f ? 2.f : 5.f; };
+        PoissonDisk sampler(80, 40, 2.f, 5.f, radius);
+        auto points = sampler.generate(12345);
+        int left = 0, right = 0;
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            (points[i].x < 40.f ? left : right)++;
+            for (size_t j = i + 1; j < points.size(); ++j)
+            {
+                float limit = std::max(radius(points[i].x, points[i].y), radius(points[j].x, points[j].y));
+                REQUIRE(distance(points[i], points[j]) >= limit);
+            }
+        }
+        REQUIRE(left > 3 * right);
+    }
+    SECTION("invalid parameters")
+    {
+        REQUIRE_THROWS(PoissonDisk(0, 10, 1.f));
+        REQUIRE_THROWS(PoissonDisk(10, 10, 0.f));
+        REQUIRE_THROWS(PoissonDisk(10, 10, 3.f, 2.f, PoissonDisk::RadiusFunction()));
+        REQUIRE_THROWS(BlueNoiseTile(4, 3.f, 1));
+    }
+}
+
+TEST_CASE("blue noise tiles", "[poisson]")
+{
+    BlueNoiseTile tile(32, 3.f, 12345);
+    REQUIRE(tile.getPoints().size() > 50);
+
+    SECTION("the points keep the radius across the edges of the tile")
+    {
+        const auto& points = tile.getPoints();
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            REQUIRE((points[i].x >= 0.f && points[i].x < 32.f && points[i].y >= 0.f && points[i].y < 32.f));
+            for (size_t j = i + 1; j < points.size(); ++j)
+            {
+                float dx = std::abs(points[i].x - points[j].x);
+                float dy = std::abs(points[i].y - points[j].y);
+                dx = std::min(dx, 32.f - dx);
+                dy = std::min(dy, 32.f - dy);
+                REQUIRE(std::hypot(dx, dy) >= 3.f);
+            }
+        }
+    }
+    SECTION("filled maps keep the radius between tiles")
+    {
+        for (int offset : {0, 5, -13})
+        {
+            auto points = tile.fill(100, 70, PoissonDisk::Mask(), offset, 2 * offset);
+            REQUIRE(minDistance(points) >= 3.f - 1e-4f);
+            REQUIRE(largestGap(points, 100, 70) < 2 * 3.f + 1.f);
+        }
+    }
+    SECTION("filled maps skip impassable cells")
+    {
+        auto passable = [](int x, int y) { return (x / 10 + y / 10) % 2 == 0; };
+        auto points = tile.fill(64, 64, passable);
+        REQUIRE(!points.empty());
+        for (const Point& point : points)
+            REQUIRE(passable(static_cast<int>(point.x), static_cast<int>(point.y)));
+    }
+}
@@ -1,6 +1,13 @@
 #include "catch/catch.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <list>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
 #include <typeinfo>
 #include <vector>
 
@@ -107,3 +114,337 @@ TEST_CASE("range types", "[random]")
     REQUIRE(typeid(Random::range(static_cast<long>(0), static_cast<int>(2))) == typeid(long));
     REQUIRE(typeid(Random::range(static_cast<char>(0), static_cast<double>(2))) == typeid(double));
 }
+
+TEST_CASE("random generator instances", "[random]")
+{
+    SECTION("same seed gives the same sequence as the static generator")
+    {
+        Random::seed(TEST_SEED);
+        RandomGenerator generator(TEST_SEED);
+        for (int i = 0; i < 10; ++i)
+            REQUIRE(generator.range(0, 3) == Random::range(0, 3));
+    }
+    SECTION("generators do not interfere with each other")
+    {
+        RandomGenerator first(TEST_SEED), second(TEST_SEED);
+        std::vector<int> sequence;
+        for (int i = 0; i < 10; ++i)
+            sequence.push_back(first.range(0, 100));
+        second.range(0, 100);
+        first.seed(TEST_SEED);
+        for (int i = 0; i < 10; ++i)
+            REQUIRE(first.range(0, 100) == sequence[i]);
+        REQUIRE(second.getSeed() == TEST_SEED);
+    }
+    SECTION("split streams are reproducible and distinct")
+    {
+        RandomGenerator parent(TEST_SEED);
+        parent.range(0, 100);  // Splitting does not depend on the state
+        REQUIRE(parent.split(1).getSeed() == RandomGenerator(TEST_SEED).split(1).getSeed());
+        REQUIRE(parent.split(1).getSeed() != parent.split(2).getSeed());
+        REQUIRE(parent.split(1).getSeed() != RandomGenerator(TEST_SEED + 1).split(1).getSeed());
+    }
+}
+
+TEST_CASE("random engines", "[random]")
+{
+    SECTION("xoshiro256** reference outputs")
+    {
+        Xoshiro256StarStar engine(1, 2, 3, 4);
+        REQUIRE(engine() == 11520ull);
+        REQUIRE(engine() == 0ull);
+        REQUIRE(engine() == 1509978240ull);
+        REQUIRE(engine() == 1215971899390074240ull);
+    }
+    SECTION("PCG32 reference outputs")
+    {
+        Pcg32 engine(42, 54);
+        std::vector<uint32_t> sequence{0xa15c02b7, 0x7b47f409, 0xba1d3330,
+                                       0x83d2f293, 0xbfa4784b, 0xcbed606e};
+        for (auto expected : sequence)
+            REQUIRE(engine() == expected);
+    }
+    SECTION("SplitMix64 reference outputs")
+    {
+        SplitMix64 engine(1234567);
+        REQUIRE(engine() == 6457827717110365317ull);
+        REQUIRE(engine() == 3203168211198807973ull);
+        REQUIRE(engine() == 9817491932198370423ull);
+    }
+    SECTION("generators work with every engine")
+    {
+        BasicRandomGenerator<Xoshiro256StarStar> xoshiro(TEST_SEED);
+        BasicRandomGenerator<Pcg32> pcg(TEST_SEED);
+        BasicRandomGenerator<SplitMix64> splitMix(TEST_SEED);
+        for (int i = 0; i < 1000; ++i)
+        {
+            int value = xoshiro.range(-3, 3);
+            REQUIRE((value >= -3 && value <= 3));
+            REQUIRE(pcg.roll(6, 2) >= 2);
+            REQUIRE(splitMix.range(0., 1.) < 1.);
+        }
+    }
+}
+
+TEST_CASE("selecting the engine of Random", "[random]")
+{
+    Random::seed(TEST_SEED);
+    Random::setEngine(Random::Engine::Pcg32);
+    REQUIRE(Random::getEngine() == Random::Engine::Pcg32);
+    REQUIRE(Random::getSeed() == TEST_SEED);
+
+    BasicRandomGenerator<Pcg32> reference(TEST_SEED);
+    for (int i = 0; i < 10; ++i)
+        REQUIRE(Random::range(0, 100) == reference.range(0, 100));
+    REQUIRE(Random::oneIn(3) == reference.oneIn(3));
+    REQUIRE(Random::normal(0., 1.) == reference.normal(0., 1.));
+
+    Random::setEngine(Random::Engine::Mt19937);
+    Random::seed(TEST_SEED);
+    REQUIRE(Random::range(0, 3) == 3);
+}
+
+TEST_CASE("counter-based random generators", "[random]")
+{
+    SECTION("Philox4x32-10 known answers")
+    {
+        REQUIRE((Philox4x32::block({0, 0, 0, 0}, {0, 0})
+                 == Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+        REQUIRE((Philox4x32::block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                                   {0xa4093822, 0x299f31d0})
+                 == Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+    }
+    SECTION("discard skips values")
+    {
+        Philox4x32 engine(7, 1, 2, 3), skipped(7, 1, 2, 3);
+        for (int i = 0; i < 10; ++i)
+            engine();
+        skipped.discard(10);
+        REQUIRE(engine() == skipped());
+    }
+    SECTION("values are a function of the keys")
+    {
+        auto first = counterRandom(TEST_SEED, 42, 7);
+        auto second = counterRandom(TEST_SEED, 42, 7);
+        for (int i = 0; i < 20; ++i)
+            REQUIRE(first.range(0, 1000000) == second.range(0, 1000000));
+    }
+    SECTION("different keys give different values")
+    {
+        std::vector<unsigned> values{
+            counterRandom(TEST_SEED, 42, 7).getEngine()(),
+            counterRandom(TEST_SEED + 1, 42, 7).getEngine()(),
+            counterRandom(TEST_SEED, 43, 7).getEngine()(),
+            counterRandom(TEST_SEED, 42, 8).getEngine()(),
+            counterRandom(TEST_SEED, 42, 7, 1).getEngine()()};
+        for (size_t i = 0; i < values.size(); ++i)
+            for (size_t j = i + 1; j < values.size(); ++j)
+                REQUIRE(values[i] != values[j]);
+    }
+}
+
+TEST_CASE("saving and restoring random state", "[random]")
+{
+    SECTION("generators repeat their values after loading a state")
+    {
+        BasicRandomGenerator<Xoshiro256StarStar> xoshiro(TEST_SEED);
+        BasicRandomGenerator<Pcg32> pcg(TEST_SEED);
+        RandomGenerator mt(TEST_SEED);
+        CounterRandomGenerator philox = counterRandom(TEST_SEED, 42, 7);
+        xoshiro.range(0, 10);
+        pcg.range(0, 10);
+        mt.range(0, 10);
+        philox.range(0, 10);
+
+        auto xoshiroState = xoshiro.saveState();
+        auto pcgState = pcg.saveState();
+        auto mtState = mt.saveState();
+        auto philoxState = philox.saveState();
+        std::vector<long> values;
+        for (int i = 0; i < 50; ++i)
+        {
+            values.push_back(xoshiro.range(0, 1000000));
+            values.push_back(pcg.range(0, 1000000));
+            values.push_back(mt.range(0, 1000000));
+            values.push_back(philox.range(0, 1000000));
+        }
+
+        BasicRandomGenerator<Xoshiro256StarStar> xoshiroCopy;
+        BasicRandomGenerator<Pcg32> pcgCopy;
+        RandomGenerator mtCopy;
+        CounterRandomGenerator philoxCopy;
+        xoshiroCopy.loadState(xoshiroState);
+        pcgCopy.loadState(pcgState);
+        mtCopy.loadState(mtState);
+        philoxCopy.loadState(philoxState);
+        REQUIRE(mtCopy.getSeed() == TEST_SEED);
+        for (int i = 0; i < 50; ++i)
+        {
+            REQUIRE(xoshiroCopy.range(0, 1000000) == values[4 * i]);
+            REQUIRE(pcgCopy.range(0, 1000000) == values[4 * i + 1]);
+            REQUIRE(mtCopy.range(0, 1000000) == values[4 * i + 2]);
+            REQUIRE(philoxCopy.range(0, 1000000) == values[4 * i + 3]);
+        }
+    }
+    SECTION("the static generator restores its engine and sequence")
+    {
+        Random::setEngine(Random::Engine::Xoshiro256StarStar);
+        Random::seed(TEST_SEED);
+        Random::range(0, 10);
+        auto state = Random::saveState();
+        std::vector<int> values;
+        for (int i = 0; i < 20; ++i)
+            values.push_back(Random::range(0, 1000000));
+
+        Random::setEngine(Random::Engine::Mt19937);
+        Random::seed(TEST_SEED + 1);
+        Random::loadState(state);
+        REQUIRE(Random::getEngine() == Random::Engine::Xoshiro256StarStar);
+        REQUIRE(Random::getSeed() == TEST_SEED);
+        for (int i = 0; i < 20; ++i)
+            REQUIRE(Random::range(0, 1000000) == values[i]);
+
+        state[0] = 0xFF;
+        REQUIRE_THROWS(Random::loadState(state));
+        Random::setEngine(Random::Engine::Mt19937);
+    }
+    SECTION("discard matches drawing values")
+    {
+        Pcg32 pcg(42, 54), pcgSkipped(42, 54);
+        SplitMix64 splitMix(TEST_SEED), splitMixSkipped(TEST_SEED);
+        Xoshiro256StarStar xoshiro(TEST_SEED), xoshiroSkipped(TEST_SEED);
+        for (int i = 0; i < 1000; ++i)
+        {
+            pcg();
+            splitMix();
+            xoshiro();
+        }
+        pcgSkipped.discard(1000);
+        splitMixSkipped.discard(1000);
+        xoshiroSkipped.discard(1000);
+        REQUIRE(pcg() == pcgSkipped());
+        REQUIRE(splitMix() == splitMixSkipped());
+        REQUIRE(xoshiro() == xoshiroSkipped());
+
+        BasicRandomGenerator<Pcg32> generator(TEST_SEED), skipped(TEST_SEED);
+        for (int i = 0; i < 100; ++i)
+            generator.getEngine()();
+        skipped.discard(100);
+        REQUIRE(generator.range(0, 1000000) == skipped.range(0, 1000000));
+    }
+    SECTION("xoshiro256** jumps ahead by 2^128 and 2^192 values")
+    {
+        // Computed by raising the transition matrix of the engine to the power
+        Xoshiro256StarStar jumped(1, 2, 3, 4);
+        jumped.jump();
+        Xoshiro256StarStar expected(10122426448480695249ull, 8079205330032121950ull,
+                                    7289065458748526725ull, 9477464255293849680ull);
+        REQUIRE(jumped() == expected());
+
+        Xoshiro256StarStar first(1, 2, 3, 4), second(1, 2, 3, 4);
+        first.longJump();
+        first();
+        second();
+        second.longJump();
+        REQUIRE(first() == second());
+    }
+}
+
+TEST_CASE("shuffling and sampling", "[random]")
+{
+    BasicRandomGenerator<Pcg32> generator(TEST_SEED);
+
+    SECTION("shuffles are uniform permutations")
+    {
+        std::map<std::vector<int>, int> counts;
+        const int trials = 60000;
+        for (int i = 0; i < trials; ++i)
+        {
+            std::vector<int> items{1, 2, 3};
+            generator.shuffle(items);
+            ++counts[items];
+        }
+        REQUIRE(counts.size() == 6);
+        for (const auto& count : counts)
+            REQUIRE(std::abs(count.second - trials / 6) < trials / 60);
+
+        std::vector<int> empty;
+        generator.shuffle(empty);
+        REQUIRE(empty.empty());
+    }
+    SECTION("sampled indices are distinct and uniform")
+    {
+        // Sizes that keep the taken indices in a list, a bitmap and a hash set
+        for (size_t n : {1000, 1000000})
+            for (size_t k : {0, 1, 20, 100, 1000})
+            {
+                auto indices = generator.sampleIndices(n, k);
+                REQUIRE(indices.size() == k);
+                std::set<size_t> distinct(indices.begin(), indices.end());
+                REQUIRE(distinct.size() == k);
+                REQUIRE((k == 0 || *distinct.rbegin() < n));
+            }
+
+        std::vector<int> counts(10, 0);
+        const int trials = 50000;
+        for (int i = 0; i < trials; ++i)
+            for (size_t index : generator.sampleIndices(10, 3))
+                ++counts[index];
+        for (int count : counts)
+            REQUIRE(std::abs(count - trials * 3 / 10) < trials * 3 / 100);
+
+        REQUIRE_THROWS(generator.sampleIndices(5, 6));
+    }
+    SECTION("samples of containers")
+    {
+        std::vector<std::string> names{"orc", "goblin", "troll", "kobold"};
+        auto picked = generator.sample(names, 2);
+        REQUIRE(picked.size() == 2);
+        REQUIRE(picked[0] != picked[1]);
+        for (const auto& name : picked)
+            REQUIRE(std::find(names.begin(), names.end(), name) != names.end());
+    }
+    SECTION("reservoir samples are uniform")
+    {
+        std::vector<int> counts(10, 0);
+        const int trials = 50000;
+        for (int i = 0; i < trials; ++i)
+        {
+            std::istringstream stream("0 1 2 3 4 5 6 7 8 9");
+            auto picked = generator.sample(std::istream_iterator<int>(stream),
+                                           std::istream_iterator<int>(), 3);
+            REQUIRE(picked.size() == 3);
+            for (int value : picked)
+                ++counts[value];
+        }
+        for (int count : counts)
+            REQUIRE(std::abs(count - trials * 3 / 10) < trials * 3 / 100);
+
+        // Random access sequences skip the items that are not picked
+        std::vector<int> items(1000);
+        for (int i = 0; i < 1000; ++i)
+            items[i] = i;
+        std::vector<int> buckets(10, 0);
+        for (int i = 0; i < trials / 10; ++i)
+            for (int value : generator.sample(items.begin(), items.end(), 5))
+                ++buckets[value / 100];
+        for (int count : buckets)
+            REQUIRE(std::abs(count - trials / 20) < trials / 200);
+
+        std::list<int> few{1, 2};
+        REQUIRE(generator.sample(few.begin(), few.end(), 5).size() == 2);
+    }
+    SECTION("the static generator is reproducible")
+    {
+        std::vector<int> first(50), second(50);
+        for (int i = 0; i < 50; ++i)
+            first[i] = second[i] = i;
+        Random::seed(TEST_SEED);
+        Random::shuffle(first);
+        auto indices = Random::sampleIndices(100000, 20);
+        Random::seed(TEST_SEED);
+        Random::shuffle(second.begin(), second.end());
+        REQUIRE(first == second);
+        REQUIRE(Random::sampleIndices(100000, 20) == indices);
+    }
+}
@@ -0,0 +1,172 @@
+#include "catch/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <lazarus/RenderThread.h>
+#include <lazarus/TripleBuffer.h>
+
+using namespace lz;
+
+namespace
+{
+// Waits until the condition holds, or gives up after a few seconds
+template <typename Condition>
+bool eventually(Condition condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+struct Pair
+{
+    int first = 0;
+    int second = 0;
+};
+}
+
+TEST_CASE("triple buffers", "[graphics]")
+{
+    SECTION("the reader gets the latest published value")
+    {
+        TripleBuffer<int> buffer(-1);
+        REQUIRE(buffer.getReadBuffer() == -1);
+        REQUIRE(!buffer.update());
+
+        buffer.getWriteBuffer() = 1;
+        REQUIRE(!buffer.publish());
+        REQUIRE(buffer.hasUpdate());
+        REQUIRE(buffer.update());
+        REQUIRE(buffer.getReadBuffer() == 1);
+        REQUIRE(!buffer.update());
+
+        buffer.getWriteBuffer() = 2;
+        buffer.publish();
+        buffer.getWriteBuffer() = 3;
+        REQUIRE(buffer.publish());
+        REQUIRE(buffer.update());
+        REQUIRE(buffer.getReadBuffer() == 3);
+        REQUIRE(!buffer.hasUpdate());
+    }
+    SECTION("values are never read while being written")
+    {
+        TripleBuffer<Pair> buffer;
+        const int count = 100000;
+        std::thread writer([&buffer]
+        {
+            for (int i = 1; i <= count; ++i)
+            {
+                Pair& pair = buffer.getWriteBuffer();
+                pair.first = i;
+                pair.second = 2 * i;
+                buffer.publish();
+            }
+        });
+
+        bool consistent = true, increasing = true;
+        int last = 0;
+        while (last < count)
+        {
+            if (!buffer.update())
+                continue;
+            const Pair& pair = buffer.getReadBuffer();
+            consistent = consistent && pair.second == 2 * pair.first;
+            increasing = increasing && pair.first > last;
+            last = pair.first;
+        }
+        writer.join();
+        REQUIRE(consistent);
+        REQUIRE(increasing);
+    }
+}
+
+TEST_CASE("render threads", "[graphics]")
+{
+    SECTION("the latest snapshot is drawn")
+    {
+        std::atomic<size_t> lastWidth{0};
+        std::atomic<bool> alwaysChanged{true};
+        RenderThread<> thread([&](const RenderSnapshot& snapshot, bool changed)
+        {
+            alwaysChanged = alwaysChanged && changed;
+            lastWidth = snapshot.cells.getWidth();
+        });
+        REQUIRE(thread.isRunning());
+
+        for (size_t width = 1; width <= 50; ++width)
+        {
+            thread.getSnapshot().cells.resize(width, 1);
+            thread.publish();
+        }
+        REQUIRE(eventually([&] { return lastWidth == 50; }));
+        REQUIRE(thread.getFrameCount() <= 50);
+        REQUIRE(alwaysChanged);
+
+        // Without new snapshots, nothing is drawn
+        uint64_t frames = thread.getFrameCount();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        REQUIRE(thread.getFrameCount() == frames);
+        thread.stop();
+        REQUIRE(!thread.isRunning());
+    }
+    SECTION("continuous render threads draw every frame")
+    {
+        std::atomic<int> unchanged{0};
+        RenderThread<> thread([&unchanged](const RenderSnapshot&, bool changed)
+        {
+            if (!changed)
+                ++unchanged;
+        }, true);
+        REQUIRE(eventually([&] { return unchanged > 10; }));
+    }
+    SECTION("input latency")
+    {
+        std::atomic<bool> started{false}, blocked{true};
+        std::atomic<uint64_t> drawnInputs{0};
+        RenderThread<> thread([&](const RenderSnapshot& snapshot, bool)
+        {
+            started = true;
+            while (blocked)
+                std::this_thread::yield();
+            drawnInputs = snapshot.inputs;
+        });
+
+        uint64_t inputs = thread.receiveInput();
+        REQUIRE(inputs == 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        thread.getSnapshot().inputs = inputs;
+        thread.publish();
+        REQUIRE(eventually([&] { return started.load(); }));
+
+        // Snapshots replaced before being drawn still have their inputs
+        // measured, by the snapshot that replaced them
+        thread.receiveInput();
+        thread.getSnapshot().inputs = 2;
+        thread.publish();
+        thread.getSnapshot().inputs = thread.receiveInput();
+        thread.publish();
+        blocked = false;
+        REQUIRE(eventually([&] { return thread.getInputLatency().samples == 3; }));
+        REQUIRE(drawnInputs == 3);
+
+        SystemTiming latency = thread.getInputLatency();
+        REQUIRE(latency.max >= std::chrono::milliseconds(5));
+        REQUIRE(latency.name == "input latency");
+    }
+    SECTION("errors of the draw function stop the thread")
+    {
+        RenderThread<> thread([](const RenderSnapshot&, bool) { throw std::runtime_error("lost device"); });
+        thread.publish();
+        REQUIRE(eventually([&] { return !thread.isRunning(); }));
+        REQUIRE_THROWS_AS(thread.stop(), std::runtime_error);
+        REQUIRE_NOTHROW(thread.stop());
+    }
+}
@@ -0,0 +1,169 @@
+#include "catch/catch.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <lazarus/SoftwareRenderer.h>
+
+using namespace lz;
+
+namespace
+{
+const size_t TILE = 4;
+
+// An atlas of 4 glyphs in a row: empty, full, left half, and full at half alpha
+Framebuffer makeAtlas()
+{
+    Framebuffer atlas(4 * TILE, TILE, Color::Transparent);
+    for (size_t y = 0; y < TILE; ++y)
+        for (size_t x = 0; x < TILE; ++x)
+        {
+            atlas(TILE + x, y) = Color::White;
+            if (x < TILE / 2)
+                atlas(2 * TILE + x, y) = Color::White;
+            atlas(3 * TILE + x, y) = Color(255, 255, 255, 128);
+        }
+    return atlas;
+}
+
+void fillTile(Framebuffer& image, size_t x, size_t y, size_t width, Color color)
+{
+    for (size_t row = 0; row < TILE; ++row)
+        for (size_t column = 0; column < width; ++column)
+            image(x * TILE + column, y * TILE + row) = color;
+}
+
+uint32_t readBigEndian(const std::string& bytes, size_t offset)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i)
+        value = (value << 8) | static_cast<uint8_t>(bytes[offset + i]);
+    return value;
+}
+}
+
+TEST_CASE("software rendering", "[graphics]")
+{
+    const Framebuffer atlas = makeAtlas();
+    const Color red(255, 0, 0), blue(0, 0, 255);
+    CellBuffer cells(3, 2);
+    cells.set(0, 0, 1, red, blue);
+    cells.set(1, 0, 2, Color::White, blue);
+    cells.set(2, 0, 0, Color::White, red);
+    cells.set(0, 1, 3, red, blue);
+    cells.set(1, 1, 99, Color::White, Color::Transparent);
+    cells.set(2, 1, 1, Color::Transparent, blue);
+
+    SoftwareRenderer renderer(atlas, TILE, TILE);
+    renderer.setClearColor(Color(0, 255, 0));
+    REQUIRE(renderer.update(cells));
+    REQUIRE(renderer.getDrawnCells() == 6);
+    const Framebuffer& frame = renderer.getFramebuffer();
+    REQUIRE(frame.getWidth() == 3 * TILE);
+    REQUIRE(frame.getHeight() == 2 * TILE);
+
+    SECTION("frames match the reference image")
+    {
+        Framebuffer expected(3 * TILE, 2 * TILE);
+        fillTile(expected, 0, 0, TILE, red);
+        fillTile(expected, 1, 0, TILE, blue);
+        fillTile(expected, 1, 0, TILE / 2, Color::White);
+        fillTile(expected, 2, 0, TILE, red);
+        fillTile(expected, 0, 1, TILE, Color(128, 0, 127));
+        // Unknown glyphs are drawn as the first one, and transparent
+        // backgrounds show the clear color
+        fillTile(expected, 1, 1, TILE, Color(0, 255, 0));
+        fillTile(expected, 2, 1, TILE, blue);
+        REQUIRE(frame == expected);
+    }
+    SECTION("only dirty cells are drawn")
+    {
+        REQUIRE(!renderer.update(cells));
+        REQUIRE(renderer.getDrawnCells() == 0);
+
+        cells.set(1, 1, 1, blue, red);
+        cells.set(2, 1, 2, red, Color::Black);
+        REQUIRE(renderer.update(cells));
+        REQUIRE(renderer.getDrawnCells() == 2);
+
+        SoftwareRenderer fresh(atlas, TILE, TILE);
+        fresh.setClearColor(Color(0, 255, 0));
+        fresh.update(cells);
+        REQUIRE(frame == fresh.getFramebuffer());
+
+        cells.resize(4, 1);
+        REQUIRE(renderer.update(cells));
+        REQUIRE(renderer.getDrawnCells() == 4);
+        REQUIRE(renderer.getFramebuffer().getWidth() == 4 * TILE);
+    }
+    SECTION("packed atlases")
+    {
+        // A 2x2 glyph stretched to a tile, with its top row white
+        Framebuffer page(2, 2, Color::Transparent);
+        page(0, 0) = page(1, 0) = Color::White;
+        GlyphTable glyphs;
+        glyphs.set('A', AtlasRect{0, 0, 0, 2, 2});
+        glyphs.set('B', AtlasRect{0, 1, 1, 2, 2});
+
+        CellBuffer text(3, 1, Cell{' ', Color::White, blue});
+        text.print(0, 0, "AB?");
+        SoftwareRenderer packed(page, glyphs, TILE, TILE);
+        packed.update(text);
+
+        const Framebuffer& image = packed.getFramebuffer();
+        REQUIRE(image(0, 0) == Color::White);
+        REQUIRE(image(3, 1) == Color::White);
+        REQUIRE(image(0, 2) == Color(0, 0, 0));
+        // Glyphs outside of the page and missing glyphs are not drawn
+        REQUIRE(image(TILE, 0) == Color(0, 0, 0));
+        REQUIRE(image(2 * TILE, 0) == Color(0, 0, 0));
+
+        REQUIRE_THROWS(SoftwareRenderer(atlas, 0, TILE));
+        REQUIRE_THROWS(SoftwareRenderer(atlas, TILE, 2 * TILE));
+        glyphs.set('C', AtlasRect{1, 0, 0, 2, 2});
+        REQUIRE_THROWS(SoftwareRenderer(page, glyphs, TILE, TILE));
+    }
+}
+
+TEST_CASE("framebuffer PNG output", "[graphics]")
+{
+    Framebuffer image(300, 70, Color(10, 20, 30, 40));
+    image(299, 69) = Color(1, 2, 3, 4);
+
+    std::stringstream stream;
+    REQUIRE(image.writePng(stream));
+    const std::string png = stream.str();
+
+    REQUIRE(png.substr(1, 3) == "PNG");
+    REQUIRE(readBigEndian(png, 8) == 13);
+    REQUIRE(png.substr(12, 4) == "IHDR");
+    REQUIRE(readBigEndian(png, 16) == 300);
+    REQUIRE(readBigEndian(png, 20) == 70);
+    REQUIRE(png.substr(png.size() - 8, 4) == "IEND");
+    REQUIRE(readBigEndian(png, png.size() - 4) == 0xAE426082);
+
+    // The pixels are stored uncompressed, in blocks of at most 65535 bytes
+    const size_t idat = 33;
+    REQUIRE(png.substr(idat + 4, 4) == "IDAT");
+    std::string raw;
+    size_t offset = idat + 8 + 2;
+    bool last = false;
+    while (!last)
+    {
+        last = png[offset] & 1;
+        size_t size = static_cast<uint8_t>(png[offset + 1]) | static_cast<uint8_t>(png[offset + 2]) << 8;
+        raw += png.substr(offset + 5, size);
+        offset += 5 + size;
+    }
+    REQUIRE(raw.size() == 70 * (1 + 300 * 4));
+    REQUIRE(raw[0] == 0);
+    REQUIRE(static_cast<uint8_t>(raw[1]) == 10);
+    REQUIRE(static_cast<uint8_t>(raw[4]) == 40);
+    REQUIRE(raw.substr(raw.size() - 4) == std::string("\x01\x02\x03\x04"));
+
+    Framebuffer copy(300, 70, image.getPixelsPtr());
+    REQUIRE(copy == image);
+    copy(0, 0) = Color::White;
+    REQUIRE(copy != image);
+}
@@ -0,0 +1,407 @@
+#include "catch/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include <lazarus/ECS.h>
+#include <lazarus/common.h>
+
+using namespace lz;
+
+struct Position
+{
+    Position(int x)
+        : x(x)
+    {
+    }
+
+    int x;
+};
+
+struct Velocity
+{
+    Velocity(int dx)
+        : dx(dx)
+    {
+    }
+
+    int dx;
+};
+
+struct Sprite
+{
+};
+
+// Updateable with a configurable access that counts its updates
+class AccessSystem : public Updateable
+{
+public:
+    AccessSystem(SystemAccess access)
+        : access(access)
+    {
+    }
+
+    virtual void update(ECSEngine& engine)
+    {
+        ++updates;
+    }
+
+    virtual SystemAccess getAccess() const
+    {
+        return access;
+    }
+
+    std::atomic<int> updates{0};
+
+private:
+    SystemAccess access;
+};
+
+class MovementSystem : public Updateable
+{
+public:
+    virtual void update(ECSEngine& engine)
+    {
+        engine.applyToEach<Position, Velocity>([](Entity* ent, Position* pos, Velocity* vel)
+        {
+            pos->x += vel->dx;
+        });
+    }
+
+    virtual SystemAccess getAccess() const
+    {
+        return SystemAccess().reads<Velocity>().writes<Position>();
+    }
+};
+
+class FailingSystem : public Updateable
+{
+public:
+    virtual void update(ECSEngine& engine)
+    {
+        throw std::runtime_error("failed");
+    }
+
+    virtual SystemAccess getAccess() const
+    {
+        return SystemAccess().readsResource("map");
+    }
+};
+
+TEST_CASE("system access conflicts")
+{
+    SystemAccess readsPosition = SystemAccess().reads<Position>();
+    SystemAccess writesPosition = SystemAccess().writes<Position>();
+    SystemAccess writesVelocity = SystemAccess().reads<Position>().writes<Velocity>();
+    SystemAccess readsMap = SystemAccess().readsResource("map");
+    SystemAccess writesMap = SystemAccess().writesResource("map");
+
+    REQUIRE_FALSE(readsPosition.conflictsWith(readsPosition));
+    REQUIRE(readsPosition.conflictsWith(writesPosition));
+    REQUIRE(writesPosition.conflictsWith(writesPosition));
+    REQUIRE(writesPosition.conflictsWith(writesVelocity));
+    REQUIRE_FALSE(readsPosition.conflictsWith(writesVelocity));
+    REQUIRE_FALSE(readsMap.conflictsWith(readsMap));
+    REQUIRE(readsMap.conflictsWith(writesMap));
+    REQUIRE_FALSE(writesMap.conflictsWith(writesPosition));
+    REQUIRE(SystemAccess::exclusive().conflictsWith(SystemAccess()));
+    REQUIRE(SystemAccess().conflictsWith(SystemAccess::exclusive()));
+}
+
+TEST_CASE("scheduler stages")
+{
+    ECSEngine engine;
+    AccessSystem audio(SystemAccess().reads<Position>().writesResource("audio"));
+    AccessSystem minimap(SystemAccess().reads<Position>().writesResource("minimap"));
+    AccessSystem movement(SystemAccess().writes<Position>());
+    AccessSystem sprites(SystemAccess().reads<Position>().writes<Sprite>());
+    AccessSystem legacy(SystemAccess::exclusive());
+    AccessSystem ui(SystemAccess().writesResource("ui"));
+
+    SECTION("independent systems share stages")
+    {
+        engine.registerUpdateable(&audio);
+        engine.registerUpdateable(&minimap);
+        engine.registerUpdateable(&movement);
+        engine.registerUpdateable(&sprites);
+        engine.registerUpdateable(&ui);
+        auto stages = engine.getScheduler().getStages();
+        REQUIRE(stages.size() == 3);
+        REQUIRE(stages[0] == std::vector<Updateable*>{&audio, &minimap, &ui});
+        REQUIRE(stages[1] == std::vector<Updateable*>{&movement});
+        REQUIRE(stages[2] == std::vector<Updateable*>{&sprites});
+    }
+    SECTION("exclusive systems run on their own")
+    {
+        engine.registerUpdateable(&audio);
+        engine.registerUpdateable(&legacy);
+        engine.registerUpdateable(&ui);
+        auto stages = engine.getScheduler().getStages();
+        REQUIRE(stages.size() == 3);
+        REQUIRE(stages[1] == std::vector<Updateable*>{&legacy});
+    }
+    SECTION("all systems are updated with workers")
+    {
+        engine.setWorkerCount(2);
+        for (auto system : {&audio, &minimap, &movement, &sprites, &legacy, &ui})
+            engine.registerUpdateable(system);
+        engine.update();
+        engine.update();
+        for (auto system : {&audio, &minimap, &movement, &sprites, &legacy, &ui})
+            REQUIRE(system->updates == 2);
+    }
+}
+
+TEST_CASE("parallel updates")
+{
+    ECSEngine engine;
+    engine.setWorkerCount(3);
+    for (int i = 0; i < 100; ++i)
+    {
+        Entity* entity = engine.addEntity();
+        entity->addComponent<Position>(i);
+        entity->addComponent<Velocity>(1);
+    }
+    MovementSystem movement;
+    AccessSystem reader(SystemAccess().reads<Velocity>());
+    SECTION("results match serial updates")
+    {
+        engine.registerUpdateable(&movement);
+        engine.registerUpdateable(&reader);
+        for (int i = 0; i < 10; ++i)
+            engine.update();
+        int total = 0;
+        engine.applyToEach<Position>([&](Entity* ent, Position* pos) { total += pos->x; });
+        REQUIRE(total == 4950 + 1000);
+        REQUIRE(reader.updates == 10);
+    }
+    SECTION("exceptions are passed to the caller")
+    {
+        FailingSystem failing;
+        engine.registerUpdateable(&failing);
+        engine.registerUpdateable(&reader);
+        REQUIRE_THROWS_AS(engine.update(), std::runtime_error);
+    }
+}
+
+class NamedSystem : public AccessSystem
+{
+public:
+    NamedSystem()
+        : AccessSystem(SystemAccess())
+    {
+    }
+
+    virtual std::string getName() const
+    {
+        return "named";
+    }
+};
+
+TEST_CASE("system timings")
+{
+    ECSEngine engine;
+    NamedSystem named;
+    MovementSystem movement;
+    engine.registerUpdateable(&named);
+    engine.registerUpdateable(&movement);
+    SECTION("no samples before updating")
+    {
+        auto timings = engine.getSystemTimings();
+        REQUIRE(timings.size() == 2);
+        REQUIRE(timings[0].samples == 0);
+        REQUIRE(timings[0].max.count() == 0);
+    }
+    SECTION("samples are kept in a rolling window")
+    {
+        for (int i = 0; i < 200; ++i)
+            engine.update();
+        auto timings = engine.getSystemTimings();
+        REQUIRE(timings.size() == 2);
+        REQUIRE(timings[0].updateable == &named);
+        REQUIRE(timings[0].name == "named");
+        REQUIRE(timings[1].updateable == &movement);
+        REQUIRE(timings[1].name == typeid(MovementSystem).name());
+        for (const auto& timing : timings)
+        {
+            REQUIRE(timing.samples == __lz::TimingHistory::WINDOW);
+            REQUIRE(timing.p50 <= timing.p95);
+            REQUIRE(timing.p95 <= timing.max);
+            REQUIRE(timing.last <= timing.max);
+        }
+        REQUIRE(engine.getLastUpdateTime().count() > 0);
+    }
+}
+
+TEST_CASE("timing percentiles")
+{
+    __lz::TimingHistory history;
+    for (int i = 1; i <= 100; ++i)
+        history.add(std::chrono::nanoseconds(i));
+    SystemTiming timing;
+    history.summarize(timing);
+    REQUIRE(timing.samples == 100);
+    REQUIRE(timing.last.count() == 100);
+    REQUIRE(timing.p50.count() == 50);
+    REQUIRE(timing.p95.count() == 95);
+    REQUIRE(timing.max.count() == 100);
+}
+
+TEST_CASE("update rates")
+{
+    SECTION("every tick")
+    {
+        UpdateRate rate = UpdateRate::everyTick();
+        for (ulong tick = 0; tick < 5; ++tick)
+            REQUIRE(rate.advance(tick, 0.) == 1);
+    }
+    SECTION("every nth tick")
+    {
+        UpdateRate rate = UpdateRate::everyNthTick(3, 1);
+        std::vector<unsigned> due;
+        for (ulong tick = 0; tick < 7; ++tick)
+            due.push_back(rate.advance(tick, 0.));
+        REQUIRE(due == std::vector<unsigned>{0, 1, 0, 0, 1, 0, 0});
+    }
+    SECTION("fixed frequency")
+    {
+        UpdateRate slow = UpdateRate::fixedHz(5);
+        UpdateRate fast = UpdateRate::fixedHz(60);
+        unsigned slowUpdates = 0, fastUpdates = 0;
+        // One second at 30 ticks per second
+        for (ulong tick = 0; tick < 30; ++tick)
+        {
+            slowUpdates += slow.advance(tick, 1. / 30.);
+            fastUpdates += fast.advance(tick, 1. / 30.);
+        }
+        REQUIRE(slowUpdates == 5);
+        REQUIRE(fastUpdates == 60);
+        REQUIRE(slow.getPeriod() == Approx(0.2));
+    }
+    SECTION("catch-up limit")
+    {
+        UpdateRate rate = UpdateRate::fixedHz(10, 3);
+        REQUIRE(rate.advance(0, 1.05) == 3);
+        // The other full periods were dropped, but not the time towards the next one
+        REQUIRE(rate.advance(1, 0.03) == 0);
+        REQUIRE(rate.advance(2, 0.03) == 1);
+
+        UpdateRate single = UpdateRate::fixedHz(10, 0);
+        REQUIRE(single.advance(0, 0.25) == 1);
+        REQUIRE(single.advance(1, 0.05) == 1);
+    }
+    SECTION("invalid frequency")
+    {
+        REQUIRE_THROWS_AS(UpdateRate::fixedHz(0), __lz::LazarusException);
+    }
+}
+
+TEST_CASE("engine update rates")
+{
+    ECSEngine engine;
+    AccessSystem everyTick(SystemAccess::exclusive());
+    AccessSystem everyThird(SystemAccess::exclusive());
+    AccessSystem pathing(SystemAccess::exclusive());
+    engine.registerUpdateable(&everyTick);
+    engine.registerUpdateable(&everyThird, UpdateRate::everyNthTick(3));
+    engine.registerUpdateable(&pathing, UpdateRate::fixedHz(5));
+    for (int i = 0; i < 30; ++i)
+        engine.update(1. / 30.);
+    REQUIRE(engine.getTick() == 30);
+    REQUIRE(engine.getTime() == Approx(1.));
+    REQUIRE(everyTick.updates == 30);
+    REQUIRE(everyThird.updates == 10);
+    REQUIRE(pathing.updates == 5);
+    // Updating without elapsed time does not update fixed frequency systems
+    engine.update();
+    REQUIRE(pathing.updates == 5);
+    REQUIRE(everyThird.updates == 11);
+    // Invalid elapsed times are rejected before any system runs
+    REQUIRE_THROWS_AS(engine.update(-1.), __lz::LazarusException);
+    REQUIRE_THROWS_AS(engine.update(std::numeric_limits<double>::quiet_NaN()), __lz::LazarusException);
+    REQUIRE_THROWS_AS(engine.update(std::numeric_limits<double>::infinity()), __lz::LazarusException);
+    REQUIRE(engine.getTick() == 31);
+    REQUIRE(everyTick.updates == 31);
+    engine.update(1. / 5.);
+    REQUIRE(pathing.updates == 6);
+}
+
+// Job of a fixed number of steps, that stops as soon as the deadline passes
+class SteppedJob : public TimeSlicedUpdateable
+{
+public:
+    SteppedJob(size_t steps)
+        : steps(steps)
+    {
+    }
+
+    virtual bool update(ECSEngine& engine, Clock::time_point deadline, size_t& cursor)
+    {
+        ++calls;
+        do
+        {
+            ++cursor;
+            ++work;
+        }
+        while (cursor < steps && Clock::now() < deadline);
+
+        if (cursor < steps)
+            return false;
+        ++passes;
+        return true;
+    }
+
+    size_t steps;
+    int calls = 0;
+    int passes = 0;
+    size_t work = 0;
+};
+
+TEST_CASE("time sliced updateables")
+{
+    ECSEngine engine;
+    SteppedJob dijkstra(5), simulation(3);
+    engine.registerTimeSliced(&dijkstra);
+    engine.registerTimeSliced(&simulation);
+    REQUIRE(engine.getFrameBudget() == std::chrono::microseconds(2000));
+    SECTION("jobs resume across ticks without budget")
+    {
+        engine.setFrameBudget(std::chrono::microseconds(0));
+        for (int i = 0; i < 4; ++i)
+            engine.update();
+        // One step per tick
+        REQUIRE(dijkstra.work == 4);
+        REQUIRE(dijkstra.passes == 0);
+        REQUIRE(simulation.passes == 1);
+        engine.update();
+        REQUIRE(dijkstra.passes == 1);
+        REQUIRE(dijkstra.calls == 5);
+    }
+    SECTION("jobs finish in one tick with enough budget")
+    {
+        engine.setFrameBudget(std::chrono::microseconds(1000000));
+        engine.update();
+        REQUIRE(dijkstra.passes == 1);
+        REQUIRE(simulation.passes == 1);
+        REQUIRE(dijkstra.work == 5);
+        // Finished jobs start again from the beginning
+        engine.update();
+        REQUIRE(dijkstra.passes == 2);
+        REQUIRE(dijkstra.work == 10);
+    }
+    SECTION("other updateables use up the budget first")
+    {
+        struct SlowSystem : Updateable
+        {
+            void update(ECSEngine&) override { std::this_thread::sleep_for(std::chrono::milliseconds(5)); }
+        } slow;
+        engine.registerUpdateable(&slow);
+        engine.update();
+        // The budget ran out before the jobs started, so they did one step each
+        REQUIRE(dijkstra.work == 1);
+        REQUIRE(simulation.work == 1);
+    }
+}
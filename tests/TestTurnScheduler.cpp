@@ -0,0 +1,151 @@
+#include "catch/catch.hpp"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <lazarus/ECS/TurnScheduler.h>
+#include <lazarus/common.h>
+
+using namespace lz;
+
+// Returns the IDs of the next n actors, ending the turn of each one
+static std::vector<Identifier> takeTurns(TurnScheduler& scheduler, ECSEngine& engine, int n)
+{
+    std::vector<Identifier> order;
+    for (int i = 0; i < n; ++i)
+    {
+        Entity* actor = scheduler.next(engine);
+        if (actor == nullptr)
+            break;
+        order.push_back(actor->getId());
+        scheduler.endTurn(actor->getId());
+    }
+    return order;
+}
+
+TEST_CASE("turn order by speed")
+{
+    ECSEngine engine;
+    TurnScheduler scheduler;
+    Identifier normal = engine.addEntity()->getId();
+    Identifier fast = engine.addEntity()->getId();
+    Identifier slow = engine.addEntity()->getId();
+    scheduler.add(normal, 100);
+    scheduler.add(fast, 200);
+    scheduler.add(slow, 50);
+    REQUIRE(scheduler.size() == 3);
+    SECTION("faster actors act more often")
+    {
+        auto order = takeTurns(scheduler, engine, 10);
+        // Ties are broken by scheduling order
+        REQUIRE(order == std::vector<Identifier>{normal, fast, slow, fast, normal, fast,
+                                                 fast, slow, normal, fast});
+        REQUIRE(scheduler.getTime() == 200);
+    }
+    SECTION("actors do not act again until their turn ends")
+    {
+        Entity* actor = scheduler.next(engine);
+        REQUIRE(actor->getId() == normal);
+        REQUIRE(scheduler.next(engine)->getId() == fast);
+        REQUIRE(scheduler.next(engine)->getId() == slow);
+        REQUIRE(scheduler.next(engine) == nullptr);
+        REQUIRE_THROWS_AS(scheduler.endTurn(engine.addEntity()->getId()),
+                          __lz::LazarusException);
+        scheduler.endTurn(normal, 50);
+        REQUIRE_THROWS_AS(scheduler.endTurn(normal), __lz::LazarusException);
+        REQUIRE(scheduler.next(engine)->getId() == normal);
+        REQUIRE(scheduler.getTime() == 50);
+    }
+    SECTION("deleted entities and removed actors lose their turns")
+    {
+        engine.getEntity(fast)->markForDeletion();
+        scheduler.remove(slow);
+        REQUIRE(takeTurns(scheduler, engine, 3) == std::vector<Identifier>{normal, normal, normal});
+        REQUIRE_FALSE(scheduler.contains(fast));
+        REQUIRE(scheduler.size() == 1);
+    }
+    SECTION("speed changes")
+    {
+        REQUIRE(scheduler.next(engine)->getId() == normal);
+        scheduler.endTurn(normal);  // Next turn at 100
+        REQUIRE(scheduler.next(engine)->getId() == fast);
+        scheduler.endTurn(fast);    // Next turn at 50
+        REQUIRE(scheduler.next(engine)->getId() == slow);
+        scheduler.endTurn(slow);    // Next turn at 200
+        // Haste the slow actor, now due at 25, and slow the fast one down, now due at 400
+        scheduler.setSpeed(slow, 400);
+        scheduler.setSpeed(fast, 25);
+        REQUIRE(scheduler.getSpeed(slow) == 400);
+        REQUIRE(takeTurns(scheduler, engine, 3) == std::vector<Identifier>{slow, slow, slow});
+        REQUIRE(scheduler.getTime() == 75);
+        REQUIRE(takeTurns(scheduler, engine, 6) == std::vector<Identifier>{normal, slow, slow,
+                                                                           slow, slow, normal});
+    }
+    SECTION("invalid operations")
+    {
+        REQUIRE_THROWS_AS(scheduler.add(normal), __lz::LazarusException);
+        REQUIRE_THROWS_AS(scheduler.add(engine.addEntity()->getId(), 0), __lz::LazarusException);
+        REQUIRE_THROWS_AS(scheduler.setSpeed(12345, 100), __lz::LazarusException);
+        REQUIRE(scheduler.getSpeed(12345) == 0);
+    }
+}
+
+TEST_CASE("turn queue with many actors")
+{
+    ECSEngine engine;
+    TurnScheduler scheduler;
+    std::mt19937 rng(42);
+    // Reference model: actor -> (speed, next turn)
+    std::map<Identifier, std::pair<unsigned, ulong>> model;
+    for (int i = 0; i < 2000; ++i)
+    {
+        Identifier id = engine.addEntity()->getId();
+        unsigned speed = 25 + rng() % 200;
+        ulong delay = rng() % 100;
+        scheduler.add(id, speed, delay);
+        model[id] = std::make_pair(speed, delay);
+    }
+
+    ulong lastTime = 0;
+    for (int turn = 0; turn < 20000; ++turn)
+    {
+        Entity* actor = scheduler.next(engine);
+        REQUIRE(actor != nullptr);
+        Identifier id = actor->getId();
+        ulong time = scheduler.getTime();
+        REQUIRE(time >= lastTime);
+        REQUIRE(model[id].second == time);
+        lastTime = time;
+
+        // Nobody in the model should have been due earlier
+        if (turn % 1000 == 0)
+        {
+            for (const auto& entry : model)
+                REQUIRE((entry.first == id || entry.second.second >= time));
+        }
+
+        int action = rng() % 20;
+        if (action == 0)
+        {
+            actor->markForDeletion();
+            model.erase(id);
+            continue;
+        }
+        scheduler.endTurn(id);
+        model[id].second = time + TurnScheduler::ACTION_COST * TurnScheduler::SPEED_SCALE
+                                  / model[id].first;
+        if (action == 1)
+        {
+            // Change the speed of a random waiting actor
+            auto other = model.begin();
+            std::advance(other, rng() % model.size());
+            unsigned speed = 25 + rng() % 200;
+            auto& entry = other->second;
+            entry.second = time + (entry.second - time) * entry.first / speed;
+            entry.first = speed;
+            scheduler.setSpeed(other->first, speed);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#include "catch/catch.hpp"
+
+#include <string>
+#include <vector>
+
+#include <lazarus/WeightedSampler.h>
+
+using namespace lz;
+
+namespace
+{
+// Returns the fraction of samples that fall on each index
+template <typename Sampler>
+std::vector<double> frequencies(const Sampler& sampler, RandomGenerator& generator, int samples)
+{
+    std::vector<double> counts(sampler.size(), 0.);
+    for (int i = 0; i < samples; ++i)
+        counts[sampler.sample(generator)] += 1.;
+    for (auto& count : counts)
+        count /= samples;
+    return counts;
+}
+}
+
+TEST_CASE("alias table sampling", "[random]")
+{
+    RandomGenerator generator(12345);
+
+    SECTION("samples follow the weights")
+    {
+        AliasTable table({1., 0., 3., 6.});
+        REQUIRE(table.getProbability(3) == Approx(0.6));
+        std::vector<double> observed = frequencies(table, generator, 100000);
+        REQUIRE(observed[0] == Approx(0.1).margin(0.01));
+        REQUIRE(observed[1] == 0.);
+        REQUIRE(observed[2] == Approx(0.3).margin(0.01));
+        REQUIRE(observed[3] == Approx(0.6).margin(0.01));
+    }
+    SECTION("big tables")
+    {
+        std::vector<double> weights(5000);
+        for (size_t i = 0; i < weights.size(); ++i)
+            weights[i] = static_cast<double>(i % 7);
+        AliasTable table(weights);
+        for (int i = 0; i < 10000; ++i)
+            REQUIRE(weights[table.sample(generator)] > 0.);
+    }
+    SECTION("invalid weights")
+    {
+        REQUIRE_THROWS(AliasTable(std::vector<double>()));
+        REQUIRE_THROWS(AliasTable({0., 0.}));
+        REQUIRE_THROWS(AliasTable({1., -1.}));
+        REQUIRE_THROWS(AliasTable().sample(generator));
+    }
+    SECTION("weighted tables of items")
+    {
+        WeightedTable<std::string> loot({{"gold", 3.}, {"sword", 1.}});
+        int gold = 0;
+        for (int i = 0; i < 10000; ++i)
+            gold += loot.sample(generator) == "gold";
+        REQUIRE(gold / 10000. == Approx(0.75).margin(0.02));
+        REQUIRE((loot.sample() == "gold" || loot.sample() == "sword"));
+    }
+}
+
+TEST_CASE("dynamic weighted sampling", "[random]")
+{
+    RandomGenerator generator(12345);
+    DynamicWeightedSampler sampler({1., 1., 2.});
+
+    SECTION("samples follow the weights")
+    {
+        REQUIRE(sampler.getTotalWeight() == 4.);
+        std::vector<double> observed = frequencies(sampler, generator, 100000);
+        REQUIRE(observed[0] == Approx(0.25).margin(0.01));
+        REQUIRE(observed[2] == Approx(0.5).margin(0.01));
+    }
+    SECTION("changing weights")
+    {
+        sampler.setWeight(2, 0.);
+        sampler.setWeight(0, 3.);
+        REQUIRE(sampler.getTotalWeight() == 4.);
+        std::vector<double> observed = frequencies(sampler, generator, 100000);
+        REQUIRE(observed[0] == Approx(0.75).margin(0.01));
+        REQUIRE(observed[2] == 0.);
+    }
+    SECTION("adding weights")
+    {
+        for (int i = 0; i < 13; ++i)
+            REQUIRE(sampler.add(i % 2) == 3 + i);
+        REQUIRE(sampler.getTotalWeight() == 10.);
+        for (int i = 0; i < 1000; ++i)
+            REQUIRE(sampler.getWeight(sampler.sample(generator)) > 0.);
+    }
+    SECTION("many updates keep the total")
+    {
+        for (int i = 0; i < 1000; ++i)
+            sampler.setWeight(i % 3, 0.1 * (i % 10));
+        double total = sampler.getWeight(0) + sampler.getWeight(1) + sampler.getWeight(2);
+        REQUIRE(sampler.getTotalWeight() == Approx(total));
+    }
+    SECTION("invalid weights")
+    {
+        REQUIRE_THROWS(sampler.setWeight(0, -1.));
+        REQUIRE_THROWS(sampler.setWeight(5, 1.));
+        REQUIRE_THROWS(DynamicWeightedSampler({0., 0.}).sample(generator));
+    }
+    SECTION("zeroing every weight")
+    {
+        // Weights that do not add up exactly leave rounding errors in the tree
+        DynamicWeightedSampler drifting({0.1, 0.2, 0.3, 0.7, 1e-3});
+        for (size_t i = 0; i < drifting.size(); ++i)
+            drifting.setWeight(i, 0.);
+        REQUIRE(drifting.getTotalWeight() == 0.);
+        REQUIRE_THROWS_AS(drifting.sample(generator), __lz::LazarusException);
+
+        drifting.setWeight(3, 1e-300);
+        REQUIRE(drifting.sample(generator) == 3);
+    }
+}